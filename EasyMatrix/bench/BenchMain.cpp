@@ -0,0 +1,438 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application.
+//
+// ==========================================================================
+
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>		// Header for OpenMP
+#endif
+
+
+#include "EMatrix.h"
+#include "EMUtility.h"
+#include "SparseEMatrix.h"
+#include "EMTextIO.h"
+
+
+
+
+// The benchmark suite of the parallel parts of EasyMatrix. Usage:
+//
+//		EasyMatrix_Bench [--sizes 256,512] [--threads 1,2,4] [--warmup 2] [--trials 10]
+//						 [--ops spmv,text_write,...] [--csv out.csv] [--json out.json]
+//
+// Each operation is warmed up, then timed in a number of trials, for each
+// size and number of threads. The median, the minimum and the 95th percentile
+// of the times are reported, together with GB/s at the median time.
+// Without OpenMP everything runs on one thread.
+
+
+
+namespace
+{
+
+	// Settings of one benchmark run
+	struct BenchConfig
+	{
+		std::vector< Dim >	fSizes { 256, 512, 1024, 2048 };	// matrices are size x size
+		std::vector< int >	fThreads;							// empty means 1, 2, 4, ... up to the max
+
+		int			fWarmUps { 2 };
+		int			fTrials { 10 };
+
+		std::vector< std::string >	fOps;						// names of the operations to run, empty means all
+	};
+
+
+	// The timing of one operation for one size and number of threads
+	struct BenchResult
+	{
+		std::string		fOp;
+		Dim				fSize {};
+		int				fThreads {};
+		int				fTrials {};
+
+		double			fMedian {}, fMin {}, fP95 {};		// in seconds
+
+		double			fRate {};			// GB/s at the median time
+	};
+
+
+	// An operation set up for one size. It owns its data.
+	struct BenchOp
+	{
+		std::function< void( void ) >	fRun;
+
+		double		fBytes {};			// bytes read or written by one run
+	};
+
+
+	// The results of the reductions go here, so the compiler cannot skip them
+	volatile DataType	gBenchSink {};
+
+
+	int		GetMaxThreads( void )
+	{
+		#ifdef _OPENMP
+		return omp_get_max_threads();
+		#else
+		return 1;
+		#endif
+	}
+
+	void	SetThreads( int t )
+	{
+		#ifdef _OPENMP
+		omp_set_num_threads( t );
+		#else
+		( void ) t;
+		#endif
+	}
+
+
+	// Returns a random matrix, the same in each run
+	EMatrix		BenchMatrix( Dim rows, Dim cols, std::uint64_t seed )
+	{
+		EMatrix	m( rows, cols );
+		RandInit( m, seed );
+		return m;
+	}
+
+
+	// The SpMV matrix has as many non-zeros as a dense size x size matrix
+	// has elements, kSpMV_RowElems in each row, spread over all columns
+	constexpr Dim	kSpMV_RowElems { 16 };
+
+	SparseEMatrix	BenchSparseMatrix( Dim n )
+	{
+		const Dim	dim = std::max( n * n / kSpMV_RowElems, kSpMV_RowElems );
+		const Dim	step = dim / kSpMV_RowElems;
+
+		SparseEMatrix::IdxVec	offsets( dim + 1 ), indices( dim * kSpMV_RowElems );
+		RealVec					values( dim * kSpMV_RowElems );
+
+		for( Dim r = 0; r < dim; ++ r )
+		{
+			offsets[ r + 1 ] = ( r + 1 ) * kSpMV_RowElems;
+			for( Dim k = 0; k < kSpMV_RowElems; ++ k )
+			{
+				indices[ r * kSpMV_RowElems + k ] = k * step + r % step;	// ascending in each row
+				values[ r * kSpMV_RowElems + k ] = 1.0 / static_cast< DataType >( k + 1 );
+			}
+		}
+
+		return SparseEMatrix( dim, dim, ESparseOrder::kCSR, std::move( offsets ), std::move( indices ), std::move( values ) );
+	}
+
+
+	constexpr double	kElemBytes { sizeof( DataType ) };
+
+
+	BenchOp		MakeBenchOp( const std::string & name, Dim n )
+	{
+		if( name == "spmv" )
+		{
+			// The values and indices are read once, x is gathered and y is written
+			const auto	a = BenchSparseMatrix( n );
+			const double bytes = double( a.GetNonZeros() ) * ( kElemBytes + sizeof( Dim ) + kElemBytes ) + double( a.GetRows() ) * kElemBytes;
+
+			auto run = [ a, x = RealVec( a.GetCols(), 1.0 ) ] () { gBenchSink = ( a * x )[ 0 ]; };
+			return { run, bytes };
+		}
+
+		if( name == "text_write" || name == "text_read" )
+		{
+			// The rate is the number of bytes of text written or read
+			const auto	m = BenchMatrix( n, n, 1 );
+			std::ostringstream	oss;
+			WriteText( oss, m );
+			const std::string	text( oss.str() );
+
+			if( name == "text_write" )
+			{
+				auto run = [ m ] () { std::ostringstream out; WriteText( out, m ); gBenchSink = DataType( out.tellp() ); };
+				return { run, double( text.size() ) };
+			}
+
+			// A new stream for each run - copying the text is cheap compared to converting it
+			auto run = [ text, r = EMatrix( n, n ) ] () mutable
+						{ std::istringstream in( text ); EMTextReport report; ReadText( in, r, report ); gBenchSink = r[ 0 ][ 0 ]; };
+			return { run, double( text.size() ) };
+		}
+
+		if( name == "rand_init" )
+		{
+			// Into the same matrix each time, so no allocation is measured
+			auto run = [ m = EMatrix( n, n ) ] () mutable { RandInit( m, 1 ); };
+			return { run, double( n ) * double( n ) * kElemBytes };
+		}
+
+		assert( false );	// unknown name
+		return {};
+	}
+
+
+	std::vector< std::string >	GetBenchOps( void )
+	{
+		return { "spmv", "text_write", "text_read", "rand_init" };
+	}
+
+
+	// 1, 2, 4, ... and the max number of threads
+	std::vector< int >	DefaultThreads( void )
+	{
+		const int kMaxThreads = GetMaxThreads();
+
+		std::vector< int >	threads;
+		for( int t = 1; t < kMaxThreads; t *= 2 )
+			threads.push_back( t );
+		threads.push_back( kMaxThreads );
+		return threads;
+	}
+
+
+	// Calls op warm_ups times, then measures trials calls of it. The times are sorted.
+	std::vector< double >	TimeTrials( const std::function< void( void ) > & op, int warm_ups, int trials )
+	{
+		for( int i = 0; i < warm_ups; ++ i )
+			op();
+
+		std::vector< double >	times;
+		for( int i = 0; i < trials; ++ i )
+		{
+			const auto start_time = std::chrono::steady_clock::now();
+			op();
+			times.push_back( std::chrono::duration< double >( std::chrono::steady_clock::now() - start_time ).count() );
+		}
+
+		std::sort( times.begin(), times.end() );
+		return times;
+	}
+
+
+	std::vector< BenchResult >	RunBenchSuite( const BenchConfig & config, std::ostream & log = std::cout )
+	{
+		const auto	ops		= config.fOps.empty() ? GetBenchOps() : config.fOps;
+		const auto	threads	= config.fThreads.empty() ? DefaultThreads() : config.fThreads;
+
+		const int	kMaxThreads = GetMaxThreads();		// restored at the end
+
+		log << "Max threads: " << kMaxThreads << std::endl;
+
+		std::vector< BenchResult >	results;
+
+		for( const auto & name : ops )
+		{
+			for( const auto n : config.fSizes )
+			{
+				const BenchOp	op { MakeBenchOp( name, n ) };
+
+				for( const auto t : threads )
+				{
+					SetThreads( t );
+
+					const auto	times { TimeTrials( op.fRun, config.fWarmUps, config.fTrials ) };
+					const auto	k = times.size();
+
+					BenchResult		res;
+					res.fOp			= name;
+					res.fSize		= n;
+					res.fThreads	= t;
+					res.fTrials		= config.fTrials;
+					res.fMedian		= k % 2 == 1 ? times[ k / 2 ] : 0.5 * ( times[ k / 2 - 1 ] + times[ k / 2 ] );
+					res.fMin		= times.front();
+					res.fP95		= times[ std::clamp< std::size_t >( static_cast< std::size_t >( std::ceil( 0.95 * k ) ), 1, k ) - 1 ];	// nearest rank
+					res.fRate		= op.fBytes / res.fMedian * 1e-9;
+
+					log << std::left << std::setw( 12 ) << name << "n=" << std::setw( 7 ) << n << "t=" << std::setw( 4 ) << t << std::right
+						<< std::fixed << std::setprecision( 3 )
+						<< "median " << std::setw( 10 ) << res.fMedian * 1e3 << " ms   min " << std::setw( 10 ) << res.fMin * 1e3
+						<< " ms   p95 " << std::setw( 10 ) << res.fP95 * 1e3 << " ms   "
+						<< std::setprecision( 2 ) << std::setw( 8 ) << res.fRate << " GB/s" << std::defaultfloat << std::endl;
+
+					results.push_back( res );
+				}
+			}
+		}
+
+		SetThreads( kMaxThreads );
+
+		return results;
+	}
+
+
+	void		WriteBenchCsv( std::ostream & os, const std::vector< BenchResult > & results )
+	{
+		os << "op,size,threads,trials,median_s,min_s,p95_s,rate,unit\n";
+		os << std::setprecision( 9 );
+		for( const auto & r : results )
+			os	<< r.fOp << ',' << r.fSize << ',' << r.fThreads << ',' << r.fTrials << ','
+				<< r.fMedian << ',' << r.fMin << ',' << r.fP95 << ',' << r.fRate << ",GB/s\n";
+	}
+
+
+	void		WriteBenchJson( std::ostream & os, const std::vector< BenchResult > & results )
+	{
+		os << std::setprecision( 9 );
+		os << "{\n";
+		os << "  \"max_threads\": " << GetMaxThreads() << ",\n";
+		os << "  \"results\": [";
+		for( std::size_t i = 0; i < results.size(); ++ i )
+		{
+			const auto & r = results[ i ];
+			os	<< ( i > 0 ? "," : "" ) << "\n    { "
+				<< "\"op\": \"" << r.fOp << "\", \"size\": " << r.fSize << ", \"threads\": " << r.fThreads << ", \"trials\": " << r.fTrials
+				<< ", \"median_s\": " << r.fMedian << ", \"min_s\": " << r.fMin << ", \"p95_s\": " << r.fP95
+				<< ", \"rate\": " << r.fRate << ", \"unit\": \"GB/s\" }";
+		}
+		os << "\n  ]\n}\n";
+	}
+
+
+	// "a,b,c" --> { "a", "b", "c" }
+	std::vector< std::string >	SplitList( const std::string & s )
+	{
+		std::vector< std::string >	items;
+		std::istringstream			iss( s );
+		for( std::string item; std::getline( iss, item, ',' ); )
+			if( ! item.empty() )
+				items.push_back( item );
+		return items;
+	}
+
+	// The largest matrices - their text takes about 20 GB,
+	// and the most threads that make sense
+	constexpr long long		kMaxSize { 1 << 15 };
+	constexpr long long		kMaxThreads { 1 << 10 };
+
+	// "1,2,3" --> { 1, 2, 3 }; each number must be in [ 1, max_value ]
+	template < typename T >
+	std::vector< T >	SplitNumbers( const std::string & s, long long max_value, const std::string & what )
+	{
+		std::vector< T >	numbers;
+		for( const auto & item : SplitList( s ) )
+		{
+			std::size_t		pos {};
+			long long		n {};
+			try
+			{
+				n = std::stoll( item, & pos );
+			}
+			catch( const std::exception & )		// not a number or out of the range of long long
+			{
+				pos = 0;
+			}
+
+			if( pos != item.size() || n < 1 || n > max_value )
+				throw std::out_of_range( "the " + what + " must be from 1 to " + std::to_string( max_value ) + ", not " + item );
+			numbers.push_back( static_cast< T >( n ) );
+		}
+		return numbers;
+	}
+
+	void PrintUsage( void )
+	{
+		std::cout << "Usage: EasyMatrix_Bench [--sizes n1,n2,...] [--threads t1,t2,...] [--warmup k] [--trials k]\n"
+					 "                        [--ops op1,op2,...] [--csv file] [--json file]\n"
+					 "Operations:";
+		for( const auto & op : GetBenchOps() )
+			std::cout << " " << op;
+		std::cout << std::endl;
+	}
+
+}
+
+
+
+int main( int argc, char ** argv )
+{
+	BenchConfig		config;
+	std::string		csv_file, json_file;
+
+	try
+	{
+		for( int i = 1; i < argc; ++ i )
+		{
+			const std::string	arg( argv[ i ] );
+
+			if( arg == "--help" || arg == "-h" )
+			{
+				PrintUsage();
+				return 0;
+			}
+
+			if( i + 1 >= argc )
+				throw std::invalid_argument( "missing value of " + arg );
+
+			const std::string	value( argv[ ++ i ] );
+
+			if( arg == "--sizes" )			config.fSizes	= SplitNumbers< Dim >( value, kMaxSize, "sizes" );
+			else if( arg == "--threads" )	config.fThreads	= SplitNumbers< int >( value, kMaxThreads, "numbers of threads" );
+			else if( arg == "--warmup" )	config.fWarmUps	= std::stoi( value );
+			else if( arg == "--trials" )	config.fTrials	= std::stoi( value );
+			else if( arg == "--ops" )		config.fOps		= SplitList( value );
+			else if( arg == "--csv" )		csv_file		= value;
+			else if( arg == "--json" )		json_file		= value;
+			else
+				throw std::invalid_argument( "unknown option " + arg );
+		}
+
+		const auto	all_ops = GetBenchOps();
+		for( const auto & op : config.fOps )
+			if( std::find( all_ops.begin(), all_ops.end(), op ) == all_ops.end() )
+				throw std::invalid_argument( "unknown operation " + op );
+
+		if( config.fTrials < 1 || config.fWarmUps < 0 || config.fSizes.empty() )
+			throw std::invalid_argument( "at least one size and one trial are needed" );
+
+	}
+	catch( const std::exception & e )		// std::stoi throws too
+	{
+		std::cerr << "Error: " << e.what() << std::endl;
+		PrintUsage();
+		return 1;
+	}
+
+
+	const auto results = RunBenchSuite( config );
+
+
+	if( ! csv_file.empty() )
+	{
+		std::ofstream	csv( csv_file );
+		WriteBenchCsv( csv, results );
+		if( ! csv )
+			std::cerr << "Error: cannot write " << csv_file << std::endl;
+	}
+
+	if( ! json_file.empty() )
+	{
+		std::ofstream	json( json_file );
+		WriteBenchJson( json, results );
+		if( ! json )
+			std::cerr << "Error: cannot write " << json_file << std::endl;
+	}
+
+	return 0;
+}
+
@@ -0,0 +1,132 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+#pragma once
+
+
+#include "EMatrix.h"
+
+#include <cstdint>
+#include <string>
+#include <optional>
+
+
+#if EM_VER > 1
+
+
+
+// -----------------------------------------------------------
+// The binary file format of EMatrix
+//
+// The file is a 64-byte header followed by the matrix buffer
+// exactly as it is in memory, i.e. rows * fLeadDim elements,
+// with each row padded to a multiple of EMatrix::kAlignment bytes.
+// Since the data start at the 64-byte offset, a mapped file
+// has the same aligned layout as an EMatrix object.
+
+
+
+struct EMBinaryHeader
+{
+	static constexpr char			kMagic[ 8 ] { 'E', 'M', 'A', 'T', 'R', 'I', 'X', '\0' };
+	static constexpr std::uint32_t	kVersion { 1 };
+	static constexpr std::uint32_t	kEndianTag { 0x01020304 };	// reads 0x04030201 with the other endianness
+	static constexpr std::uint32_t	kFloat64 { 1 };				// the only data type so far
+
+	char			fMagic[ 8 ] {};
+	std::uint32_t	fVersion {};
+	std::uint32_t	fEndianTag {};		// as written by the machine that saved the file
+	std::uint32_t	fDataType {};
+	std::uint32_t	fHeaderSize {};		// the data start right after the header
+	std::uint64_t	fRows {};
+	std::uint64_t	fCols {};
+	std::uint64_t	fLeadDim {};
+	std::uint64_t	fChecksum {};		// of the data taken as 64-bit words
+	std::uint64_t	fReserved {};
+};
+
+static_assert( sizeof( EMBinaryHeader ) == 64, "The header must be exactly 64 bytes" );
+static_assert( sizeof( DataType ) == sizeof( std::uint64_t ), "Only 64-bit elements are supported" );
+
+
+// Computes the checksum of elems values starting at data
+std::uint64_t	ComputeChecksum( const DataType * data, Dim elems );
+
+
+// Saves m to a binary file - the header and then the whole buffer
+// with one bulk write. Returns true on success.
+bool	WriteBinary( const EMatrix & m, const std::string & file_name );
+
+// Reads a matrix from a binary file. The data are converted if the file
+// was written on a machine with the other endianness. Returns false if
+// the file cannot be read, its header is wrong (also if the file is shorter 
+// than the data its header describes) or the checksum does not match.
+// In such a case m is left untouched.
+bool	ReadBinary( EMatrix & m, const std::string & file_name );
+
+
+
+// A read-only EMatrix view of a binary file mapped into memory.
+// Nothing is copied - pages are loaded by the system when touched.
+// The file must have the native endianness.
+//
+// It can be used as follows:
+//
+//		EMatrixMap	map( "big.ema" );
+//		if( map.IsOpen() )
+//			std::cout << map.GetMatrix()[ 0 ][ 0 ];
+//
+class EMatrixMap
+{
+	std::optional< EMatrix >	fMatrix;
+
+	void *		fMapAddr {};		// the beginning of the mapped file
+	std::size_t	fMapSize {};
+
+#ifdef _WIN32
+	void *		fFileHandle {};
+	void *		fMappingHandle {};
+#endif
+
+public:
+
+	EMatrixMap( void ) = default;
+
+	// Maps a file. If verify_checksum is true the whole file is read once.
+	explicit EMatrixMap( const std::string & file_name, bool verify_checksum = false ) { Open( file_name, verify_checksum ); }
+
+	~EMatrixMap() { Close(); }
+
+	// The view cannot be copied
+	EMatrixMap( const EMatrixMap & ) = delete;
+	EMatrixMap & operator = ( const EMatrixMap & ) = delete;
+
+
+	// Returns true if the file was mapped and its header is correct
+	bool	Open( const std::string & file_name, bool verify_checksum = false );
+
+	void	Close( void );
+
+	bool	IsOpen( void ) const { return fMatrix.has_value(); }
+
+	// The matrix can be passed to any function that takes const EMatrix &.
+	// Its memory is read-only, so only a copy can be modified.
+	const EMatrix &		GetMatrix( void ) const { assert( IsOpen() ); return * fMatrix; }
+};
+
+
+
+#endif
+
+
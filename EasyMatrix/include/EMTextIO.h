@@ -0,0 +1,77 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+#pragma once
+
+
+#include "EMatrix.h"
+
+#include <string>
+#include <charconv>
+
+
+#if EM_VER > 1
+
+
+
+// -----------------------------------------------------------
+// A fast text codec of EMatrix
+//
+// Each line of text is one row of a matrix. Elements are separated
+// with spaces, tabs, commas or semicolons, and empty lines are skipped.
+// Numbers are converted with std::from_chars and std::to_chars, which are
+// locale independent and much faster than the stream operators.
+// To go even faster, open the file streams in the binary mode.
+
+
+
+// What was found in the text. Rows which do not fit are collected here.
+struct EMTextReport
+{
+	struct BadRow
+	{
+		Dim		fLine {};			// line number, counted from 1
+		Dim		fElems {};			// number of elements that were read from the line
+		bool	fBadNumber {};		// true if a token could not be converted
+	};
+
+	Dim						fRows {};
+	Dim						fCols {};		// set by the first non-empty line
+
+	std::vector< BadRow >	fBadRows;
+};
+
+
+
+// Reads a matrix from the text stream in big blocks. Each block is split
+// at line boundaries and its parts are converted in parallel.
+// If any row has a different number of elements than the first one,
+// or contains something that is not a number, it is reported
+// in the report, false is returned, and m is left untouched.
+bool	ReadText( std::istream & in, EMatrix & m, EMTextReport & report );
+
+// Writes a matrix to the text stream. Rows are formatted in parallel 
+// into reusable buffers, which are then written in big blocks.
+// Numbers are in the shortest form that converts back exactly.
+bool	WriteText( std::ostream & out, const EMatrix & m, char separator = '\t' );
+
+// The same, but numbers are formatted as with printf and %f (fixed), %e (scientific) 
+// or %g (general) with the given precision - so as a stream with these settings does.
+bool	WriteText( std::ostream & out, const EMatrix & m, std::chars_format format, int precision, char separator = '\t' );
+
+
+
+#endif
+
+
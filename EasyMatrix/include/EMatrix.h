@@ -1,174 +1,325 @@
-// ==========================================================================
-//
-// Software written by Boguslaw Cyganek (C) to be used with the book:
-// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
-// Published by Wiley, 2020
-//
-// The software is supplied as is and for educational purposes
-// without any guarantees nor responsibility of its use in any application. 
-//
-// ==========================================================================
-
-
-
-
-
-
-// ----------------------------------------
-// Part I
-
-#include <iostream> 
-#include <vector>
-
-
-
-
-
-
-
-// A type alias declaration for a vector of double values (real approx.)
-using RealVec = std::vector< double >;
-
-// A type alias for vector dimensions (size)
-using Dim		= RealVec::size_type;
-
-// A type alias for vector type (e.g. double)
-using DataType	= RealVec::value_type;
-
-
-// A type alias for a vector of vectors with doubles = a real matrix
-using RealMatrix = std::vector< RealVec >;
-
-
-
-// ----------------------------------------
-// Part II
-
-#include <cassert>
-
-// Set to 1 for FIRST simple version
-// Set to 2 for the SECOND object-oriented version
-#define EM_VER 2
-
-
-#if EM_VER == 1
-
-
-// -----------------------------------------------------------
-// Ver. 1.0
-
-
-
-// EMatrix is a wrapper to RealMatrix. 
-// A role of a wrapper is to facilitate some actions.
-struct EMatrix
-{
-
-
-	RealMatrix	fData;	// data structure
-
-
-	// A parametric constructor
-	// rows, cols  number of rows and columns of a matrix (should be > 0)
-	// initVal  an initial value of elements of a matrix
-	EMatrix( Dim rows, Dim cols, DataType initVal = 0.0 )
-		: fData( rows, RealVec( cols, initVal ) )
-	{	
-		// matrix == a vector of vectors of double
-		assert( cols > 0 );
-		assert( rows > 0 );
-	}
-
-
-	// Helpers
-	auto	GetCols( void ) const { return fData[ 0 ].size(); }
-	auto	GetRows( void ) const { return fData.size(); }
-
-};
-
-#else
-
-
-
-// -----------------------------------------------------------
-// Ver. 2.0
-
-
-
-class EMatrix
-{
-	// -----------------------------------------------------------
-	// Ver. 1.0
-
-private:
-
-	RealMatrix	fData;	// data structure (encapsulation)
-
-public:
-
-	// A parametric constructor
-	EMatrix( Dim rows, Dim cols, DataType initVal = 0.0 )
-		: fData( rows, RealVec( cols, initVal ) )
-	{	// matrix == a vector of vectors of double
-		assert( cols > 0 );
-		assert( rows > 0 );
-	}
-
-
-	// Helpers
-	auto	GetCols( void ) const { return fData[ 0 ].size(); }
-	auto	GetRows( void ) const { return fData.size(); }
-
-
-	// -----------------------------------------------------------
-	// Ver. 2.0
-
-	// As a result of overloaded subscript operators 
-	// instead of m.fData[2][3] we can write directly m[2][3] 
-	auto &			operator[] ( Dim idx ) { return fData[ idx ]; }			
-	const auto &	operator[] ( Dim idx ) const { return fData[ idx ]; }
-
-	// We need only these two pairs of functions to have a range-based for loop
-	auto			begin() { return fData.begin(); }
-	auto			end()	{ return fData.end(); }
-
-	auto			begin() const { return fData.begin(); }
-	auto			end()	const { return fData.end(); }
-
-
-
-
-	// Let add some overloaded arithmetical operators
-	EMatrix &		operator += ( const EMatrix & b );	// this will probably change this object
-	EMatrix			operator + ( const EMatrix & b ) const;
-	// We can add other operators here ...
-
-
-	// friends are functions that can freely access fData
-	friend std::ostream & operator << ( std::ostream & o, const EMatrix & matrix );
-	friend std::istream & operator >> ( std::istream & i, EMatrix & matrix );
-
-
-};
-
-
-
-
-
-
-// ----------------------------------------
-// Part III
-
-EMatrix		operator + ( const EMatrix & a, const EMatrix & b );
-
-EMatrix		operator * ( const EMatrix & a, const EMatrix & b );
-
-
-
-
-
-#endif
-
-
-
-
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#pragma once
+
+
+
+
+
+// ----------------------------------------
+// Part I
+
+#include <iostream> 
+#include <vector>
+
+
+
+
+
+
+
+// A type alias declaration for a vector of double values (real approx.)
+using RealVec = std::vector< double >;
+
+// A type alias for vector dimensions (size)
+using Dim		= RealVec::size_type;
+
+// A type alias for vector type (e.g. double)
+using DataType	= RealVec::value_type;
+
+
+// A type alias for a vector of vectors with doubles = a real matrix
+using RealMatrix = std::vector< RealVec >;
+
+
+
+// ----------------------------------------
+// Part II
+
+#include <cassert>
+#include <memory>
+#include <new>
+#include <algorithm>
+
+// Set to 1 for FIRST simple version
+// Set to 2 for the SECOND object-oriented version
+#define EM_VER 2
+
+
+#if EM_VER == 1
+
+
+// -----------------------------------------------------------
+// Ver. 1.0
+
+
+
+// EMatrix is a wrapper to RealMatrix. 
+// A role of a wrapper is to facilitate some actions.
+struct EMatrix
+{
+
+
+	RealMatrix	fData;	// data structure
+
+
+	// A parametric constructor
+	// rows, cols  number of rows and columns of a matrix (should be > 0)
+	// initVal  an initial value of elements of a matrix
+	EMatrix( Dim rows, Dim cols, DataType initVal = 0.0 )
+		: fData( rows, RealVec( cols, initVal ) )
+	{	
+		// matrix == a vector of vectors of double
+		assert( cols > 0 );
+		assert( rows > 0 );
+	}
+
+
+	// Helpers
+	auto	GetCols( void ) const { return fData[ 0 ].size(); }
+	auto	GetRows( void ) const { return fData.size(); }
+
+};
+
+#else
+
+
+
+// -----------------------------------------------------------
+// Ver. 2.0
+
+
+
+class EMatrix
+{
+	// -----------------------------------------------------------
+	// Ver. 1.0
+
+public:
+
+	// Each row starts at an address aligned to kAlignment bytes 
+	// (a cache line, also the width of the AVX-512 register).
+	static constexpr std::size_t	kAlignment { 64 };
+
+	// The number of DataType elements in kAlignment bytes
+	static constexpr Dim			kAlignElems { kAlignment / sizeof( DataType ) };
+
+private:
+
+	// Frees a buffer that was allocated with the aligned operator new.
+	// A buffer which is not owned (e.g. a mapped file) is left untouched.
+	struct AlignedDeleter
+	{
+		bool	fOwner;
+
+		AlignedDeleter( void ) : fOwner( true ) {}
+		explicit AlignedDeleter( bool owner ) : fOwner( owner ) {}
+
+		void operator() ( DataType * p ) const { if( fOwner ) ::operator delete [] ( p, std::align_val_t( kAlignment ) ); }
+	};
+
+	using DataBuf = std::unique_ptr< DataType [], AlignedDeleter >;
+
+	// All elements are stored row-by-row in ONE contiguous buffer
+	DataBuf		fDataBuf;	// data structure (encapsulation)
+
+	Dim			fRows {};
+	Dim			fCols {};
+	Dim			fLeadDim {};	// distance (in elements) between beginnings of the two consecutive rows
+
+
+	// Rows are padded to a multiple of kAlignElems, so each of them is aligned
+	static Dim		ComputeLeadDim( Dim cols ) { return ( cols + kAlignElems - 1 ) / kAlignElems * kAlignElems; }
+
+	static DataBuf	AllocDataBuf( Dim elems )
+	{
+		return DataBuf( static_cast< DataType * >( ::operator new [] ( elems * sizeof( DataType ), std::align_val_t( kAlignment ) ) ) );
+	}
+
+	// Wraps an external buffer without copying and without taking its ownership.
+	// Only EMatrixMap uses it - it keeps the buffer alive longer than the matrix.
+	struct ExternalBuf {};
+
+	EMatrix( ExternalBuf, DataType * data, Dim rows, Dim cols, Dim lead_dim )
+		: fDataBuf( data, AlignedDeleter( false ) ), fRows( rows ), fCols( cols ), fLeadDim( lead_dim )
+	{
+		assert( lead_dim >= cols );
+	}
+
+	friend class EMatrixMap;
+
+public:
+
+	// A parametric constructor
+	EMatrix( Dim rows, Dim cols, DataType initVal = 0.0 )
+		: fDataBuf( AllocDataBuf( rows * ComputeLeadDim( cols ) ) ), fRows( rows ), fCols( cols ), fLeadDim( ComputeLeadDim( cols ) )
+	{	// matrix == one buffer of rows * fLeadDim doubles
+		assert( cols > 0 );
+		assert( rows > 0 );
+		std::fill_n( fDataBuf.get(), fRows * fLeadDim, initVal );
+	}
+
+	// Copy constructor - a deep copy of the buffer
+	EMatrix( const EMatrix & m )
+		: fDataBuf( AllocDataBuf( m.fRows * m.fLeadDim ) ), fRows( m.fRows ), fCols( m.fCols ), fLeadDim( m.fLeadDim )
+	{
+		std::copy_n( m.fDataBuf.get(), fRows * fLeadDim, fDataBuf.get() );
+	}
+
+	// Assignment operator
+	EMatrix & operator = ( const EMatrix & m )
+	{
+		if( this != & m )
+		{
+			// Reallocate only if the number of elements differs
+			if( fRows * fLeadDim != m.fRows * m.fLeadDim )
+				fDataBuf = AllocDataBuf( m.fRows * m.fLeadDim );
+
+			fRows = m.fRows;
+			fCols = m.fCols;
+			fLeadDim = m.fLeadDim;
+
+			std::copy_n( m.fDataBuf.get(), fRows * fLeadDim, fDataBuf.get() );
+		}
+		return * this;
+	}
+
+	// Move constructor and move assignment only exchange the buffers
+	EMatrix( EMatrix && m ) noexcept
+	{
+		Swap( m );
+	}
+
+	EMatrix & operator = ( EMatrix && m ) noexcept
+	{
+		Swap( m );
+		return * this;
+	}
+
+	void Swap( EMatrix & m ) noexcept
+	{
+		fDataBuf.swap( m.fDataBuf );
+		std::swap( fRows, m.fRows );
+		std::swap( fCols, m.fCols );
+		std::swap( fLeadDim, m.fLeadDim );
+	}
+
+
+	// Helpers
+	auto	GetCols( void ) const { return fCols; }
+	auto	GetRows( void ) const { return fRows; }
+	auto	GetLeadDim( void ) const { return fLeadDim; }
+
+	// Raw access to the buffer - row r starts at GetDataBuf() + r * GetLeadDim()
+	DataType *			GetDataBuf( void ) { return fDataBuf.get(); }
+	const DataType *	GetDataBuf( void ) const { return fDataBuf.get(); }
+
+
+	// -----------------------------------------------------------
+	// Ver. 2.0
+
+	// A light-weight view of a single row. It is returned by operator [],
+	// so m[2][3] still works, and it has begin/end for the range-based for loop.
+	template < typename T >
+	class RowProxy
+	{
+		T *		fRowPtr {};
+		Dim		fCols {};
+
+		friend class EMatrix;
+
+	public:
+
+		RowProxy( T * row_ptr, Dim cols ) : fRowPtr( row_ptr ), fCols( cols ) {}
+
+		T &		operator[] ( Dim idx ) const { assert( idx < fCols ); return fRowPtr[ idx ]; }
+
+		T *		begin() const { return fRowPtr; }
+		T *		end()	const { return fRowPtr + fCols; }
+
+		T *		data()	const { return fRowPtr; }
+		Dim		size()	const { return fCols; }
+	};
+
+	// Traverses the matrix row-by-row. The iterator holds a RowProxy
+	// and returns a reference to it, so "for( auto & row : m )" still compiles.
+	template < typename T >
+	class RowIterator
+	{
+		RowProxy< T >	fRow;
+		Dim				fLeadDim {};
+
+	public:
+
+		RowIterator( T * row_ptr, Dim cols, Dim lead_dim ) : fRow( row_ptr, cols ), fLeadDim( lead_dim ) {}
+
+		RowProxy< T > &	operator * () { return fRow; }
+		RowProxy< T > *	operator -> () { return & fRow; }
+
+		RowIterator &	operator ++ () { fRow.fRowPtr += fLeadDim; return * this; }
+
+		bool	operator == ( const RowIterator & it ) const { return fRow.fRowPtr == it.fRow.fRowPtr; }
+		bool	operator != ( const RowIterator & it ) const { return fRow.fRowPtr != it.fRow.fRowPtr; }
+	};
+
+	// As a result of overloaded subscript operators 
+	// instead of m.fData[2][3] we can write directly m[2][3] 
+	RowProxy< DataType >		operator[] ( Dim idx ) 
+		{ assert( idx < fRows ); return { fDataBuf.get() + idx * fLeadDim, fCols }; }
+	RowProxy< const DataType >	operator[] ( Dim idx ) const 
+		{ assert( idx < fRows ); return { fDataBuf.get() + idx * fLeadDim, fCols }; }
+
+	// We need only these two pairs of functions to have a range-based for loop
+	auto			begin() { return RowIterator< DataType >( fDataBuf.get(), fCols, fLeadDim ); }
+	auto			end()	{ return RowIterator< DataType >( fDataBuf.get() + fRows * fLeadDim, fCols, fLeadDim ); }
+
+	auto			begin() const { return RowIterator< const DataType >( fDataBuf.get(), fCols, fLeadDim ); }
+	auto			end()	const { return RowIterator< const DataType >( fDataBuf.get() + fRows * fLeadDim, fCols, fLeadDim ); }
+
+
+
+
+	// Let add some overloaded arithmetical operators
+	EMatrix &		operator += ( const EMatrix & b );	// this will probably change this object
+	EMatrix			operator + ( const EMatrix & b ) const;
+	// We can add other operators here ...
+
+
+	// friends are functions that can freely access fDataBuf
+	friend std::ostream & operator << ( std::ostream & o, const EMatrix & matrix );
+	friend std::istream & operator >> ( std::istream & i, EMatrix & matrix );
+
+
+};
+
+
+
+
+
+
+// ----------------------------------------
+// Part III
+
+EMatrix		operator + ( const EMatrix & a, const EMatrix & b );
+
+EMatrix		operator * ( const EMatrix & a, const EMatrix & b );
+
+
+
+
+
+#endif
+
+
+
+
@@ -0,0 +1,126 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+#pragma once
+
+
+#include "EMatrix.h"
+
+
+#if EM_VER > 1
+
+
+
+// -----------------------------------------------------------
+// Sparse matrices
+
+
+
+// Which of the dimensions is compressed
+enum class ESparseOrder { kCSR, kCSC };
+
+
+
+// A sparse matrix in the compressed sparse row (CSR) or
+// the compressed sparse column (CSC) format. Only the non-zero
+// elements are stored, together with their positions.
+//
+// In the CSR order, the elements of row r are at positions
+// [ fOffsets[ r ], fOffsets[ r + 1 ] ) of fIndices (their columns)
+// and fValues. In the CSC order, rows and columns swap their roles.
+// Indices in each row (column) are sorted in the ascending order.
+class SparseEMatrix
+{
+public:
+
+	using IdxVec = std::vector< Dim >;
+
+private:
+
+	ESparseOrder	fOrder { ESparseOrder::kCSR };
+
+	Dim				fRows {};
+	Dim				fCols {};
+
+	IdxVec			fOffsets;	// size is the compressed dimension + 1
+	IdxVec			fIndices;	// the other index of each non-zero element
+	RealVec			fValues;	// non-zero elements
+
+public:
+
+	// An all zero matrix (no elements stored)
+	SparseEMatrix( Dim rows, Dim cols, ESparseOrder order = ESparseOrder::kCSR );
+
+	// Takes over ready arrays - they must be consistent with the order and dimensions
+	SparseEMatrix( Dim rows, Dim cols, ESparseOrder order, IdxVec offsets, IdxVec indices, RealVec values );
+
+	// Converts a dense matrix. Elements with the absolute value 
+	// not greater than threshold are treated as zeros.
+	explicit SparseEMatrix( const EMatrix & m, ESparseOrder order = ESparseOrder::kCSR, DataType threshold = 0.0 );
+
+
+	// Helpers
+	auto	GetRows( void ) const { return fRows; }
+	auto	GetCols( void ) const { return fCols; }
+	auto	GetOrder( void ) const { return fOrder; }
+
+	auto	GetNonZeros( void ) const { return fValues.size(); }
+
+	// A fraction of the non-zero elements
+	double	GetDensity( void ) const { return static_cast< double >( GetNonZeros() ) / ( static_cast< double >( fRows ) * fCols ); }
+
+	const IdxVec &	GetOffsets( void ) const { return fOffsets; }
+	const IdxVec &	GetIndices( void ) const { return fIndices; }
+	const RealVec &	GetValues( void ) const { return fValues; }
+
+	// Values can be changed, but not the structure
+	RealVec &		GetValues( void ) { return fValues; }
+
+
+	// Returns an element at (r,c) - 0 if it is not stored.
+	// This is a binary search, so do not use it in loops.
+	DataType	GetElem( Dim r, Dim c ) const;
+
+
+	// Converts back to a dense matrix
+	EMatrix			ToDense( void ) const;
+
+	// Returns the same matrix in the requested order (a copy if the order does not change)
+	SparseEMatrix	ToOrder( ESparseOrder order ) const;
+
+	// Returns a transposed matrix - this is cheap since CSR of a matrix
+	// has exactly the same arrays as CSC of its transposition
+	SparseEMatrix	Transpose( void ) const;
+
+
+	friend std::ostream & operator << ( std::ostream & o, const SparseEMatrix & matrix );
+};
+
+
+
+// Parallel sparse matrix times a vector: y = a * x
+RealVec			operator * ( const SparseEMatrix & a, const RealVec & x );
+
+// Parallel sparse times dense matrix: c = a * b
+EMatrix			operator * ( const SparseEMatrix & a, const EMatrix & b );
+
+// Parallel sparse times sparse matrix: c = a * b
+// The result is in the CSR order.
+SparseEMatrix	operator * ( const SparseEMatrix & a, const SparseEMatrix & b );
+
+
+
+#endif
+
+
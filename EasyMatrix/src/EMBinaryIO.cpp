@@ -0,0 +1,344 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+// System headers in < >
+#include <fstream>
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+
+// Own header in " "
+#include "EMBinaryIO.h"
+
+
+
+#if EM_VER > 1
+
+
+
+namespace
+{
+
+	std::uint64_t	SwapBytes( std::uint64_t x )
+	{
+		x = ( x & 0x00000000FFFFFFFFull ) << 32 | ( x & 0xFFFFFFFF00000000ull ) >> 32;
+		x = ( x & 0x0000FFFF0000FFFFull ) << 16 | ( x & 0xFFFF0000FFFF0000ull ) >> 16;
+		x = ( x & 0x00FF00FF00FF00FFull ) << 8  | ( x & 0xFF00FF00FF00FF00ull ) >> 8;
+		return x;
+	}
+
+	std::uint32_t	SwapBytes( std::uint32_t x )
+	{
+		return static_cast< std::uint32_t >( SwapBytes( static_cast< std::uint64_t >( x ) ) >> 32 );
+	}
+
+	// Converts all the fields of a header written with the other endianness
+	void SwapHeader( EMBinaryHeader & h )
+	{
+		h.fVersion = SwapBytes( h.fVersion );
+		h.fEndianTag = SwapBytes( h.fEndianTag );
+		h.fDataType = SwapBytes( h.fDataType );
+		h.fHeaderSize = SwapBytes( h.fHeaderSize );
+		h.fRows = SwapBytes( h.fRows );
+		h.fCols = SwapBytes( h.fCols );
+		h.fLeadDim = SwapBytes( h.fLeadDim );
+		h.fChecksum = SwapBytes( h.fChecksum );
+	}
+
+	// Checks the header and returns true if it was written with the other endianness.
+	// Returns an empty optional if the header is wrong.
+	std::optional< bool > CheckHeader( EMBinaryHeader & h )
+	{
+		if( std::memcmp( h.fMagic, EMBinaryHeader::kMagic, sizeof( h.fMagic ) ) != 0 )
+			return std::nullopt;
+
+		const bool swapped = h.fEndianTag != EMBinaryHeader::kEndianTag;
+		if( swapped )
+			SwapHeader( h );
+
+		if( h.fEndianTag != EMBinaryHeader::kEndianTag 
+			|| h.fVersion != EMBinaryHeader::kVersion 
+			|| h.fDataType != EMBinaryHeader::kFloat64 
+			|| h.fHeaderSize != sizeof( EMBinaryHeader ) 
+			|| h.fRows == 0 || h.fCols == 0 || h.fLeadDim < h.fCols )
+			return std::nullopt;
+
+		return swapped;
+	}
+
+	// The size of the file with the data described by a checked header, or nothing
+	// if rows * fLeadDim * sizeof( DataType ) + header does not fit in 64 bits 
+	// (a broken or a malicious header). Each step is checked before it is multiplied.
+	std::optional< std::uint64_t > ExpectedFileSize( const EMBinaryHeader & h )
+	{
+		const std::uint64_t kMax { std::numeric_limits< std::size_t >::max() };
+
+		if( h.fLeadDim > kMax / sizeof( DataType ) )
+			return std::nullopt;
+
+		const std::uint64_t row_bytes = h.fLeadDim * sizeof( DataType );
+		if( h.fRows > ( kMax - sizeof( EMBinaryHeader ) ) / row_bytes )
+			return std::nullopt;
+
+		return sizeof( EMBinaryHeader ) + h.fRows * row_bytes;
+	}
+
+}
+
+
+
+// The FNV-1a hash computed on 64-bit words rather than bytes. 
+// Four independent lanes do not wait for each other's multiplications.
+std::uint64_t	ComputeChecksum( const DataType * data, Dim elems )
+{
+	const std::uint64_t kPrime { 0x100000001B3ull };
+
+	std::uint64_t	lanes[ 4 ] { 0xCBF29CE484222325ull, 0x84222325CBF29CE4ull, 0xCBF29CE4ull, 0x84222325ull };
+
+	Dim i {};
+	for( ; i + 4 <= elems; i += 4 )
+		for( Dim l = 0; l < 4; ++ l )
+		{
+			std::uint64_t word {};
+			std::memcpy( & word, data + i + l, sizeof( word ) );
+			lanes[ l ] = ( lanes[ l ] ^ word ) * kPrime;
+		}
+
+	for( ; i < elems; ++ i )
+	{
+		std::uint64_t word {};
+		std::memcpy( & word, data + i, sizeof( word ) );
+		lanes[ 0 ] = ( lanes[ 0 ] ^ word ) * kPrime;
+	}
+
+	std::uint64_t sum { lanes[ 0 ] };
+	for( Dim l = 1; l < 4; ++ l )
+		sum = ( sum ^ lanes[ l ] ) * kPrime;
+
+	return sum;
+}
+
+
+
+bool	WriteBinary( const EMatrix & m, const std::string & file_name )
+{
+	const auto elems = m.GetRows() * m.GetLeadDim();
+
+	EMBinaryHeader	header;
+	std::memcpy( header.fMagic, EMBinaryHeader::kMagic, sizeof( header.fMagic ) );
+	header.fVersion = EMBinaryHeader::kVersion;
+	header.fEndianTag = EMBinaryHeader::kEndianTag;
+	header.fDataType = EMBinaryHeader::kFloat64;
+	header.fHeaderSize = sizeof( EMBinaryHeader );
+	header.fRows = m.GetRows();
+	header.fCols = m.GetCols();
+	header.fLeadDim = m.GetLeadDim();
+	header.fChecksum = ComputeChecksum( m.GetDataBuf(), elems );
+
+	std::ofstream	out( file_name, std::ios::binary );
+
+	out.write( reinterpret_cast< const char * >( & header ), sizeof( header ) );
+	out.write( reinterpret_cast< const char * >( m.GetDataBuf() ), elems * sizeof( DataType ) );	// one bulk write
+
+	return out.good();
+}
+
+
+
+bool	ReadBinary( EMatrix & m, const std::string & file_name )
+{
+	std::ifstream	in( file_name, std::ios::binary );
+
+	EMBinaryHeader	header;
+	if( ! in.read( reinterpret_cast< char * >( & header ), sizeof( header ) ) )
+		return false;
+
+	const auto swapped = CheckHeader( header );
+	if( ! swapped )
+		return false;
+
+	// Nothing is allocated unless the file really holds that many elements
+	const auto expected_size = ExpectedFileSize( header );
+	if( ! expected_size || ! in.seekg( 0, std::ios::end ) )
+		return false;
+
+	const auto file_size = in.tellg();
+	if( file_size < 0 || static_cast< std::uint64_t >( file_size ) < * expected_size || ! in.seekg( sizeof( header ) ) )
+		return false;
+
+	const Dim	rows = header.fRows;
+	const Dim	cols = header.fCols;
+	const Dim	file_lead_dim = header.fLeadDim;
+
+	const Dim	file_elems = rows * file_lead_dim;
+
+	// Words are converted, so the checksum is always computed on the native values
+	auto convert_and_check = [ & header, swapped ] ( DataType * data, Dim elems )
+	{
+		if( * swapped )
+			for( Dim i = 0; i < elems; ++ i )
+			{
+				std::uint64_t word {};
+				std::memcpy( & word, data + i, sizeof( word ) );
+				word = SwapBytes( word );
+				std::memcpy( data + i, & word, sizeof( word ) );
+			}
+
+		return ComputeChecksum( data, elems ) == header.fChecksum;
+	};
+
+	EMatrix		tmp( rows, cols );
+
+	if( tmp.GetLeadDim() == file_lead_dim )
+	{
+		// The same layout - read everything at once
+		if( ! in.read( reinterpret_cast< char * >( tmp.GetDataBuf() ), file_elems * sizeof( DataType ) ) 
+			|| ! convert_and_check( tmp.GetDataBuf(), file_elems ) )
+			return false;
+	}
+	else
+	{
+		// The file was written with other padding - read it and copy row-by-row
+		RealVec	file_data( file_elems );
+		if( ! in.read( reinterpret_cast< char * >( file_data.data() ), file_elems * sizeof( DataType ) ) 
+			|| ! convert_and_check( file_data.data(), file_elems ) )
+			return false;
+
+		for( Dim r = 0; r < rows; ++ r )
+			std::copy_n( file_data.data() + r * file_lead_dim, cols, tmp.GetDataBuf() + r * tmp.GetLeadDim() );
+	}
+
+	m = std::move( tmp );
+	return true;
+}
+
+
+
+// -----------------------------------------------------------
+// EMatrixMap
+
+
+
+bool	EMatrixMap::Open( const std::string & file_name, bool verify_checksum )
+{
+	Close();
+
+#ifdef _WIN32
+
+	HANDLE file = CreateFileA( file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if( file == INVALID_HANDLE_VALUE )
+		return false;
+
+	LARGE_INTEGER	file_size {};
+	HANDLE mapping = GetFileSizeEx( file, & file_size ) ? CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr ) : nullptr;
+	void * addr = mapping != nullptr ? MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) : nullptr;
+	if( addr == nullptr )
+	{
+		if( mapping != nullptr )
+			CloseHandle( mapping );
+		CloseHandle( file );
+		return false;
+	}
+
+	fFileHandle = file;
+	fMappingHandle = mapping;
+	fMapAddr = addr;
+	fMapSize = static_cast< std::size_t >( file_size.QuadPart );
+
+#else
+
+	const int fd = open( file_name.c_str(), O_RDONLY );
+	if( fd < 0 )
+		return false;
+
+	struct stat file_stat {};
+	void * addr = fstat( fd, & file_stat ) == 0 && file_stat.st_size > 0 
+					? mmap( nullptr, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0 ) : MAP_FAILED;
+	close( fd );		// the mapping stays valid
+
+	if( addr == MAP_FAILED )
+		return false;
+
+	fMapAddr = addr;
+	fMapSize = static_cast< std::size_t >( file_stat.st_size );
+
+#endif
+
+	if( fMapSize < sizeof( EMBinaryHeader ) )
+	{
+		Close();
+		return false;
+	}
+
+	EMBinaryHeader	header;
+	std::memcpy( & header, fMapAddr, sizeof( header ) );
+
+	// Data cannot be converted in a read-only mapping
+	const auto swapped = CheckHeader( header );
+	const auto expected_size = swapped ? ExpectedFileSize( header ) : std::nullopt;
+	if( ! swapped || * swapped || ! expected_size || fMapSize < * expected_size )
+	{
+		Close();
+		return false;
+	}
+
+	// The data follow the header and the mapping starts at the page boundary, so they are aligned
+	auto * data = reinterpret_cast< DataType * >( static_cast< char * >( fMapAddr ) + sizeof( header ) );
+
+	if( verify_checksum && ComputeChecksum( data, header.fRows * header.fLeadDim ) != header.fChecksum )
+	{
+		Close();
+		return false;
+	}
+
+	fMatrix = EMatrix( EMatrix::ExternalBuf {}, data, header.fRows, header.fCols, header.fLeadDim );
+	return true;
+}
+
+
+
+void	EMatrixMap::Close( void )
+{
+	fMatrix.reset();		// does not free the data
+
+	if( fMapAddr == nullptr )
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile( fMapAddr );
+	CloseHandle( fMappingHandle );
+	CloseHandle( fFileHandle );
+	fMappingHandle = fFileHandle = nullptr;
+#else
+	munmap( fMapAddr, fMapSize );
+#endif
+
+	fMapAddr = nullptr;
+	fMapSize = 0;
+}
+
+
+
+#endif
+
+
@@ -1,188 +1,388 @@
-// ==========================================================================
-//
-// Software written by Boguslaw Cyganek (C) to be used with the book:
-// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
-// Published by Wiley, 2020
-//
-// The software is supplied as is and for educational purposes
-// without any guarantees nor responsibility of its use in any application. 
-//
-// ==========================================================================
-
-
-// System headers in < >
-#include <iostream>
-#include <fstream>
-
-
-// Own header in " "
-#include "EMUtility.h"
-#include "MarsXorShift.h"
-
-
-
-
-// Here we show hot to use "raw" RealMatrix
-void Easy_Matrix_First_Test( void )
-{
-
-	// -------------------------
-	// Using RealMatrix as it is
-
-	RealMatrix		m = {
-							{ 2, 2, 0, 11 },
-							{ 3, 4, 5, 0 },
-							{ -1, 2, -1, 7 }
-						};
-
-	// Add next row
-	m.push_back( { 5, 3, 5, -3 } );
-
-	// Accumulate elements except the diagonal
-	double non_diagonal_sum {};
-
-	for( Dim r = 0; r < m.size(); ++ r )
-		for( Dim c = 0; c < m[ 0 ].size(); ++ c )
-			if( c != r )
-				non_diagonal_sum += m[ r ][ c ];
-
-	std::cout << "Sum of m except the diagonal " << non_diagonal_sum << std::endl;
-
-
-}
-
-
-
-
-#if EM_VER == 1
-
-
-// To use a function we only need to provide its declaration.
-// However, to make a full program, function definitions must
-// be added in some of the source files.
-void		AskUserForMatrixData( EMatrix & m );
-void		ShowMatrix( const EMatrix & m );
-EMatrix		MultMatrix( const EMatrix & a, const EMatrix & b );
-
-
-
-
-// Here we show how to use EMatrix wrapper
-void Easy_Matrix_Second_Test( void )
-{
-	std::cout << "--------------------------------------------------------------" << std::endl;
-	std::cout << "In this example we will:" << std::endl;
-	std::cout << "* Create a 3x4 matrix M1 (you will be asked to enter its data)" << std::endl;
-	std::cout << "* Print M1" << std::endl;
-	std::cout << "* Create a 4x2 matrix M2 (you will be asked to enter its data)" << std::endl;
-	std::cout << "* Print M2" << std::endl;
-	std::cout << "* Compute and print a product M1 * M2" << std::endl;
-	std::cout << "--------------------------------------------------------------" << std::endl;
-
-
-	EMatrix		matrix_1( 3, 4 );
-	AskUserForMatrixData( matrix_1 );
-
-	std::cout << "You've just entered M1 - is it correct?" << std::endl;
-	ShowMatrix( matrix_1 );
-
-
-	EMatrix		matrix_2( 4, 2 );
-	AskUserForMatrixData( matrix_2 );
-
-	std::cout << "You've just entered M2 - is it correct?" << std::endl;
-	ShowMatrix( matrix_2 );
-
-
-	std::cout << "The matrix product of M1 * M2 is:" << std::endl;
-	ShowMatrix( MultMatrix( matrix_1, matrix_2 ) );
-
-
-
-}
-
-
-
-
-
-#else // EM_VER > 1
-
-
-// Here we show how to stream EMatrix objects in and out 
-void Easy_Matrix_Third_Test( void )
-{
-	EMatrix	matrix_1( 3, 3 );
-
-	RandInit( matrix_1 );
-
-
-	{
-		std::cout << matrix_1;	// stream it to the screen	
-		
-		std::ofstream oma( "ema.txt" );
-
-		oma << matrix_1;	// with the same operator << stream it to the file
-	}
-
-	{
-		EMatrix matrix_2( 1, 1 );	// there must be at least 1 element
-
-		std::ifstream ima( "ema.txt" );
-
-		ima >> matrix_2;			// stream in from an input file
-
-		std::cout << std::endl << matrix_2 << std::endl;		// show it on the screen
-	}
-
-
-	// With overloaded operators operations are even easier
-	//std::cout << "M1 + M1 = \n" << matrix_1 + matrix_1 << std::endl;	// 'operator +' is ambiguous
-	std::cout << "M1 + M1 = \n" << matrix_1.operator + ( matrix_1 ) << std::endl;	
-	std::cout << "M1 * M1 = \n" << matrix_1 * matrix_1 << std::endl;
-
-}
-
-
-// Here we show hot to stream out and in EMatrix objects
-void Easy_Matrix_Fourth_Test(void)
-{
-	EMatrix	matrix_1( 200, 200 ), matrix_2( 200, 200 );
-
-	RandInit( matrix_1 );
-	RandInit( matrix_2 );
-
-	EMatrix	matrix_3( matrix_1.operator + ( matrix_1 ) );
-
-	EMatrix	matrix_4( matrix_1 * matrix_2 );
-
-	std::cout << matrix_3[10][20] << std::endl;
-	std::cout << matrix_4[10][20] << std::endl;
-
-
-	// With overloaded operators operations are even easier
-	//std::cout << "M1 + M1 = \n" << matrix_1 + matrix_1 << std::endl;	// 'operator +' is ambiguous
-	//std::cout << "M1 + M1 = \n" << matrix_1.operator + (matrix_1) << std::endl;
-	//std::cout << "M1 * M1 = \n" << matrix_1 * matrix_1 << std::endl;
-
-}
-
-
-void Easy_Matrix_Zeroth_Test( void )
-{
-	EMatrix		m ( 2, 3 );
-	std::cin >> 	m; 		// Call the extraction operator upon std::cin and m
-	std::cout << 	m; 		// Call the insertion operator with std::cout and m
-
-
-	// The same as the call
-	operator << ( std::cout, m );	// Call the insertion operator with std::cout and m
-}
-
-
-
-#endif
-
-
-
-
-
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+// System headers in < >
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+
+
+// Own header in " "
+#include "EMUtility.h"
+#include "MarsXorShift.h"
+#include "SparseEMatrix.h"
+#include "EMBinaryIO.h"
+#include "EMTextIO.h"
+
+
+
+
+// Here we show hot to use "raw" RealMatrix
+void Easy_Matrix_First_Test( void )
+{
+
+	// -------------------------
+	// Using RealMatrix as it is
+
+	RealMatrix		m = {
+							{ 2, 2, 0, 11 },
+							{ 3, 4, 5, 0 },
+							{ -1, 2, -1, 7 }
+						};
+
+	// Add next row
+	m.push_back( { 5, 3, 5, -3 } );
+
+	// Accumulate elements except the diagonal
+	double non_diagonal_sum {};
+
+	for( Dim r = 0; r < m.size(); ++ r )
+		for( Dim c = 0; c < m[ 0 ].size(); ++ c )
+			if( c != r )
+				non_diagonal_sum += m[ r ][ c ];
+
+	std::cout << "Sum of m except the diagonal " << non_diagonal_sum << std::endl;
+
+
+}
+
+
+
+
+#if EM_VER == 1
+
+
+// To use a function we only need to provide its declaration.
+// However, to make a full program, function definitions must
+// be added in some of the source files.
+void		AskUserForMatrixData( EMatrix & m );
+void		ShowMatrix( const EMatrix & m );
+EMatrix		MultMatrix( const EMatrix & a, const EMatrix & b );
+
+
+
+
+// Here we show how to use EMatrix wrapper
+void Easy_Matrix_Second_Test( void )
+{
+	std::cout << "--------------------------------------------------------------" << std::endl;
+	std::cout << "In this example we will:" << std::endl;
+	std::cout << "* Create a 3x4 matrix M1 (you will be asked to enter its data)" << std::endl;
+	std::cout << "* Print M1" << std::endl;
+	std::cout << "* Create a 4x2 matrix M2 (you will be asked to enter its data)" << std::endl;
+	std::cout << "* Print M2" << std::endl;
+	std::cout << "* Compute and print a product M1 * M2" << std::endl;
+	std::cout << "--------------------------------------------------------------" << std::endl;
+
+
+	EMatrix		matrix_1( 3, 4 );
+	AskUserForMatrixData( matrix_1 );
+
+	std::cout << "You've just entered M1 - is it correct?" << std::endl;
+	ShowMatrix( matrix_1 );
+
+
+	EMatrix		matrix_2( 4, 2 );
+	AskUserForMatrixData( matrix_2 );
+
+	std::cout << "You've just entered M2 - is it correct?" << std::endl;
+	ShowMatrix( matrix_2 );
+
+
+	std::cout << "The matrix product of M1 * M2 is:" << std::endl;
+	ShowMatrix( MultMatrix( matrix_1, matrix_2 ) );
+
+
+
+}
+
+
+
+
+
+#else // EM_VER > 1
+
+
+// Here we show how to stream EMatrix objects in and out 
+void Easy_Matrix_Third_Test( void )
+{
+	EMatrix	matrix_1( 3, 3 );
+
+	RandInit( matrix_1 );
+
+
+	{
+		std::cout << matrix_1;	// stream it to the screen	
+		
+		std::ofstream oma( "ema.txt" );
+
+		oma << matrix_1;	// with the same operator << stream it to the file
+	}
+
+	{
+		EMatrix matrix_2( 1, 1 );	// there must be at least 1 element
+
+		std::ifstream ima( "ema.txt" );
+
+		ima >> matrix_2;			// stream in from an input file
+
+		std::cout << std::endl << matrix_2 << std::endl;		// show it on the screen
+	}
+
+
+	// With overloaded operators operations are even easier
+	//std::cout << "M1 + M1 = \n" << matrix_1 + matrix_1 << std::endl;	// 'operator +' is ambiguous
+	std::cout << "M1 + M1 = \n" << matrix_1.operator + ( matrix_1 ) << std::endl;	
+	std::cout << "M1 * M1 = \n" << matrix_1 * matrix_1 << std::endl;
+
+}
+
+
+// Here we show hot to stream out and in EMatrix objects
+void Easy_Matrix_Fourth_Test(void)
+{
+	EMatrix	matrix_1( 200, 200 ), matrix_2( 200, 200 );
+
+	RandInit( matrix_1 );
+	RandInit( matrix_2 );
+
+	EMatrix	matrix_3( matrix_1.operator + ( matrix_1 ) );
+
+	EMatrix	matrix_4( matrix_1 * matrix_2 );
+
+	std::cout << matrix_3[10][20] << std::endl;
+	std::cout << matrix_4[10][20] << std::endl;
+
+
+	// With overloaded operators operations are even easier
+	//std::cout << "M1 + M1 = \n" << matrix_1 + matrix_1 << std::endl;	// 'operator +' is ambiguous
+	//std::cout << "M1 + M1 = \n" << matrix_1.operator + (matrix_1) << std::endl;
+	//std::cout << "M1 * M1 = \n" << matrix_1 * matrix_1 << std::endl;
+
+}
+
+
+void Easy_Matrix_Zeroth_Test( void )
+{
+	EMatrix		m ( 2, 3 );
+	std::cin >> 	m; 		// Call the extraction operator upon std::cin and m
+	std::cout << 	m; 		// Call the insertion operator with std::cout and m
+
+
+	// The same as the call
+	operator << ( std::cout, m );	// Call the insertion operator with std::cout and m
+}
+
+
+
+// Compares the sparse and the dense products for matrices
+// with different fractions of the non-zero elements
+void Sparse_Matrix_Test( void )
+{
+	const Dim dim { 1000 };
+
+	MarsXorShift	randMachine;
+
+	// Returns the execution time of fun in milliseconds
+	auto time_it = [] ( auto fun )
+	{
+		const auto start = std::chrono::steady_clock::now();
+		fun();
+		return std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - start ).count();
+	};
+
+	auto max_diff = [] ( const EMatrix & a, const EMatrix & b )
+	{
+		DataType diff {};
+		for( Dim r = 0; r < a.GetRows(); ++ r )
+			for( Dim c = 0; c < a.GetCols(); ++ c )
+				diff = std::max( diff, std::fabs( a[ r ][ c ] - b[ r ][ c ] ) );
+		return diff;
+	};
+
+	EMatrix		b( dim, dim );
+	RandInit( b );
+
+	EMatrix		x_col( dim, 1 );	// the same vector as a dense matrix
+	RealVec		x( dim );
+	for( Dim i = 0; i < dim; ++ i )
+		x[ i ] = x_col[ i ][ 0 ] = randMachine.GetNext() & 0xFF;
+
+	for( const double density : { 0.001, 0.01, 0.05, 0.2 } )
+	{
+		// Approximately density * dim * dim elements will not be 0
+		EMatrix		a( dim, dim );
+		const auto	kThresh = static_cast< unsigned long >( density * 0xFFFF );
+		for( auto & row : a )
+			for( auto & data : row )
+				if( ( randMachine.GetNext() & 0xFFFF ) < kThresh )
+					data = randMachine.GetNext() & 0xFF;
+
+		const SparseEMatrix		sa( a );
+
+		EMatrix			c_dense( 1, 1 ), c_sparse_dense( 1, 1 ), c_dense_sq( 1, 1 ), c_dense_vec( 1, 1 );
+		SparseEMatrix	c_sparse_sparse( 1, 1 );
+		RealVec			y;
+
+		const auto t_dense = time_it( [ & ] { c_dense = a * b; } );
+		const auto t_sparse_dense = time_it( [ & ] { c_sparse_dense = sa * b; } );
+
+		const auto t_dense_sq = time_it( [ & ] { c_dense_sq = a * a; } );
+		const auto t_sparse_sparse = time_it( [ & ] { c_sparse_sparse = sa * sa; } );
+
+		const auto t_dense_vec = time_it( [ & ] { c_dense_vec = a * x_col; } );
+		const auto t_sparse_vec = time_it( [ & ] { y = sa * x; } );
+
+		DataType vec_diff {};
+		for( Dim i = 0; i < dim; ++ i )
+			vec_diff = std::max( vec_diff, std::fabs( y[ i ] - c_dense_vec[ i ][ 0 ] ) );
+
+		std::cout << "Density " << sa.GetDensity() << " (" << sa.GetNonZeros() << " non-zeros)" << std::endl;
+		std::cout << "\tA * B  dense: " << t_dense << " ms, sparse * dense: " << t_sparse_dense << " ms, diff: " << max_diff( c_dense, c_sparse_dense ) << std::endl;
+		std::cout << "\tA * A  dense: " << t_dense_sq << " ms, sparse * sparse: " << t_sparse_sparse << " ms, diff: " << max_diff( c_dense_sq, c_sparse_sparse.ToDense() ) << std::endl;
+		std::cout << "\tA * x  dense: " << t_dense_vec << " ms, sparse: " << t_sparse_vec << " ms, diff: " << vec_diff << std::endl;
+	}
+}
+
+
+
+// Compares the text and the binary formats of EMatrix
+void Binary_IO_Test( void )
+{
+	const Dim dim { 2000 };
+
+	auto time_it = [] ( auto fun )
+	{
+		const auto start = std::chrono::steady_clock::now();
+		fun();
+		return std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - start ).count();
+	};
+
+	EMatrix		matrix_1( dim, dim );
+	RandInit( matrix_1 );
+
+	EMatrix		matrix_2( 1, 1 ), matrix_3( 1, 1 );
+
+	const auto t_text_write = time_it( [ & ] { std::ofstream oma( "ema.txt" ); oma << matrix_1; } );
+	const auto t_text_read = time_it( [ & ] { std::ifstream ima( "ema.txt" ); ima >> matrix_2; } );
+
+	bool ok {};
+	const auto t_bin_write = time_it( [ & ] { ok = WriteBinary( matrix_1, "ema.bin" ); } );
+	const auto t_bin_read = time_it( [ & ] { ok = ok && ReadBinary( matrix_3, "ema.bin" ); } );
+
+	// The mapped matrix is read-only, but it can be used as any other const EMatrix
+	EMatrixMap	map;
+	const auto t_map = time_it( [ & ] { ok = ok && map.Open( "ema.bin" ); } );
+
+	DataType sum {};
+	const auto t_map_sum = time_it( [ & ] { for( const auto & row : map.GetMatrix() ) for( const auto & data : row ) sum += data; } );
+
+	std::cout << "Text:   write " << t_text_write << " ms, read " << t_text_read << " ms" << std::endl;
+	std::cout << "Binary: write " << t_bin_write << " ms, read " << t_bin_read << " ms, map " << t_map << " ms (+ " << t_map_sum << " ms to touch all data)" << std::endl;
+	std::cout << "Binary files " << ( ok ? "are OK" : "failed" ) << ", sum of elements: " << sum << std::endl;
+	std::cout << "Element [10][20]: " << matrix_1[ 10 ][ 20 ] << " " << matrix_3[ 10 ][ 20 ] << " " << map.GetMatrix()[ 10 ][ 20 ] << std::endl;
+
+	// A header with huge dimensions must be rejected before anything is allocated
+	EMBinaryHeader	header;
+	{
+		std::ifstream	in( "ema.bin", std::ios::binary );
+		in.read( reinterpret_cast< char * >( & header ), sizeof( header ) );
+	}
+	header.fRows = header.fLeadDim = header.fCols = std::uint64_t( 1 ) << 62;
+	{
+		std::ofstream	out( "ema_bad.bin", std::ios::binary );
+		out.write( reinterpret_cast< const char * >( & header ), sizeof( header ) );
+	}
+
+	EMatrixMap	bad_map;
+	const bool rejected = ! ReadBinary( matrix_3, "ema_bad.bin" ) && ! bad_map.Open( "ema_bad.bin" );
+	std::cout << "Broken header " << ( rejected ? "is rejected" : "was accepted!" ) << std::endl;
+}
+
+
+
+
+// Shows how rows which do not fit are reported by the text reader
+void Text_IO_Test( void )
+{
+	std::istringstream	text(	"1 2 3\n"
+								"4, 5, 6\n"
+								"\n"
+								"7 8\n"
+								"9 x 11\n"
+								"12 13 14" );
+
+	EMatrix			matrix_1( 1, 1 );
+	EMTextReport	report;
+
+	if( ! ReadText( text, matrix_1, report ) )
+		for( const auto & bad_row : report.fBadRows )
+			std::cout << "Line " << bad_row.fLine << ": " << ( bad_row.fBadNumber ? "not a number" : "wrong number of elements" ) 
+						<< " (" << bad_row.fElems << " read, " << report.fCols << " expected)" << std::endl;
+
+
+	// Text is formatted and converted in parallel
+	EMatrix			matrix_2( 3000, 3000 ), matrix_3( 1, 1 );
+	RandInit( matrix_2 );
+
+	{
+		std::ofstream	oma( "ema.txt", std::ios::binary );
+		WriteText( oma, matrix_2 );
+	}
+
+	std::ifstream	ima( "ema.txt", std::ios::binary );
+	std::cout << ( ReadText( ima, matrix_3, report ) ? "Read " : "Failed to read " ) << report.fRows << " x " << report.fCols << std::endl;
+
+
+	// operator << follows the precision and the notation of the stream,
+	// so it gives the same text as the elements written one by one
+	EMatrix			matrix_4( 2, 3 );
+	const DataType	values[] { 1.0 / 3.0, -2.5e-7, 12345.678, 0.0, 1e20, -7.0 };
+	for( Dim r = 0; r < 2; ++ r )
+		for( Dim c = 0; c < 3; ++ c )
+			matrix_4[ r ][ c ] = values[ r * 3 + c ];
+
+	auto same_as_stream = [ & matrix_4 ] ( auto set_stream )
+	{
+		std::ostringstream	fast, slow;
+		set_stream( fast );
+		set_stream( slow );
+
+		fast << matrix_4;
+		for( const auto & row : matrix_4 )
+			for( Dim c = 0; c < row.size(); ++ c )
+				slow << row[ c ] << ( c + 1 < row.size() ? '\t' : '\n' );
+
+		return fast.str() == slow.str();
+	};
+
+	const bool same = same_as_stream( [] ( std::ostream & ) {} )
+						&& same_as_stream( [] ( std::ostream & o ) { o << std::setprecision( 3 ); } )
+						&& same_as_stream( [] ( std::ostream & o ) { o << std::fixed << std::setprecision( 2 ); } )
+						&& same_as_stream( [] ( std::ostream & o ) { o << std::scientific << std::setprecision( 10 ); } );
+
+	std::cout << "operator << " << ( same ? "follows" : "ignores" ) << " the stream settings" << std::endl;
+}
+
+
+
+
+
+#endif
+
+
+
+
+
@@ -0,0 +1,284 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+// System headers in < >
+#include <iostream>
+#include <charconv>
+#include <cstring>
+
+
+// Own header in " "
+#include "EMTextIO.h"
+
+
+
+#if EM_VER > 1
+
+
+
+namespace
+{
+
+	// The size of a block read from the input stream
+	constexpr std::size_t	kReadBlockSize { 1 << 24 };
+
+	// Each block is split into so many parts, converted in parallel
+	constexpr std::size_t	kParseParts { 64 };
+
+	// Rows of a matrix are formatted in so many parts at a time
+	constexpr Dim			kFormatParts { 64 };
+
+	// The longest text of a double from std::to_chars, e.g. -2.2250738585072014e-308
+	constexpr std::size_t	kMaxCharsPerElem { 24 };
+
+
+
+	bool	IsSeparator( char c ) { return c == ' ' || c == '\t' || c == '\r' || c == ',' || c == ';'; }
+
+
+	// Elements read from a part of the text, 
+	// and the number of elements in each of its lines
+	struct ParsedPart
+	{
+		RealVec					fData;
+		std::vector< Dim >		fLineElems;
+		std::vector< bool >		fLineBadNumber;
+	};
+
+
+	// Converts all the lines in [ first, last ). The last line can be without '\n'.
+	void	ParsePart( const char * first, const char * last, ParsedPart & part )
+	{
+		part.fData.clear();
+		part.fLineElems.clear();
+		part.fLineBadNumber.clear();
+
+		while( first < last )
+		{
+			const char * line_end = static_cast< const char * >( std::memchr( first, '\n', last - first ) );
+			if( line_end == nullptr )
+				line_end = last;
+
+			Dim		elems {};
+			bool	bad_number {};
+
+			for( const char * p = first; ; )
+			{
+				while( p < line_end && IsSeparator( * p ) )
+					++ p;
+
+				if( p == line_end )
+					break;
+
+				if( * p == '+' )		// from_chars does not accept the plus sign
+					++ p;
+
+				DataType	data {};
+				const auto [ ptr, ec ] = std::from_chars( p, line_end, data );
+				if( ec != std::errc() || ( ptr < line_end && ! IsSeparator( * ptr ) ) )
+				{
+					bad_number = true;
+					break;
+				}
+
+				part.fData.push_back( data );
+				++ elems;
+				p = ptr;
+			}
+
+			part.fLineElems.push_back( elems );
+			part.fLineBadNumber.push_back( bad_number );
+
+			first = line_end + 1;
+		}
+	}
+
+
+	// Writes the rows of m, each element with format_elem( p, buf_end, data ), 
+	// which returns the end of its text of at most max_chars characters
+	template < typename FormatElem >
+	bool	WriteRows( std::ostream & out, const EMatrix & m, char separator, std::size_t max_chars, FormatElem format_elem )
+	{
+		const auto rows = m.GetRows();
+		const auto cols = m.GetCols();
+
+		// Each part formats the same number of rows into its own buffer.
+		// Batches are limited to about 64 MB of text and the buffers are reused.
+		const Dim	rows_per_part = std::max( Dim( 1 ), ( Dim( 1 ) << 26 ) / ( kFormatParts * cols * ( max_chars + 1 ) ) );
+		const Dim	rows_per_batch = rows_per_part * kFormatParts;
+
+		std::vector< std::vector< char > >	buffers( kFormatParts );
+		std::vector< std::size_t >			used( kFormatParts );
+
+		for( Dim batch_first = 0; batch_first < rows && out; batch_first += rows_per_batch )
+		{
+			#pragma omp parallel for schedule( dynamic )
+			for( Dim i = 0; i < kFormatParts; ++ i )
+			{
+				const Dim	first_row = std::min( rows, batch_first + i * rows_per_part );
+				const Dim	last_row = std::min( rows, first_row + rows_per_part );
+
+				auto &	buf = buffers[ i ];
+				buf.resize( std::max( buf.size(), ( last_row - first_row ) * cols * ( max_chars + 1 ) ) );
+
+				char *	p = buf.data();
+				char *	buf_end = buf.data() + buf.size();
+
+				for( Dim r = first_row; r < last_row; ++ r )
+				{
+					const DataType * row = m.GetDataBuf() + r * m.GetLeadDim();
+					for( Dim c = 0; c < cols; ++ c )
+					{
+						p = format_elem( p, buf_end, row[ c ] );
+						* p ++ = c + 1 < cols ? separator : '\n';
+					}
+				}
+
+				used[ i ] = p - buf.data();
+			}
+
+			for( Dim i = 0; i < kFormatParts; ++ i )
+				out.write( buffers[ i ].data(), used[ i ] );
+		}
+
+		return out.good();
+	}
+
+}
+
+
+
+bool	ReadText( std::istream & in, EMatrix & m, EMTextReport & report )
+{
+	report = EMTextReport();
+
+	std::vector< ParsedPart >	parts( kParseParts );
+
+	RealVec		all_data;		// all elements, row after row
+	Dim			line_no {};
+
+	std::string	block, carry;	// carry is an unfinished line from the previous block
+
+	for( bool last_block = false; ! last_block; )
+	{
+		block.swap( carry );
+		const auto carry_size = block.size();
+
+		block.resize( carry_size + kReadBlockSize );
+		in.read( & block[ carry_size ], kReadBlockSize );
+		block.resize( carry_size + in.gcount() );
+
+		last_block = in.gcount() < static_cast< std::streamsize >( kReadBlockSize );
+
+		// Only complete lines are converted, the rest waits for the next block
+		auto block_end = block.size();
+		if( ! last_block )
+		{
+			const auto last_new_line = block.rfind( '\n' );
+			block_end = last_new_line == std::string::npos ? 0 : last_new_line + 1;
+		}
+
+		carry.assign( block, block_end, std::string::npos );
+
+		// Split the block into parts that begin at line boundaries
+		const char *				block_first = block.data();
+		std::vector< const char * >	bounds( kParseParts + 1, block_first + block_end );
+		bounds[ 0 ] = block_first;
+		for( std::size_t i = 1; i < kParseParts; ++ i )
+		{
+			const char * p = std::max( bounds[ i - 1 ], block_first + i * block_end / kParseParts );
+			const char * new_line = p < bounds[ kParseParts ] ? static_cast< const char * >( std::memchr( p, '\n', bounds[ kParseParts ] - p ) ) : nullptr;
+			bounds[ i ] = new_line != nullptr ? new_line + 1 : bounds[ kParseParts ];
+		}
+
+		#pragma omp parallel for schedule( dynamic )
+		for( std::size_t i = 0; i < kParseParts; ++ i )
+			ParsePart( bounds[ i ], bounds[ i + 1 ], parts[ i ] );
+
+		// Now check the lines in the order of the text and collect the good ones
+		for( const auto & part : parts )
+		{
+			const DataType * data = part.fData.data();
+
+			for( Dim l = 0; l < part.fLineElems.size(); ++ l )
+			{
+				const auto elems = part.fLineElems[ l ];
+				++ line_no;
+
+				if( elems == 0 && ! part.fLineBadNumber[ l ] )
+					continue;			// skip empty lines
+
+				if( report.fCols == 0 && ! part.fLineBadNumber[ l ] )
+					report.fCols = elems;	// the first row determines the number of columns
+
+				if( elems != report.fCols || part.fLineBadNumber[ l ] )
+				{
+					report.fBadRows.push_back( { line_no, elems, part.fLineBadNumber[ l ] } );
+				}
+				else
+				{
+					if( report.fBadRows.empty() )	// after an error there is no need to collect the data
+						all_data.insert( all_data.end(), data, data + elems );
+
+					++ report.fRows;
+				}
+
+				data += elems;
+			}
+		}
+	}
+
+	if( in.bad() || report.fRows == 0 || ! report.fBadRows.empty() )
+		return false;
+
+	// Copy row-by-row into the aligned buffer
+	const auto rows = report.fRows;
+	const auto cols = report.fCols;
+
+	EMatrix		tmp( rows, cols );
+
+	#pragma omp parallel for schedule( static )
+	for( Dim r = 0; r < rows; ++ r )
+		std::copy_n( & all_data[ r * cols ], cols, tmp.GetDataBuf() + r * tmp.GetLeadDim() );
+
+	m = std::move( tmp );
+	return true;
+}
+
+
+
+bool	WriteText( std::ostream & out, const EMatrix & m, char separator )
+{
+	return WriteRows( out, m, separator, kMaxCharsPerElem, 
+						[] ( char * p, char * last, DataType data ) { return std::to_chars( p, last, data ).ptr; } );
+}
+
+
+
+bool	WriteText( std::ostream & out, const EMatrix & m, std::chars_format format, int precision, char separator )
+{
+	assert( precision >= 0 );
+
+	// The sign, the point, the exponent and at most 309 digits before the point
+	const std::size_t	max_chars = precision + ( format == std::chars_format::fixed ? 312 : kMaxCharsPerElem );
+
+	return WriteRows( out, m, separator, max_chars, 
+						[ format, precision ] ( char * p, char * last, DataType data ) { return std::to_chars( p, last, data, format, precision ).ptr; } );
+}
+
+
+
+#endif
+
+
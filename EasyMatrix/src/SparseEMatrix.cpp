@@ -0,0 +1,399 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+// System headers in < >
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+
+// Own header in " "
+#include "SparseEMatrix.h"
+
+
+
+#if EM_VER > 1
+
+
+
+// -----------------------------------------------------------
+// Construction and conversions
+
+
+
+SparseEMatrix::SparseEMatrix( Dim rows, Dim cols, ESparseOrder order )
+	: fOrder( order ), fRows( rows ), fCols( cols ), fOffsets( ( order == ESparseOrder::kCSR ? rows : cols ) + 1, 0 )
+{
+	assert( cols > 0 );
+	assert( rows > 0 );
+}
+
+SparseEMatrix::SparseEMatrix( Dim rows, Dim cols, ESparseOrder order, IdxVec offsets, IdxVec indices, RealVec values )
+	: fOrder( order ), fRows( rows ), fCols( cols ), fOffsets( std::move( offsets ) ), fIndices( std::move( indices ) ), fValues( std::move( values ) )
+{
+	assert( cols > 0 );
+	assert( rows > 0 );
+	assert( fOffsets.size() == ( order == ESparseOrder::kCSR ? rows : cols ) + 1 );
+	assert( fOffsets.front() == 0 && fOffsets.back() == fValues.size() );
+	assert( fIndices.size() == fValues.size() );
+}
+
+SparseEMatrix::SparseEMatrix( const EMatrix & m, ESparseOrder order, DataType threshold )
+	: fOrder( ESparseOrder::kCSR ), fRows( m.GetRows() ), fCols( m.GetCols() ), fOffsets( m.GetRows() + 1, 0 )
+{
+	const auto rows = fRows;
+	const auto cols = fCols;
+
+	auto is_non_zero = [ threshold ] ( DataType v ) { return std::fabs( v ) > threshold; };
+
+	// The first pass counts the non-zero elements in each row.
+	// Rows are independent, so they can be processed in parallel.
+	#pragma omp parallel for schedule( static )
+	for( Dim r = 0; r < rows; ++ r )
+	{
+		const DataType * m_row = m.GetDataBuf() + r * m.GetLeadDim();
+		fOffsets[ r + 1 ] = std::count_if( m_row, m_row + cols, is_non_zero );
+	}
+
+	// Now the counts become the positions of the rows
+	std::partial_sum( fOffsets.begin(), fOffsets.end(), fOffsets.begin() );
+
+	fIndices.resize( fOffsets.back() );
+	fValues.resize( fOffsets.back() );
+
+	// The second pass copies the elements - each row to its own place
+	#pragma omp parallel for schedule( static )
+	for( Dim r = 0; r < rows; ++ r )
+	{
+		const DataType * m_row = m.GetDataBuf() + r * m.GetLeadDim();
+
+		auto pos = fOffsets[ r ];
+		for( Dim c = 0; c < cols; ++ c )
+			if( is_non_zero( m_row[ c ] ) )
+			{
+				fIndices[ pos ] = c;
+				fValues[ pos ] = m_row[ c ];
+				++ pos;
+			}
+	}
+
+	if( order == ESparseOrder::kCSC )
+		* this = ToOrder( ESparseOrder::kCSC );
+}
+
+
+
+DataType	SparseEMatrix::GetElem( Dim r, Dim c ) const
+{
+	assert( r < fRows );
+	assert( c < fCols );
+
+	const auto major = fOrder == ESparseOrder::kCSR ? r : c;
+	const auto minor = fOrder == ESparseOrder::kCSR ? c : r;
+
+	const auto first = fIndices.begin() + fOffsets[ major ];
+	const auto last = fIndices.begin() + fOffsets[ major + 1 ];
+
+	const auto pos = std::lower_bound( first, last, minor );
+	return pos != last && * pos == minor ? fValues[ pos - fIndices.begin() ] : 0.0;
+}
+
+
+
+EMatrix		SparseEMatrix::ToDense( void ) const
+{
+	EMatrix	m( fRows, fCols, 0.0 );
+
+	const auto major_dim = fOffsets.size() - 1;
+
+	// Each row (column) writes to different elements of m
+	#pragma omp parallel for schedule( static )
+	for( Dim j = 0; j < major_dim; ++ j )
+		for( Dim k = fOffsets[ j ]; k < fOffsets[ j + 1 ]; ++ k )
+		{
+			const auto r = fOrder == ESparseOrder::kCSR ? j : fIndices[ k ];
+			const auto c = fOrder == ESparseOrder::kCSR ? fIndices[ k ] : j;
+			m.GetDataBuf()[ r * m.GetLeadDim() + c ] = fValues[ k ];
+		}
+
+	return m;
+}
+
+
+
+SparseEMatrix	SparseEMatrix::ToOrder( ESparseOrder order ) const
+{
+	if( order == fOrder )
+		return * this;
+
+	// Changing the order is the same as transposing the compressed arrays.
+	// This is a counting sort - first count the elements for each index ...
+	const auto major_dim = fOffsets.size() - 1;
+	const auto minor_dim = order == ESparseOrder::kCSR ? fRows : fCols;
+
+	IdxVec	offsets( minor_dim + 1, 0 );
+	for( const auto idx : fIndices )
+		++ offsets[ idx + 1 ];
+
+	std::partial_sum( offsets.begin(), offsets.end(), offsets.begin() );
+
+	// ... then put each element in its place. Since we go in
+	// the ascending order, the new indices come out sorted.
+	IdxVec	indices( fIndices.size() );
+	RealVec	values( fValues.size() );
+
+	IdxVec	next_pos( offsets.begin(), offsets.end() - 1 );
+	for( Dim j = 0; j < major_dim; ++ j )
+		for( Dim k = fOffsets[ j ]; k < fOffsets[ j + 1 ]; ++ k )
+		{
+			const auto dst = next_pos[ fIndices[ k ] ] ++;
+			indices[ dst ] = j;
+			values[ dst ] = fValues[ k ];
+		}
+
+	return SparseEMatrix( fRows, fCols, order, std::move( offsets ), std::move( indices ), std::move( values ) );
+}
+
+
+
+SparseEMatrix	SparseEMatrix::Transpose( void ) const
+{
+	const auto order = fOrder == ESparseOrder::kCSR ? ESparseOrder::kCSC : ESparseOrder::kCSR;
+	return SparseEMatrix( fCols, fRows, order, fOffsets, fIndices, fValues );
+}
+
+
+
+// Streams out the non-zero elements, one "row col value" triple per line
+std::ostream & operator << ( std::ostream & out, const SparseEMatrix & matrix )
+{
+	const auto major_dim = matrix.fOffsets.size() - 1;
+
+	for( Dim j = 0; j < major_dim; ++ j )
+		for( Dim k = matrix.fOffsets[ j ]; k < matrix.fOffsets[ j + 1 ]; ++ k )
+		{
+			const auto r = matrix.fOrder == ESparseOrder::kCSR ? j : matrix.fIndices[ k ];
+			const auto c = matrix.fOrder == ESparseOrder::kCSR ? matrix.fIndices[ k ] : j;
+			out << r << "\t" << c << "\t" << matrix.fValues[ k ] << std::endl;
+		}
+
+	return out;
+}
+
+
+
+
+// -----------------------------------------------------------
+// Products
+
+
+
+RealVec			operator * ( const SparseEMatrix & a, const RealVec & x )
+{
+	assert( a.GetCols() == x.size() );
+
+	const auto rows = a.GetRows();
+	const auto cols = a.GetCols();
+
+	const auto & offsets = a.GetOffsets();
+	const auto & indices = a.GetIndices();
+	const auto & values = a.GetValues();
+
+	RealVec	y( rows, 0.0 );
+
+	if( a.GetOrder() == ESparseOrder::kCSR )
+	{
+		// Each element of y is a sparse dot product of a row and x.
+		// Rows can have very different lengths, hence the dynamic schedule.
+		#pragma omp parallel for schedule( dynamic, 256 )
+		for( Dim r = 0; r < rows; ++ r )
+		{
+			DataType sum {};
+			for( Dim k = offsets[ r ]; k < offsets[ r + 1 ]; ++ k )
+				sum += values[ k ] * x[ indices[ k ] ];
+
+			y[ r ] = sum;
+		}
+	}
+	else
+	{
+		// Each column is scattered to the whole y, so each thread
+		// accumulates in its own copy and these are added at the end
+		#pragma omp parallel
+		{
+			RealVec	y_loc( rows, 0.0 );
+
+			#pragma omp for schedule( static ) nowait
+			for( Dim c = 0; c < cols; ++ c )
+			{
+				const auto x_c = x[ c ];
+				for( Dim k = offsets[ c ]; k < offsets[ c + 1 ]; ++ k )
+					y_loc[ indices[ k ] ] += values[ k ] * x_c;
+			}
+
+			#pragma omp critical
+			for( Dim r = 0; r < rows; ++ r )
+				y[ r ] += y_loc[ r ];
+		}
+	}
+
+	return y;
+}
+
+
+
+EMatrix			operator * ( const SparseEMatrix & a, const EMatrix & b )
+{
+	assert( a.GetCols() == b.GetRows() );
+
+	// Rows of the result are independent only if a is stored by rows.
+	// Conversion costs O(nnz), which is much less than the product.
+	if( a.GetOrder() != ESparseOrder::kCSR )
+		return a.ToOrder( ESparseOrder::kCSR ) * b;
+
+	const auto rows = a.GetRows();
+	const auto b_cols = b.GetCols();
+
+	const auto & offsets = a.GetOffsets();
+	const auto & indices = a.GetIndices();
+	const auto & values = a.GetValues();
+
+	EMatrix	c( rows, b_cols, 0.0 );
+
+	// The same ikj order as in the dense operator *, but only 
+	// the non-zero elements of a row of a are visited
+	#pragma omp parallel for schedule( dynamic, 16 )
+	for( Dim r = 0; r < rows; ++ r )
+	{
+		DataType *	c_row = c.GetDataBuf() + r * c.GetLeadDim();
+
+		for( Dim k = offsets[ r ]; k < offsets[ r + 1 ]; ++ k )
+		{
+			const DataType		a_val = values[ k ];
+			const DataType *	b_row = b.GetDataBuf() + indices[ k ] * b.GetLeadDim();
+
+			for( Dim bc = 0; bc < b_cols; ++ bc )
+				c_row[ bc ] += a_val * b_row[ bc ];
+		}
+	}
+
+	return c;
+}
+
+
+
+// The row-by-row Gustavson's algorithm. Row r of c is a linear combination
+// of the rows of b, selected by the non-zero elements in row r of a.
+SparseEMatrix	operator * ( const SparseEMatrix & a, const SparseEMatrix & b )
+{
+	assert( a.GetCols() == b.GetRows() );
+
+	if( a.GetOrder() != ESparseOrder::kCSR )
+		return a.ToOrder( ESparseOrder::kCSR ) * b;
+
+	if( b.GetOrder() != ESparseOrder::kCSR )
+		return a * b.ToOrder( ESparseOrder::kCSR );
+
+	const auto rows = a.GetRows();
+	const auto cols = b.GetCols();
+
+	const auto & a_offsets = a.GetOffsets();
+	const auto & a_indices = a.GetIndices();
+	const auto & a_values = a.GetValues();
+
+	const auto & b_offsets = b.GetOffsets();
+	const auto & b_indices = b.GetIndices();
+	const auto & b_values = b.GetValues();
+
+	SparseEMatrix::IdxVec	offsets( rows + 1, 0 );
+
+	// The symbolic pass counts the distinct columns in each row of c.
+	// marker[ col ] == r + 1 means that col has already been seen in row r.
+	#pragma omp parallel
+	{
+		SparseEMatrix::IdxVec	marker( cols, 0 );
+
+		#pragma omp for schedule( dynamic, 64 )
+		for( Dim r = 0; r < rows; ++ r )
+		{
+			Dim	row_nnz {};
+			for( Dim ka = a_offsets[ r ]; ka < a_offsets[ r + 1 ]; ++ ka )
+			{
+				const auto b_row = a_indices[ ka ];
+				for( Dim kb = b_offsets[ b_row ]; kb < b_offsets[ b_row + 1 ]; ++ kb )
+					if( marker[ b_indices[ kb ] ] != r + 1 )
+					{
+						marker[ b_indices[ kb ] ] = r + 1;
+						++ row_nnz;
+					}
+			}
+
+			offsets[ r + 1 ] = row_nnz;
+		}
+	}
+
+	std::partial_sum( offsets.begin(), offsets.end(), offsets.begin() );
+
+	SparseEMatrix::IdxVec	indices( offsets.back() );
+	RealVec					values( offsets.back() );
+
+	// The numeric pass accumulates each row in a dense vector
+	// and then gathers its non-zero elements in the column order
+	#pragma omp parallel
+	{
+		RealVec					acc( cols, 0.0 );
+		SparseEMatrix::IdxVec	marker( cols, 0 );
+
+		#pragma omp for schedule( dynamic, 64 )
+		for( Dim r = 0; r < rows; ++ r )
+		{
+			const auto first = offsets[ r ];
+			auto pos = first;
+
+			for( Dim ka = a_offsets[ r ]; ka < a_offsets[ r + 1 ]; ++ ka )
+			{
+				const auto a_val = a_values[ ka ];
+				const auto b_row = a_indices[ ka ];
+				for( Dim kb = b_offsets[ b_row ]; kb < b_offsets[ b_row + 1 ]; ++ kb )
+				{
+					const auto col = b_indices[ kb ];
+					if( marker[ col ] != r + 1 )
+					{
+						marker[ col ] = r + 1;
+						indices[ pos ++ ] = col;
+					}
+
+					acc[ col ] += a_val * b_values[ kb ];
+				}
+			}
+
+			std::sort( indices.begin() + first, indices.begin() + pos );
+
+			for( Dim k = first; k < pos; ++ k )
+			{
+				values[ k ] = acc[ indices[ k ] ];
+				acc[ indices[ k ] ] = 0.0;		// ready for the next row
+			}
+		}
+	}
+
+	return SparseEMatrix( rows, cols, ESparseOrder::kCSR, std::move( offsets ), std::move( indices ), std::move( values ) );
+}
+
+
+
+#endif
+
+
@@ -0,0 +1,166 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+
+#include "EMBench.h"
+
+
+
+
+// The benchmark suite of ParallelCores. Usage:
+//
+//		ParallelCores_Bench [--sizes 256,512] [--threads 1,2,4] [--warmup 2] [--trials 10] 
+//							[--ops add,mul,...] [--csv out.csv] [--json out.json]
+//
+// Without options all operations are run for the default sizes and numbers of threads.
+
+
+
+namespace
+{
+
+	// "a,b,c" --> { "a", "b", "c" }
+	std::vector< std::string >	SplitList( const std::string & s )
+	{
+		std::vector< std::string >	items;
+		std::istringstream			iss( s );
+		for( std::string item; std::getline( iss, item, ',' ); )
+			if( ! item.empty() )
+				items.push_back( item );
+		return items;
+	}
+
+	// The largest matrices - 32768 x 32768 doubles take 8 GB each,
+	// and the most threads that make sense
+	constexpr long long		kMaxSize { 1 << 15 };
+	constexpr long long		kMaxThreads { 1 << 10 };
+
+	// "1,2,3" --> { 1, 2, 3 }; each number must be in [ 1, max_value ]
+	template < typename T >
+	std::vector< T >	SplitNumbers( const std::string & s, long long max_value, const std::string & what )
+	{
+		std::vector< T >	numbers;
+		for( const auto & item : SplitList( s ) )
+		{
+			std::size_t		pos {};
+			long long		n {};
+			try
+			{
+				n = std::stoll( item, & pos );
+			}
+			catch( const std::exception & )		// not a number or out of the range of long long
+			{
+				pos = 0;
+			}
+
+			if( pos != item.size() || n < 1 || n > max_value )
+				throw std::out_of_range( "the " + what + " must be from 1 to " + std::to_string( max_value ) + ", not " + item );
+			numbers.push_back( static_cast< T >( n ) );
+		}
+		return numbers;
+	}
+
+	void PrintUsage( void )
+	{
+		std::cout << "Usage: ParallelCores_Bench [--sizes n1,n2,...] [--threads t1,t2,...] [--warmup k] [--trials k]\n"
+					 "                           [--ops op1,op2,...] [--csv file] [--json file]\n"
+					 "Operations:";
+		for( const auto & op : GetBenchOps() )
+			std::cout << " " << op;
+		std::cout << std::endl;
+	}
+
+}
+
+
+
+int main( int argc, char ** argv )
+{
+	BenchConfig		config;
+	std::string		csv_file, json_file;
+
+	try
+	{
+		for( int i = 1; i < argc; ++ i )
+		{
+			const std::string	arg( argv[ i ] );
+
+			if( arg == "--help" || arg == "-h" )
+			{
+				PrintUsage();
+				return 0;
+			}
+
+			if( i + 1 >= argc )
+				throw std::invalid_argument( "missing value of " + arg );
+
+			const std::string	value( argv[ ++ i ] );
+
+			if( arg == "--sizes" )			config.fSizes	= SplitNumbers< Dim >( value, kMaxSize, "sizes" );
+			else if( arg == "--threads" )	config.fThreads	= SplitNumbers< int >( value, kMaxThreads, "numbers of threads" );
+			else if( arg == "--warmup" )	config.fWarmUps	= std::stoi( value );
+			else if( arg == "--trials" )	config.fTrials	= std::stoi( value );
+			else if( arg == "--ops" )		config.fOps		= SplitList( value );
+			else if( arg == "--csv" )		csv_file		= value;
+			else if( arg == "--json" )		json_file		= value;
+			else
+				throw std::invalid_argument( "unknown option " + arg );
+		}
+
+		const auto	all_ops = GetBenchOps();
+		for( const auto & op : config.fOps )
+			if( std::find( all_ops.begin(), all_ops.end(), op ) == all_ops.end() )
+				throw std::invalid_argument( "unknown operation " + op );
+
+		if( config.fTrials < 1 || config.fWarmUps < 0 || config.fSizes.empty() )
+			throw std::invalid_argument( "at least one size and one trial are needed" );
+
+	}
+	catch( const std::exception & e )		// std::stoi throws too
+	{
+		std::cerr << "Error: " << e.what() << std::endl;
+		PrintUsage();
+		return 1;
+	}
+
+
+	const auto results = RunBenchSuite( config );
+
+
+	if( ! csv_file.empty() )
+	{
+		std::ofstream	csv( csv_file );
+		WriteBenchCsv( csv, results );
+		if( ! csv )
+			std::cerr << "Error: cannot write " << csv_file << std::endl;
+	}
+
+	if( ! json_file.empty() )
+	{
+		std::ofstream	json( json_file );
+		WriteBenchJson( json, results );
+		if( ! json )
+			std::cerr << "Error: cannot write " << json_file << std::endl;
+	}
+
+	return 0;
+}
+
+
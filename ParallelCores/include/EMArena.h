@@ -0,0 +1,137 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+
+
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+#include <atomic>
+
+
+
+
+// ------------------------------------------------------------------------
+// An arena for the temporary matrices
+//
+// In an iterative loop each temporary EMatrix allocates and frees its buffer.
+// For big matrices this means mmap/munmap and page faults in every iteration.
+// An arena holds a few big blocks of memory and gives out parts of them
+// by just moving a pointer. A Scope remembers that pointer and restores it 
+// when it ends, which releases all buffers allocated in the scope in O(1).
+// The blocks stay, so the next iteration reuses the same (already mapped) memory:
+//
+//		EMArena		arena;
+//		for( ... )
+//		{
+//			EMArena::Scope	scope( arena );		// all EMatrix buffers of this thread now come from the arena
+//			EMatrix	t( a * x );
+//			...
+//			x = t + b;		// x is from the heap, so it gets a copy of the elements
+//		}					// all arena buffers are released here
+//
+// An arena is used by one thread. The buffers allocated by other threads
+// (e.g. inside OpenMP regions) come from the heap, as usual.
+// A matrix with an arena buffer must not outlive its scope - this is asserted.
+class EMArena
+{
+public:
+
+	// Requests up to this size are served from blocks of this size, larger ones get their own block
+	static constexpr std::size_t	kDefaultBlockBytes { std::size_t( 64 ) << 20 };
+
+	// Alignment of all buffers - the same as of the EMatrix rows
+	static constexpr std::size_t	kAlignment { 64 };
+
+private:
+
+	struct BlockDeleter
+	{
+		void operator() ( char * p ) const { ::operator delete [] ( p, std::align_val_t( kAlignment ) ); }
+	};
+
+	struct Block
+	{
+		std::unique_ptr< char [], BlockDeleter >	fData;
+		std::size_t									fBytes {};
+	};
+
+	std::vector< Block >		fBlocks;
+	std::size_t					fBlockBytes {};
+
+	std::size_t					fCurBlock {};		// allocations go to this block
+	std::size_t					fOffset {};			// at this position
+
+	std::atomic< std::size_t >	fLive { 0 };		// buffers allocated and not yet released
+
+public:
+
+	explicit EMArena( std::size_t block_bytes = kDefaultBlockBytes ) : fBlockBytes( block_bytes ) {}
+
+	EMArena( const EMArena & ) = delete;
+	EMArena & operator = ( const EMArena & ) = delete;
+
+	~EMArena();
+
+public:
+
+	// Returns bytes of memory aligned to kAlignment. It is never freed alone,
+	// only when the scope that was active during the allocation ends.
+	void *			Allocate( std::size_t bytes );
+
+	// Called by the owner of a buffer when it does not need it anymore
+	void			Release( void * ) { -- fLive; }
+
+	// All memory reserved in the blocks
+	std::size_t		GetCapacity( void ) const;
+
+	// The number of buffers still in use
+	std::size_t		GetLive( void ) const { return fLive; }
+
+public:
+
+	// While a Scope exists, the EMatrix buffers allocated by this thread come from the arena.
+	// Scopes can be nested, also with different arenas.
+	class Scope
+	{
+		EMArena &		fArena;
+		EMArena *		fPrevArena;		// restored at the end
+
+		std::size_t		fBlock;			// the position of the arena at the beginning
+		std::size_t		fOffset;
+		std::size_t		fLive;
+
+	public:
+
+		explicit Scope( EMArena & arena );
+		~Scope();
+
+		Scope( const Scope & ) = delete;
+		Scope & operator = ( const Scope & ) = delete;
+	};
+
+	// Returns the arena of the innermost scope of this thread, or nullptr
+	static EMArena *	GetCurrent( void );
+
+	// The number of scopes of this thread (with any arena)
+	static std::size_t	GetCurrentLevel( void );
+};
+
+
@@ -0,0 +1,125 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+
+
+
+
+#pragma once
+
+
+#include "EMatrix.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// Batches of small matrices
+//
+// Multiplying millions of 3x3 or 4x4 matrices one EMatrix at a time costs
+// much more in allocations and loop overhead than in arithmetic. EMBatch
+// keeps all matrices of one size in a single buffer, interleaved in groups
+// of kBatch_Lanes: element ( r, c ) of kBatch_Lanes consecutive matrices
+// is stored next to each other. So one SIMD register holds the same
+// element of several matrices, and a whole batch is multiplied with
+// plain vertical FMAs, with no shuffles.
+//
+// Group g, element ( r, c ), lane l:
+//
+//		data[ ( g * rows * cols + r * cols + c ) * kBatch_Lanes + l ]
+
+
+
+// The number of matrices in a group - one AVX-512 register of doubles
+constexpr Dim	kBatch_Lanes { 8 };
+
+// Groups of matrices processed by one call to the kernel
+constexpr Dim	kBatch_ChunkGroups { 64 };
+
+
+
+class EMBatch
+{
+	EMatrix::DataBuf	fDataBuf;
+
+	Dim		fCount {};		// the number of matrices
+	Dim		fRows {};		// and their size
+	Dim		fCols {};
+
+public:
+
+	// A batch of count rows x cols matrices, all set to 0
+	EMBatch( Dim count, Dim rows, Dim cols );
+
+	// Copies all ms, which must have the same size
+	explicit EMBatch( const std::vector< EMatrix > & ms );
+
+	EMBatch( const EMBatch & b );
+	EMBatch( EMBatch && b ) = default;
+
+	EMBatch & operator = ( const EMBatch & b );
+	EMBatch & operator = ( EMBatch && b ) = default;
+
+public:
+
+	auto	GetCount( void ) const { return fCount; }
+	auto	GetRows( void ) const { return fRows; }
+	auto	GetCols( void ) const { return fCols; }
+
+	// The last group is padded with zero matrices
+	auto	GetGroups( void ) const { return ( fCount + kBatch_Lanes - 1 ) / kBatch_Lanes; }
+
+	// Elements in one group of matrices
+	auto	GetGroupElems( void ) const { return fRows * fCols * kBatch_Lanes; }
+
+	DataType *			GetDataBuf( void ) { return fDataBuf.get(); }
+	const DataType *	GetDataBuf( void ) const { return fDataBuf.get(); }
+
+	// Element ( r, c ) of the matrix k
+	DataType &	operator () ( Dim k, Dim r, Dim c ) 
+	{ 
+		assert( k < fCount && r < fRows && c < fCols );
+		return fDataBuf[ ElemIndex( k, r, c ) ]; 
+	}
+
+	const DataType &	operator () ( Dim k, Dim r, Dim c ) const
+	{ 
+		assert( k < fCount && r < fRows && c < fCols );
+		return fDataBuf[ ElemIndex( k, r, c ) ]; 
+	}
+
+	// Copies m into the matrix k (they must have the same size)
+	void		Set( Dim k, const EMatrix & m );
+
+	// Returns a copy of the matrix k
+	EMatrix		Get( Dim k ) const;
+
+private:
+
+	Dim		ElemIndex( Dim k, Dim r, Dim c ) const 
+	{ 
+		return ( k / kBatch_Lanes * fRows * fCols + r * fCols + c ) * kBatch_Lanes + k % kBatch_Lanes; 
+	}
+};
+
+
+
+// c[ k ] = a[ k ] * b[ k ] for all matrices of the batches.
+// The groups are split among the OpenMP threads, and each chunk
+// of them is multiplied by the SIMD kernel (3x3, 4x4 and 8x8 are unrolled).
+void		MultBatch( const EMBatch & a, const EMBatch & b, EMBatch & c );
+
+EMBatch		MultBatch( const EMBatch & a, const EMBatch & b );
+
+
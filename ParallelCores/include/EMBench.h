@@ -0,0 +1,98 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#pragma once
+
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <iostream>
+
+#include "EMatrix.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// Benchmarks of the EMatrix operations
+//
+// Each operation is run a few times to warm up the caches, the page tables
+// and the OpenMP threads, then it is timed in a number of trials.
+// From the trials we take the median (the typical time), the minimum 
+// (the best the machine can do) and the 95th percentile (the slow tail).
+// The speed at the median time is given in GFLOP/s for the compute bound 
+// operations (GEMM) and in GB/s for the memory bound ones (all others).
+//
+// The results can be saved to CSV or JSON files, so the runs from
+// different versions can be compared to find regressions.
+
+
+
+// Settings of one benchmark run
+struct BenchConfig
+{
+	std::vector< Dim >	fSizes { 256, 512, 1024, 2048 };	// matrices are size x size, vectors have size^2 elements
+	std::vector< int >	fThreads;							// empty means 1, 2, 4, ... up to omp_get_max_threads()
+
+	int			fWarmUps { 2 };
+	int			fTrials { 10 };
+
+	std::vector< std::string >	fOps;						// names of the operations to run, empty means all
+};
+
+
+// The timing of one operation for one size and number of threads
+struct BenchResult
+{
+	std::string		fOp;
+	Dim				fSize {};
+	int				fThreads {};
+	int				fTrials {};
+
+	double			fMedian {}, fMin {}, fP95 {};		// in seconds
+
+	double			fRate {};			// at the median time
+	std::string		fUnit;				// "GFLOP/s" or "GB/s"
+};
+
+
+// Times of the trials, sorted
+struct BenchTimes
+{
+	std::vector< double >	fTimes;
+
+	double	GetMin( void ) const { return fTimes.front(); }
+	double	GetMedian( void ) const;
+	double	GetPercentile( double p ) const;		// nearest rank, p in [ 0, 100 ]
+};
+
+
+// Calls op warm_ups times, then measures trials calls of it
+BenchTimes					TimeTrials( const std::function< void( void ) > & op, int warm_ups, int trials );
+
+
+// Names of all operations of the suite
+std::vector< std::string >	GetBenchOps( void );
+
+// Runs the suite - each operation for each size and number of threads.
+// A line for each result is printed to log as soon as it is ready.
+std::vector< BenchResult >	RunBenchSuite( const BenchConfig & config, std::ostream & log = std::cout );
+
+
+// One line per result, with a header
+void		WriteBenchCsv( std::ostream & os, const std::vector< BenchResult > & results );
+
+// An object with the machine info (SIMD level, max threads) and an array of results
+void		WriteBenchJson( std::ostream & os, const std::vector< BenchResult > & results );
+
+
@@ -0,0 +1,73 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#pragma once
+
+
+#include "EMSimd.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// Compensated dot products
+//
+// The error of a plain sum of n products grows with n - it is up to 
+// n * u * sum | x[ i ] * y[ i ] | (u = 2^-53 for double), which is a lot 
+// when the products cancel out. The compensated algorithms also carry 
+// the rounding errors of the additions:
+//
+//	Kahan		- the error of each addition is added to the next summand
+//	Neumaier	- as Kahan, but also right when a summand is larger than the sum
+//	Dot2		- also the rounding errors of the products are kept (TwoProd with FMA)
+//
+// With Kahan and Neumaier the bound no longer grows with n, it is about 
+// 3u * sum | x[ i ] * y[ i ] | - mostly due to the rounded products.
+// Dot2 is as accurate as the plain sum computed in twice the precision and 
+// then rounded: | error | <= u * | x . y | + ( n * u )^2 * sum | x[ i ] * y[ i ] |
+// (T. Ogita, S. M. Rump, S. Oishi, Accurate Sum and Dot Product, 2005).
+//
+// The kernels keep many independent accumulators in the SIMD registers 
+// (see EMSimd.h), so they run at about the speed of the memory, as the plain dot does.
+
+
+
+enum class EDotAlg { kKahan, kNeumaier, kDot2 };
+
+
+// s + e == a + b exactly - the error-free transformation of Knuth,
+// with no branches and no assumption on which of a and b is larger
+inline void		TwoSum( DataType a, DataType b, DataType & s, DataType & e )
+{
+	s = a + b;
+	const DataType z = s - a;
+	e = ( a - ( s - z ) ) + ( b - z );
+}
+
+
+// Each of them returns the sum of x[ i ] * y[ i ], i = 0 .. n-1
+DataType		Dot_Kahan( Dim n, const DataType * x, const DataType * y );
+DataType		Dot_Neumaier( Dim n, const DataType * x, const DataType * y );
+DataType		Dot2( Dim n, const DataType * x, const DataType * y );
+
+// The same with the algorithm chosen at run time
+DataType		Dot_Compensated( Dim n, const DataType * x, const DataType * y, EDotAlg alg );
+
+// The default number of elements in a chunk of Dot_Compensated_Par - fixed,
+// so the chunks are the same for any size of the pool
+constexpr Dim	kDot_Chunk { 1 << 16 };
+
+// The chunks of x and y go to the threads of the pool. The partial sums are added up 
+// with their error terms, so the result is as accurate as the serial one. For a given chunk
+// it does not depend on the number of threads (chunk 0 lets the pool choose, see EMThreadPool.h,
+// and then it does).
+DataType		Dot_Compensated_Par( Dim n, const DataType * x, const DataType * y, EDotAlg alg = EDotAlg::kDot2, Dim chunk = kDot_Chunk );
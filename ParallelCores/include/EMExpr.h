@@ -0,0 +1,447 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+#pragma once
+
+
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "EMatrix.h"
+#include "EMGemm.h"
+#include "EMSimd.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// Expression templates for EMatrix
+//
+// The operators +, - and * do not compute anything. Instead, they return
+// light objects (nodes) that remember the operands. The whole expression
+// is evaluated only when it is assigned to an EMatrix, so
+//
+//		d = a + b + c;		is ONE pass over the data, with no temporaries
+//		e = a * b + c;		copies c into e and calls ONE GEMM that accumulates into e
+//		e += a * b;			calls ONE GEMM that accumulates into e
+//
+// Nodes keep references to the matrices, so do not store them in 'auto':
+//
+//		auto x = a + b;		// x is a node, NOT a matrix - it refers to a and b
+//		EMatrix y = a + b;	// OK
+
+
+
+// The base of all nodes. E is the derived node type (CRTP).
+template < typename E >
+struct EMExpr
+{
+	const E &	Self( void ) const { return static_cast< const E & >( * this ); }
+
+	Dim			GetRows( void ) const { return Self().GetRows(); }
+	Dim			GetCols( void ) const { return Self().GetCols(); }
+};
+
+
+
+// A leaf - refers to an existing matrix
+class EMLeaf : public EMExpr< EMLeaf >
+{
+	const EMatrix &		fMatrix;
+
+public:
+
+	// Only sums of products can be split into GEMM calls
+	static constexpr bool kIsSumOfProducts = false;
+
+	explicit EMLeaf( const EMatrix & m ) : fMatrix( m ) {}
+
+	Dim			GetRows( void ) const { return fMatrix.GetRows(); }
+	Dim			GetCols( void ) const { return fMatrix.GetCols(); }
+
+	DataType	At( Dim r, Dim c ) const { return fMatrix.GetDataBuf()[ r * fMatrix.GetLeadDim() + c ]; }
+
+	const EMatrix &		GetMatrix( void ) const { return fMatrix; }
+
+	void		Prepare( void ) const {}
+	bool		ProductReads( const EMatrix & ) const { return false; }
+	bool		LeafReads( const EMatrix & m ) const { return & fMatrix == & m; }
+};
+
+
+
+// Element-wise operations
+struct EMAddOp { static DataType Apply( DataType x, DataType y ) { return x + y; } };
+struct EMSubOp { static DataType Apply( DataType x, DataType y ) { return x - y; } };
+
+
+// A binary element-wise node
+template < typename L, typename R, typename Op >
+class EMBinExpr : public EMExpr< EMBinExpr< L, R, Op > >
+{
+	L	fLeft;
+	R	fRight;
+
+public:
+
+	static constexpr bool kIsSumOfProducts = std::is_same_v< Op, EMAddOp > && ( L::kIsSumOfProducts || R::kIsSumOfProducts );
+
+	EMBinExpr( const L & l, const R & r ) : fLeft( l ), fRight( r )
+	{
+		assert( l.GetRows() == r.GetRows() );	// dim must be the same
+		assert( l.GetCols() == r.GetCols() );
+	}
+
+	Dim			GetRows( void ) const { return fLeft.GetRows(); }
+	Dim			GetCols( void ) const { return fLeft.GetCols(); }
+
+	DataType	At( Dim r, Dim c ) const { return Op::Apply( fLeft.At( r, c ), fRight.At( r, c ) ); }
+
+	const L &	Left( void ) const { return fLeft; }
+	const R &	Right( void ) const { return fRight; }
+
+	void		Prepare( void ) const { fLeft.Prepare(); fRight.Prepare(); }
+	bool		ProductReads( const EMatrix & m ) const { return fLeft.ProductReads( m ) || fRight.ProductReads( m ); }
+	bool		LeafReads( const EMatrix & m ) const { return fLeft.LeafReads( m ) || fRight.LeafReads( m ); }
+};
+
+template < typename L, typename R >
+using EMAddExpr = EMBinExpr< L, R, EMAddOp >;
+
+
+// Multiplication by a scalar
+template < typename E >
+class EMScaleExpr : public EMExpr< EMScaleExpr< E > >
+{
+	DataType	fScale;
+	E			fExpr;
+
+public:
+
+	static constexpr bool kIsSumOfProducts = false;
+
+	EMScaleExpr( DataType s, const E & e ) : fScale( s ), fExpr( e ) {}
+
+	Dim			GetRows( void ) const { return fExpr.GetRows(); }
+	Dim			GetCols( void ) const { return fExpr.GetCols(); }
+
+	DataType	At( Dim r, Dim c ) const { return fScale * fExpr.At( r, c ); }
+
+	DataType	GetScale( void ) const { return fScale; }
+	const E &	GetExpr( void ) const { return fExpr; }
+
+	void		Prepare( void ) const { fExpr.Prepare(); }
+	bool		ProductReads( const EMatrix & m ) const { return fExpr.ProductReads( m ); }
+	bool		LeafReads( const EMatrix & m ) const { return fExpr.LeafReads( m ); }
+};
+
+
+// The matrix product. It cannot be computed element-by-element in reasonable time,
+// so it is either accumulated straight into the destination with the blocked GEMM
+// or, if it is a part of a more complex expression, computed once in Prepare().
+class EMMulExpr : public EMExpr< EMMulExpr >
+{
+	const EMatrix &		fA;
+	const EMatrix &		fB;
+
+	mutable std::optional< EMatrix >	fProduct;
+
+public:
+
+	static constexpr bool kIsSumOfProducts = true;
+
+	EMMulExpr( const EMatrix & a, const EMatrix & b ) : fA( a ), fB( b )
+	{
+		assert( a.GetCols() == b.GetRows() );	// Dimensions must comply
+	}
+
+	Dim			GetRows( void ) const { return fA.GetRows(); }
+	Dim			GetCols( void ) const { return fB.GetCols(); }
+
+	DataType	At( Dim r, Dim c ) const 
+	{ 
+		assert( fProduct );		// Prepare() must be called first
+		return fProduct->GetDataBuf()[ r * fProduct->GetLeadDim() + c ]; 
+	}
+
+	void		Prepare( void ) const 
+	{ 
+		if( ! fProduct ) 
+			fProduct.emplace( MultMatrix_Blocked( fA, fB ) ); 
+	}
+
+	bool		ProductReads( const EMatrix & m ) const { return & fA == & m || & fB == & m; }
+	bool		LeafReads( const EMatrix & ) const { return false; }	// the operands are checked by ProductReads
+
+	// dest += a * b
+	void		AccumulateInto( EMatrix & dest ) const
+	{
+		assert( dest.GetRows() == GetRows() && dest.GetCols() == GetCols() );
+		Gemm_Blocked(	fA.GetRows(), fB.GetCols(), fA.GetCols(), 
+						fA.GetDataBuf(), fA.GetLeadDim(), 
+						fB.GetDataBuf(), fB.GetLeadDim(), 
+						dest.GetDataBuf(), dest.GetLeadDim() );
+	}
+};
+
+
+
+// ------------------------------------------------------------------------
+// Evaluation
+
+namespace EMEval
+{
+
+	// Runs f( row ) for all rows in parallel
+	template < typename F >
+	void ForEachRow( Dim rows, const F & f )
+	{
+		#pragma omp parallel for schedule( static )
+		for( Dim r = 0; r < rows; ++ r )
+			f( r );
+	}
+
+
+	// dest = e or dest += e, in one element-wise pass
+	template < bool Accumulate, typename E >
+	void ElementWise( EMatrix & dest, const E & e )
+	{
+		e.Prepare();	// compute products, if any are left inside
+
+		const auto cols = dest.GetCols();
+		const auto ld = dest.GetLeadDim();
+		DataType * d = dest.GetDataBuf();
+
+		ForEachRow( dest.GetRows(), [ & ] ( Dim r )
+		{
+			DataType * d_row = d + r * ld;
+			for( Dim c = 0; c < cols; ++ c )
+				if constexpr( Accumulate )
+					d_row[ c ] += e.At( r, c );
+				else
+					d_row[ c ] = e.At( r, c );
+		} );
+	}
+
+
+	// The most common simple cases go directly to the SIMD kernels.
+	// Their dest buffer is taken before the parallel loop, so a shared
+	// copy-on-write dest gets its own buffer in one thread (see EMatrix.h).
+
+	inline void ElementWise_Add( EMatrix & dest, const EMatrix & a, const EMatrix & b )
+	{
+		const auto add_kernel = GetKernels().Add;
+		const auto ld = dest.GetLeadDim();
+		DataType * d = dest.GetDataBuf();
+		ForEachRow( dest.GetRows(), [ & ] ( Dim r )
+			{ add_kernel( dest.GetCols(), a.GetDataBuf() + r * ld, b.GetDataBuf() + r * ld, d + r * ld ); } );
+	}
+
+	inline void ElementWise_Scale( EMatrix & dest, DataType s, const EMatrix & a )
+	{
+		const auto scale_kernel = GetKernels().Scale;
+		const auto ld = dest.GetLeadDim();
+		DataType * d = dest.GetDataBuf();
+		ForEachRow( dest.GetRows(), [ & ] ( Dim r )
+			{ scale_kernel( dest.GetCols(), s, a.GetDataBuf() + r * ld, d + r * ld ); } );
+	}
+
+	inline void ElementWise_Axpy( EMatrix & dest, DataType s, const EMatrix & a )
+	{
+		const auto axpy_kernel = GetKernels().Axpy;
+		const auto ld = dest.GetLeadDim();
+		DataType * d = dest.GetDataBuf();
+		ForEachRow( dest.GetRows(), [ & ] ( Dim r )
+			{ axpy_kernel( dest.GetCols(), s, a.GetDataBuf() + r * ld, d + r * ld ); } );
+	}
+
+
+
+	// dest += e
+	template < typename E >
+	void Accumulate( EMatrix & dest, const E & e )						{ ElementWise< true >( dest, e ); }
+
+	inline void Accumulate( EMatrix & dest, const EMLeaf & e )			{ ElementWise_Axpy( dest, 1.0, e.GetMatrix() ); }
+
+	inline void Accumulate( EMatrix & dest, const EMScaleExpr< EMLeaf > & e )	
+																		{ ElementWise_Axpy( dest, e.GetScale(), e.GetExpr().GetMatrix() ); }
+
+	inline void Accumulate( EMatrix & dest, const EMMulExpr & e )		{ e.AccumulateInto( dest ); }
+
+	// A sum with products is split into a number of accumulations
+	template < typename L, typename R >
+	void Accumulate( EMatrix & dest, const EMAddExpr< L, R > & e )
+	{
+		if constexpr( EMAddExpr< L, R >::kIsSumOfProducts )
+		{
+			Accumulate( dest, e.Left() );
+			Accumulate( dest, e.Right() );
+		}
+		else
+		{
+			ElementWise< true >( dest, e );
+		}
+	}
+
+
+	// dest = e
+	template < typename E >
+	void Assign( EMatrix & dest, const E & e )							{ ElementWise< false >( dest, e ); }
+
+	inline void Assign( EMatrix & dest, const EMLeaf & e )				{ if( & dest != & e.GetMatrix() ) dest = e.GetMatrix(); }
+
+	inline void Assign( EMatrix & dest, const EMAddExpr< EMLeaf, EMLeaf > & e )	
+																		{ ElementWise_Add( dest, e.Left().GetMatrix(), e.Right().GetMatrix() ); }
+
+	inline void Assign( EMatrix & dest, const EMScaleExpr< EMLeaf > & e )	
+																		{ ElementWise_Scale( dest, e.GetScale(), e.GetExpr().GetMatrix() ); }
+
+	inline void Assign( EMatrix & dest, const EMMulExpr & e )
+	{
+		std::fill_n( dest.GetDataBuf(), dest.GetRows() * dest.GetLeadDim(), 0.0 );
+		e.AccumulateInto( dest );
+	}
+
+	// A sum with products - first assign the part without products,
+	// then accumulate the products with GEMM
+	template < typename L, typename R >
+	void Assign( EMatrix & dest, const EMAddExpr< L, R > & e )
+	{
+		if constexpr( EMAddExpr< L, R >::kIsSumOfProducts )
+		{
+			if constexpr( L::kIsSumOfProducts && ! R::kIsSumOfProducts )
+			{
+				Assign( dest, e.Right() );
+				Accumulate( dest, e.Left() );
+			}
+			else
+			{
+				Assign( dest, e.Left() );
+				Accumulate( dest, e.Right() );
+			}
+		}
+		else
+		{
+			ElementWise< false >( dest, e );
+		}
+	}
+
+}
+
+
+
+// ------------------------------------------------------------------------
+// EMatrix members that take expressions
+
+template < typename T >
+template < typename E >
+EMatrixFor< T >::EMatrixFor( const EMExpr< E > & expr )
+	: EMatrixFor( expr.GetRows(), expr.GetCols() )
+{
+	EMEval::Assign( * this, expr.Self() );
+}
+
+template < typename T >
+template < typename E >
+EMatrixFor< T > &	EMatrixFor< T >::operator = ( const EMExpr< E > & expr )
+{
+	const E & e = expr.Self();
+
+	// GEMM cannot write to a matrix that it reads, and a matrix 
+	// of different dimensions cannot be an operand, so go through a new one.
+	// A sum with products is evaluated in parts (see EMEval::Assign), so a part
+	// would read this matrix after the previous one has overwritten it.
+	if( e.ProductReads( * this ) || ( E::kIsSumOfProducts && e.LeafReads( * this ) ) || GetRows() != e.GetRows() || GetCols() != e.GetCols() )
+		return * this = EMatrixFor( expr );
+
+	EMEval::Assign( * this, e );
+	return * this;
+}
+
+template < typename T >
+template < typename E >
+EMatrixFor< T > &	EMatrixFor< T >::operator += ( const EMExpr< E > & expr )
+{
+	const E & e = expr.Self();
+
+	assert( GetRows() == e.GetRows() );	// dim must be the same
+	assert( GetCols() == e.GetCols() );
+
+	if( e.ProductReads( * this ) || ( E::kIsSumOfProducts && e.LeafReads( * this ) ) )
+		return * this += EMatrixFor( expr );
+
+	EMEval::Accumulate( * this, e );
+	return * this;
+}
+
+inline EMatrix &	operator += ( EMatrix & a, const EMatrix & b )
+{
+	return a += EMLeaf( b );
+}
+
+
+
+// ------------------------------------------------------------------------
+// Operators - they only build the nodes
+
+// Matrices become leaves, nodes are passed as they are
+inline EMLeaf	AsExpr( const EMatrix & m ) { return EMLeaf( m ); }
+
+template < typename E >
+const E &		AsExpr( const EMExpr< E > & e ) { return e.Self(); }
+
+template < typename T >
+using EMExprOf = std::decay_t< decltype( AsExpr( std::declval< const T & >() ) ) >;
+
+// True for EMatrix and for the nodes
+template < typename T >
+constexpr bool kIsEMOperand = std::is_same_v< T, EMatrix > || std::is_base_of_v< EMExpr< T >, T >;
+
+
+// It can be used as follows: d = a + b + c;
+template < typename L, typename R, typename = std::enable_if_t< kIsEMOperand< L > && kIsEMOperand< R > > >
+auto		operator + ( const L & l, const R & r )
+{
+	return EMBinExpr< EMExprOf< L >, EMExprOf< R >, EMAddOp >( AsExpr( l ), AsExpr( r ) );
+}
+
+// It can be used as follows: d = a - b;
+template < typename L, typename R, typename = std::enable_if_t< kIsEMOperand< L > && kIsEMOperand< R > > >
+auto		operator - ( const L & l, const R & r )
+{
+	return EMBinExpr< EMExprOf< L >, EMExprOf< R >, EMSubOp >( AsExpr( l ), AsExpr( r ) );
+}
+
+// Multiplication by a scalar: b = s * a;
+template < typename E, typename = std::enable_if_t< kIsEMOperand< E > > >
+auto		operator * ( DataType s, const E & e )
+{
+	return EMScaleExpr< EMExprOf< E > >( s, AsExpr( e ) );
+}
+
+// It can be used as follows: c = a * b;
+// An operand that is an expression binds to const EMatrix & through the implicit
+// converting constructor of EMatrix, so it costs a full temporary matrix.
+inline EMMulExpr	operator * ( const EMatrix & a, const EMatrix & b )
+{
+	return EMMulExpr( a, b );
+}
+
+// Streams out the result of an expression, e.g. std::cout << a * b;
+template < typename E >
+std::ostream &		operator << ( std::ostream & o, const EMExpr< E > & expr )
+{
+	return o << EMatrix( expr );
+}
@@ -0,0 +1,104 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+#pragma once
+
+
+#include "EMatrix.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// Matrix multiplication algorithms
+//
+// operator * calls MultMatrix_Blocked. The textbook version
+// is kept as MultMatrix_Naive, so both can be timed side by side.
+
+
+
+// The parallel ijk triple loop (with ikj order of the two inner loops).
+// c = a * b
+EMatrix		MultMatrix_Naive( const EMatrix & a, const EMatrix & b );
+
+// The cache-blocked multiplication with packed panels of a and b.
+// c = a * b
+EMatrix		MultMatrix_Blocked( const EMatrix & a, const EMatrix & b );
+
+// The same, but b is given transposed, e.g. when it is stored 
+// by columns or multiplied many times (see EMTranspose.h).
+// c = a * bt^T
+EMatrix		MultMatrix_TransB( const EMatrix & a, const EMatrix & bt );
+
+// The mixed precision product: a and b are stored as floats (half the memory),
+// but the sums are computed in double, with the blocked GEMM. Only the final
+// elements are rounded to float. The operator * of EMatrixFor< float > sums in float.
+// c = a * b
+EMatrixFor< float >		MultMatrix_Mixed( const EMatrixFor< float > & a, const EMatrixFor< float > & b );
+
+
+// Below this size Strassen recursion stops and calls the blocked GEMM
+constexpr Dim	kStrassen_Cutoff { 1024 };
+
+// The Strassen-Winograd recursive multiplication of square matrices.
+// It does 7 instead of 8 half-size products at each level, so it wins
+// for very large matrices. The 7 products are computed as parallel OpenMP tasks.
+// Sizes are zero padded to cutoff_size * 2^levels internally. The result differs 
+// from the classic product by somewhat larger rounding errors.
+// c = a * b
+EMatrix		MultMatrix_Strassen( const EMatrix & a, const EMatrix & b, Dim cutoff = kStrassen_Cutoff );
+
+
+
+// Block sizes of the blocked GEMM (in elements).
+// kGemm_MR x kGemm_NR is the register block computed by the micro-kernel
+// (6 x 8 fits the 16 AVX2 registers), a kGemm_MC x kGemm_KC panel of A should fit into L2,
+// a kGemm_KC x kGemm_NR sliver of B into L1, and a kGemm_KC x kGemm_NC panel of B into L3.
+constexpr Dim	kGemm_MR { 6 };
+constexpr Dim	kGemm_NR { 8 };
+constexpr Dim	kGemm_MC { 96 };
+constexpr Dim	kGemm_KC { 256 };
+constexpr Dim	kGemm_NC { 4096 };
+
+
+// The blocked GEMM kernel on raw row-major buffers:
+//
+//		C += A * B
+//
+// A is M x K with leading dimension lda, 
+// B is K x N with leading dimension ldb, 
+// C is M x N with leading dimension ldc.
+// If b_trans is true, B holds B^T, i.e. it is N x K with leading dimension ldb.
+// Macro-tiles of C are computed in parallel with OpenMP,
+// the micro-kernel is the one selected in EMSimd.h.
+void Gemm_Blocked(	Dim M, Dim N, Dim K, 
+					const DataType * A, Dim lda, 
+					const DataType * B, Dim ldb, 
+					DataType * C, Dim ldc, 
+					bool b_trans = false );
+
+// The same on the calling thread only - for the tiles of a task graph (see EMTaskGraph.h),
+// where many tiles are computed at once by the threads of the pool.
+void Gemm_Tile(		Dim M, Dim N, Dim K, 
+					const DataType * A, Dim lda, 
+					const DataType * B, Dim ldb, 
+					DataType * C, Dim ldc );
+
+// The same for A and B of floats. They are converted to double when packed,
+// so the products are summed in double precision.
+void Gemm_Blocked(	Dim M, Dim N, Dim K, 
+					const float * A, Dim lda, 
+					const float * B, Dim ldb, 
+					DataType * C, Dim ldc, 
+					bool b_trans = false );
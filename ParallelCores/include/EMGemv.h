@@ -0,0 +1,58 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+
+
+
+
+#pragma once
+
+
+#include "EMatrix.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// Matrix times vector (GEMV)
+//
+// Each element of A is used only once, so these products are limited 
+// by the memory bandwidth, not by the arithmetic. Their speed is given in GB/s.
+// The rows of A are split among the threads with the static schedule - the same 
+// way the EMatrix constructor first touches them, so on a NUMA machine each
+// thread reads the rows from the memory of its own node.
+//
+// x and y are plain buffers (or RealVec) - no one-column matrices.
+
+
+
+// y = A * x
+// x has a.GetCols() elements, y has a.GetRows() elements.
+// Each y_i is the SIMD dot product of the row i with x.
+void		Gemv( const EMatrix & a, const DataType * x, DataType * y );
+
+// y = A^T * x
+// x has a.GetRows() elements, y has a.GetCols() elements.
+// Each thread adds x_i * (row i) of its rows to its own partial y (SIMD axpy),
+// then the partial vectors are summed in parallel.
+void		Gemv_Trans( const EMatrix & a, const DataType * x, DataType * y );
+
+
+// The same with vectors: y = a * x
+RealVec		MultMatrixVector( const EMatrix & a, const RealVec & x );
+
+// y = a^T * x
+RealVec		MultMatrixVector_Trans( const EMatrix & a, const RealVec & x );
+
+
@@ -0,0 +1,112 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+
+
+#pragma once
+
+
+#include "EMatrix.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// Linear equations - LU and Cholesky decompositions
+//
+// Both are blocked and right-looking: a panel of kLinAlg_Block columns
+// is factorized, then the trailing matrix is updated with the blocked GEMM.
+// Each column block of the trailing update is an OpenMP task, which waits
+// only for the panel it needs. So the next panel can be factorized while
+// the rest of the update is still running (a look-ahead).
+
+
+
+// The width of the panels (in columns)
+constexpr Dim	kLinAlg_Block { 128 };
+
+
+
+// LU decomposition with partial pivoting of a square matrix:
+//
+//		P * A = L * U
+//
+// L (unit diagonal, not stored) and U share one matrix.
+class EMLU
+{
+	EMatrix				fLU;
+	std::vector< Dim >	fPivots;		// row i was swapped with row fPivots[ i ] in step i
+	int					fPermSign { 1 };	// the sign of the permutation
+	bool				fSingular {};
+
+public:
+
+	explicit EMLU( const EMatrix & a );
+
+	// If true, U has a zero on its diagonal and Solve cannot be used
+	bool	IsSingular( void ) const { return fSingular; }
+
+	const EMatrix &				GetLU( void ) const { return fLU; }
+	const std::vector< Dim > &	GetPivots( void ) const { return fPivots; }
+
+	// Solves A * X = B for all columns of b
+	EMatrix		Solve( const EMatrix & b ) const;
+
+	DataType	Determinant( void ) const;
+
+	EMatrix		Inverse( void ) const;
+};
+
+
+
+// Cholesky decomposition of a symmetric positive definite matrix:
+//
+//		A = L * L^T
+//
+// Only the lower triangle of a is read.
+class EMCholesky
+{
+	EMatrix		fL;
+	bool		fPosDef { true };
+
+public:
+
+	explicit EMCholesky( const EMatrix & a );
+
+	// If false, a was not positive definite and Solve cannot be used
+	bool	IsPositiveDefinite( void ) const { return fPosDef; }
+
+	// The lower triangular factor (zeros above the diagonal)
+	const EMatrix &		GetL( void ) const { return fL; }
+
+	// Solves A * X = B for all columns of b
+	EMatrix		Solve( const EMatrix & b ) const;
+
+	DataType	Determinant( void ) const;
+
+	EMatrix		Inverse( void ) const;
+};
+
+
+
+// Shortcuts with the LU decomposition
+
+// Solves a * x = b (a must be square and nonsingular)
+EMatrix		Solve( const EMatrix & a, const EMatrix & b );
+
+DataType	Determinant( const EMatrix & a );
+
+// Returns a^-1 (a must be square and nonsingular)
+EMatrix		Inverse( const EMatrix & a );
+
@@ -0,0 +1,159 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+
+#include "EMatrix.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// Out-of-core matrices
+//
+// A matrix that does not fit into memory is kept in a file in tiles. 
+// Each tile is a square of GetTile() x GetTile() elements, stored row by row, 
+// so it is read or written with a single call. The tiles follow each other 
+// row by row (of tiles). Tiles at the right and bottom edges are padded 
+// with zeros to the full size, so every tile has the same offset arithmetic 
+// and the padding does not change the products.
+//
+//		| header (64 bytes) | tile( 0, 0 ) | tile( 0, 1 ) | ... | tile( 1, 0 ) | ...
+//
+// The tiles are read and written with pread/pwrite (ReadFile/WriteFile on Windows).
+
+
+// The default size of a tile - 8 MB of doubles
+constexpr Dim	kOutOfCore_Tile { 1024 };
+
+
+struct EMTiledHeader
+{
+	static constexpr char			kMagic[ 8 ] { 'E', 'M', 'T', 'I', 'L', 'E', 'D', '\0' };
+	static constexpr std::uint32_t	kVersion { 1 };
+
+	char			fMagic[ 8 ] {};
+	std::uint32_t	fVersion {};
+	std::uint32_t	fHeaderSize {};		// the first tile starts right after the header
+	std::uint64_t	fRows {};
+	std::uint64_t	fCols {};
+	std::uint64_t	fTile {};
+	std::uint64_t	fReserved[ 3 ] {};
+};
+
+static_assert( sizeof( EMTiledHeader ) == 64, "The header must be exactly 64 bytes" );
+
+
+
+// A matrix in a tiled file. Different tiles can be read 
+// or written at the same time from different threads.
+class EMTiledFile
+{
+	EMTiledHeader	fHeader;
+
+#ifdef _WIN32
+	void *			fFileHandle {};
+#else
+	int				fFile { -1 };
+#endif
+
+public:
+
+	EMTiledFile( void ) = default;
+	~EMTiledFile() { Close(); }
+
+	EMTiledFile( const EMTiledFile & ) = delete;
+	EMTiledFile & operator = ( const EMTiledFile & ) = delete;
+
+	// Creates (or overwrites) a file of a rows x cols matrix of zeros
+	bool	Create( const std::string & file_name, Dim rows, Dim cols, Dim tile = kOutOfCore_Tile );
+
+	// Opens an existing file, returns false if its header is wrong
+	bool	Open( const std::string & file_name, bool writable = false );
+
+	void	Close( void );
+
+	bool	IsOpen( void ) const;
+
+	Dim		GetRows( void ) const { return fHeader.fRows; }
+	Dim		GetCols( void ) const { return fHeader.fCols; }
+	Dim		GetTile( void ) const { return fHeader.fTile; }
+
+	// The number of tiles in a column and in a row
+	Dim		GetTileRows( void ) const { return ( GetRows() + GetTile() - 1 ) / GetTile(); }
+	Dim		GetTileCols( void ) const { return ( GetCols() + GetTile() - 1 ) / GetTile(); }
+
+	std::size_t		GetTileBytes( void ) const { return GetTile() * GetTile() * sizeof( DataType ); }
+
+	// Reads the tile ( ti, tj ) to buf of GetTile() x GetTile() elements
+	bool	ReadTile( Dim ti, Dim tj, DataType * buf ) const;
+
+	// Writes buf of GetTile() x GetTile() elements as the tile ( ti, tj )
+	bool	WriteTile( Dim ti, Dim tj, const DataType * buf );
+
+private:
+
+	bool	ReadAt( void * buf, std::size_t bytes, std::uint64_t offset ) const;
+	bool	WriteAt( const void * buf, std::size_t bytes, std::uint64_t offset );
+
+	std::uint64_t	GetTileOffset( Dim ti, Dim tj ) const { return fHeader.fHeaderSize + ( ti * GetTileCols() + tj ) * std::uint64_t( GetTileBytes() ); }
+};
+
+
+// Saves m to a tiled file. Returns true on success.
+bool	WriteTiled( const EMatrix & m, const std::string & file_name, Dim tile = kOutOfCore_Tile );
+
+// Reads the whole matrix from a tiled file (it must fit into memory)
+bool	ReadTiled( EMatrix & m, const std::string & file_name );
+
+
+
+// ------------------------------------------------------------------------
+// The out-of-core product
+//
+//		C = A * B
+//
+// A, B and C are tiled files with the same tile size. C is computed in panels 
+// of p x q tiles that stay in memory. For each panel the columns of tiles of A 
+// and the rows of tiles of B are streamed in, one k at a time, and multiplied 
+// with the parallel blocked GEMM. The tiles of step k + 1 are read by a thread 
+// of the pool while step k is computed (double buffering), so the disk and
+// the cores work at the same time. p and q are as large as memory_budget 
+// (in bytes) allows - larger panels mean fewer passes over A and B.
+// The budget covers the panel, the tile buffers and the packing buffers
+// of the GEMM (one for B and one for A in each OpenMP thread).
+
+
+struct EMOutOfCoreStats
+{
+	double			fSeconds {};			// the whole product
+	double			fLoadWaitSeconds {};	// time the GEMM waited for tiles
+	std::uint64_t	fBytesRead {};
+	std::uint64_t	fBytesWritten {};
+	Dim				fPanelTileRows {};		// p
+	Dim				fPanelTileCols {};		// q
+};
+
+
+// Computes c_file = a_file * b_file within memory_budget bytes. 
+// Returns false if the files cannot be read or written, their sizes or tiles 
+// do not match, or the budget is smaller than 6 tiles and the GEMM buffers.
+bool	MultMatrix_OutOfCore(	const std::string & a_file, const std::string & b_file, const std::string & c_file, 
+								std::size_t memory_budget, EMOutOfCoreStats * stats = nullptr );
+
+
@@ -0,0 +1,97 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <string>
+#include <functional>
+#include <iostream>
+
+
+
+
+// ------------------------------------------------------------------------
+// Hardware performance counters
+//
+// The wall-clock time alone does not tell why a kernel got slower.
+// MeasurePerf runs any function with the CPU counters of each thread 
+// turned on (Linux perf_event_open) and returns what happened in that call: 
+// cycles, instructions, L1 data and last level cache misses, and branch misses.
+// From these IPC (instructions per cycle) and the clock frequency follow.
+//
+//		auto report = MeasurePerf( "a * b", [ & ] { c = a * b; } );
+//		std::cout << report;
+//
+// In containers and virtual machines the counters are often not available 
+// (perf_event_paranoid, seccomp, no PMU). Then only the time is measured
+// and the missing counters are printed as n/a - nothing fails.
+// Only the user space is counted, which is allowed with perf_event_paranoid <= 2.
+//
+// The counters follow all threads of the process that exist when MeasurePerf
+// starts: the OpenMP team and the workers of the default EMThreadPool
+// (both are started first), and any other. The threads that wait for work 
+// (e.g. in a barrier) are counted too - they spin for a while. Threads started 
+// inside f (std::async, a new pool) are not counted, so then the total is partial.
+
+
+
+enum class EPerfEvent { kCycles, kInstructions, kL1DMisses, kLLCMisses, kBranchMisses };
+
+constexpr std::size_t	kPerfEvents { 5 };
+
+// Short names of the events, e.g. for the table headers
+extern const std::array< const char *, kPerfEvents >	kPerfEventNames;
+
+
+// The counts of one thread
+struct EMPerfSample
+{
+	std::array< std::uint64_t, kPerfEvents >	fCounts {};
+	std::array< bool, kPerfEvents >				fValid {};		// false if the counter could not be opened or read
+
+	std::uint64_t	Get( EPerfEvent e ) const { return fCounts[ static_cast< std::size_t >( e ) ]; }
+	bool			IsValid( EPerfEvent e ) const { return fValid[ static_cast< std::size_t >( e ) ]; }
+
+	// Instructions per cycle, 0 if not known
+	double			GetIPC( void ) const;
+
+	// Adds the counts of other threads; a sum is valid if all parts are
+	EMPerfSample &	operator += ( const EMPerfSample & s );
+};
+
+
+// The result of one measured call
+struct EMPerfReport
+{
+	std::string						fName;
+	double							fSeconds {};
+	std::vector< EMPerfSample >		fThreads;		// one for each thread of the process
+
+	EMPerfSample	GetTotal( void ) const;
+};
+
+
+// Returns true if this process can use at least the cycle counter (checked once)
+bool			IsPerfAvailable( void );
+
+// Runs f once with the counters on in all threads of the process
+EMPerfReport	MeasurePerf( const std::string & name, const std::function< void( void ) > & f );
+
+
+// The total, the IPC, the frequency and then each thread in a line
+std::ostream &	operator << ( std::ostream & o, const EMPerfReport & r );
+
+
@@ -0,0 +1,95 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <type_traits>
+#include <limits>
+
+
+#include "EMatrix.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// Quantized matrices
+//
+// For approximate results a matrix can be stored as small integers q with 
+// one scale factor s per row (or per column), so that
+//
+//		m[ r ][ c ] ~ s[ r ] * q[ r ][ c ]		( or s[ c ] * q[ r ][ c ] )
+//
+// The quantization is symmetric: s is max | m | / kQuantMax of the row, so its 
+// largest element goes to +/- kQuantMax and zero stays exactly zero.
+// An int8 matrix takes 8 times less memory (and bandwidth) than the doubles.
+//
+// In the product of a (scaled per row) and b (scaled per column)
+//
+//		c[ i ][ j ] = sa[ i ] * sb[ j ] * sum_k qa[ i ][ k ] * qb[ k ][ j ]
+//
+// the sum is computed exactly with integers, so the only errors are 
+// those of rounding the elements to the integers.
+
+
+enum class EQuantAxis { kPerRow, kPerCol };
+
+
+// The largest magnitude of a quantized value (-128 is not used, so the range is symmetric)
+template < typename Q >
+constexpr Q		kQuantMax = std::numeric_limits< Q >::max();
+
+
+// The int32 sums of the int8 products cannot overflow up to this length of the rows
+constexpr Dim	kQuant_MaxInner8 { std::numeric_limits< std::int32_t >::max() / ( 127 * 127 ) };
+
+
+template < typename Q >
+struct EMQuantMatrix
+{
+	static_assert( std::is_same_v< Q, std::int8_t > || std::is_same_v< Q, std::int16_t >, "Only int8 and int16 are supported" );
+
+	EMatrixFor< Q >		fValues;
+	RealVec				fScales;		// one per row or per column
+	EQuantAxis			fAxis { EQuantAxis::kPerRow };
+
+	Dim		GetRows( void ) const { return fValues.GetRows(); }
+	Dim		GetCols( void ) const { return fValues.GetCols(); }
+
+	// The scale of the element ( r, c )
+	DataType	GetScale( Dim r, Dim c ) const { return fScales[ fAxis == EQuantAxis::kPerRow ? r : c ]; }
+};
+
+using EMQuant8	= EMQuantMatrix< std::int8_t >;
+using EMQuant16	= EMQuantMatrix< std::int16_t >;
+
+
+
+// Returns m quantized to Q with the scales along axis
+template < typename Q >
+EMQuantMatrix< Q >		Quantize( const EMatrix & m, EQuantAxis axis );
+
+// Returns the doubles s * q
+template < typename Q >
+EMatrix					Dequantize( const EMQuantMatrix< Q > & qm );
+
+
+// The integer GEMM: c = a * b
+// a must be scaled per row, b per column. The sums of products are exact
+// (int32 for int8, int64 for int16), computed with the SIMD integer 
+// multiply-add (vpmaddwd) of EMSimd.h. Rows of c are computed in parallel.
+template < typename Q >
+EMatrix					MultMatrix_Quant( const EMQuantMatrix< Q > & a, const EMQuantMatrix< Q > & b );
+
+
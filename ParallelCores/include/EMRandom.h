@@ -0,0 +1,105 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+#pragma once
+
+
+#include "EMatrix.h"
+
+#include <cstdint>
+
+
+
+// ------------------------------------------------------------------------
+// Counter-based random numbers
+//
+// Philox4x32-10 (J. Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC 2011)
+// turns a 128-bit counter and a 64-bit key (the seed) into four random 32-bit words.
+// There is no state which passes from one value to the next, so:
+// - any position in the sequence can be reached at once,
+// - many counters are processed at once in the SIMD registers,
+// - threads fill different parts of a buffer and the result does not
+//   depend on the number of threads, nor on the instruction set.
+//
+// The bits are generated in blocks of kPhilox_Lanes consecutive counters,
+// with the j-th word of the i-th counter at position j * kPhilox_Lanes + i.
+// The block kernels are in EMSimd.cpp.
+
+
+
+// Constants of the Philox4x32 rounds
+constexpr std::uint32_t		kPhilox_M0 { 0xD2511F53 };
+constexpr std::uint32_t		kPhilox_M1 { 0xCD9E8D57 };
+constexpr std::uint32_t		kPhilox_W0 { 0x9E3779B9 };		// key increments
+constexpr std::uint32_t		kPhilox_W1 { 0xBB67AE85 };
+
+constexpr Dim				kPhilox_Rounds { 10 };
+
+constexpr Dim				kPhilox_Lanes { 16 };						// counters in one block
+constexpr Dim				kPhilox_BlockWords { 4 * kPhilox_Lanes };	// 32-bit words in one block
+
+
+
+// A random generator which fills whole buffers.
+// The position in the sequence is counted in 32-bit words:
+// a double takes 2 words, an int takes 1 word.
+//
+// It can be used as follows:
+//
+//		PhiloxRandom	rand_gen( 2020 );
+//		rand_gen.FillUniform( v.data(), v.size(), -1.0, 1.0 );
+//		rand_gen.FillNormal( w.data(), w.size() );		// continues the sequence
+//
+class PhiloxRandom
+{
+	std::uint64_t	fSeed {};
+	std::uint64_t	fPosition {};
+
+public:
+
+	explicit PhiloxRandom( std::uint64_t seed ) : fSeed( seed ) {}
+
+	std::uint64_t	GetSeed( void ) const { return fSeed; }
+
+	std::uint64_t	GetPosition( void ) const { return fPosition; }
+	void			SetPosition( std::uint64_t pos ) { fPosition = pos; }
+
+
+	// Parallel fills. Each of them starts where the previous one stopped.
+
+	// Uniform in [ a, b ) with the full 53-bit resolution
+	void	FillUniform( DataType * out, Dim n, DataType a = 0.0, DataType b = 1.0 );
+
+	// Uniform integers in [ a, b ] (as in std::uniform_int_distribution)
+	void	FillUniformInt( int * out, Dim n, int a, int b );
+
+	// Normal (Gauss) distribution from the Box-Muller transform
+	void	FillNormal( DataType * out, Dim n, DataType mean = 0.0, DataType stddev = 1.0 );
+
+
+	// The same values as above, computed serially from an explicit position.
+	// They have no state, so any thread can call them for any part of a sequence.
+
+	static void		GenerateBits( std::uint64_t seed, std::uint64_t first_word, Dim n, std::uint32_t * out );
+
+	static void		GenerateUniform( std::uint64_t seed, std::uint64_t first_word, Dim n, DataType * out, DataType a, DataType b );
+
+	static void		GenerateUniformInt( std::uint64_t seed, std::uint64_t first_word, Dim n, int * out, int a, int b );
+
+	// Values are generated in pairs, each pair takes 4 words
+	static void		GenerateNormal( std::uint64_t seed, std::uint64_t first_word, Dim n, DataType * out, DataType mean, DataType stddev );
+};
+
+
+
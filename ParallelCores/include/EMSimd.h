@@ -0,0 +1,99 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+#pragma once
+
+
+#include "EMatrix.h"
+
+#include <cstdint>
+
+
+
+
+// ------------------------------------------------------------------------
+// Explicit SIMD kernels for the EMatrix arithmetic
+//
+// Each kernel comes in three versions: scalar, AVX2+FMA and AVX-512.
+// The best one supported by the CPU is chosen once at startup with CPUID,
+// so the same executable runs well on older and newer machines.
+
+
+
+// Instruction sets we have the kernels for (the order matters)
+enum class ESimdLevel { kScalar, kAVX2, kAVX512 };
+
+
+// The result of a compensated dot product (see EMDot.h) - the sum and the error term 
+// which was not added to it yet. fSum + fErr is the dot product.
+struct EMDotSum
+{
+	DataType	fSum {};
+	DataType	fErr {};
+};
+
+
+// A table of kernels for one instruction set.
+// All of them operate on raw buffers of n elements.
+struct EMKernels
+{
+	// z = x + y
+	void	( * Add )	( Dim n, const DataType * x, const DataType * y, DataType * z );
+
+	// y = alpha * x
+	void	( * Scale )	( Dim n, DataType alpha, const DataType * x, DataType * y );
+
+	// y += alpha * x
+	void	( * Axpy )	( Dim n, DataType alpha, const DataType * x, DataType * y );
+
+	// Returns the sum of x[ i ] * y[ i ]
+	DataType	( * Dot )	( Dim n, const DataType * x, const DataType * y );
+
+	// The GEMM micro-kernel: C += a * b for one kGemm_MR x kGemm_NR block.
+	// a and b are packed slivers of length kc, only mr x nr elements of C are updated.
+	void	( * MicroKernel )( Dim kc, const DataType * a, const DataType * b, DataType * C, Dim ldc, Dim mr, Dim nr );
+
+	// Random bits: Philox4x32-10 for the blocks [ first_block, first_block + blocks ),
+	// each of kPhilox_BlockWords words (see EMRandom.h)
+	void	( * PhiloxBlocks )( std::uint64_t key, std::uint64_t first_block, Dim blocks, std::uint32_t * out );
+
+	// c = a * b for groups of kBatch_Lanes interleaved m x k and k x n matrices (see EMBatch.h)
+	void	( * BatchMult )( Dim groups, Dim m, Dim n, Dim k, const DataType * a, const DataType * b, DataType * c );
+
+	// Exact integer dot products for the quantized matrices (see EMQuant.h).
+	// The products are summed with vpmaddwd; AVX-512 uses the AVX2 versions,
+	// since the 16-bit multiplies need AVX-512BW.
+	std::int64_t	( * DotI8 )	( Dim n, const std::int8_t * x, const std::int8_t * y );
+	std::int64_t	( * DotI16 )( Dim n, const std::int16_t * x, const std::int16_t * y );
+
+	// The compensated dot products, with several independent accumulators (see EMDot.h)
+	EMDotSum	( * DotKahan )		( Dim n, const DataType * x, const DataType * y );
+	EMDotSum	( * DotNeumaier )	( Dim n, const DataType * x, const DataType * y );
+	EMDotSum	( * Dot2 )			( Dim n, const DataType * x, const DataType * y );
+
+	ESimdLevel		fLevel;
+	const char *	fName;
+};
+
+
+
+// Returns the highest level supported by this CPU (checked with CPUID)
+ESimdLevel			GetCpuSimdLevel( void );
+
+// Returns the kernels currently in use
+const EMKernels &	GetKernels( void );
+
+// Forces a level, e.g. to compare the kernels. It is clamped
+// to what the CPU supports. Do not call it while kernels are running.
+void				SetSimdLevel( ESimdLevel level );
@@ -0,0 +1,158 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <map>
+#include <utility>
+#include <functional>
+#include <atomic>
+#include <memory>
+
+
+#include "EMatrix.h"
+#include "EMThreadPool.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// A task graph
+//
+// Each task has a list of tasks it depends on. Run starts the tasks without 
+// dependencies and then each task as soon as all its predecessors are done,
+// on the threads of EMThreadPool. There are no barriers - independent tasks run
+// together, and a task does not wait for anything but its own inputs.
+//
+//		EMTaskGraph	graph;
+//		auto t_a = graph.AddTask( [ & ] { ... } );
+//		auto t_b = graph.AddTask( [ & ] { ... } );
+//		graph.AddTask( [ & ] { ... }, { t_a, t_b } );		// after t_a and t_b
+//		graph.Run();
+//
+// A graph can be run many times. Tasks can be added only before Run.
+class EMTaskGraph
+{
+public:
+
+	using TaskId = std::size_t;
+
+private:
+
+	struct Node
+	{
+		std::function< void( void ) >	fWork;
+		std::vector< TaskId >			fSuccessors;
+		std::size_t						fNumOfDeps {};
+		std::atomic< std::size_t >		fDepsLeft { 0 };		// counts down in Run
+	};
+
+	std::deque< Node >		fNodes;		// a deque, since a Node cannot be moved
+
+	// The state of one Run, shared by its tasks in the pool
+	struct RunState;
+
+	static void		RunTask( const std::shared_ptr< RunState > & state, TaskId id );
+
+public:
+
+	// Adds work that runs after all tasks in deps. Returns its id.
+	TaskId		AddTask( std::function< void( void ) > work, std::vector< TaskId > deps = {} );
+
+	// Runs all tasks and returns when they are done. 
+	// If a task throws, the tasks not yet started are skipped 
+	// and the first exception is passed to the caller.
+	void		Run( EMThreadPool & pool = EMThreadPool::GetDefault() );
+
+	std::size_t		GetTasks( void ) const { return fNodes.size(); }
+};
+
+
+
+// ------------------------------------------------------------------------
+// Matrix operations on tiles, with automatic dependencies
+//
+// Each operation is split into tasks, one for each tile of its output.
+// A task depends only on the tasks that write the tiles it reads (and, if it 
+// overwrites a tile, on the earlier tasks that read or write it). So in
+//
+//		EMTilePipeline	p;
+//		p.Mult( A, B, C );		// C = A * B
+//		p.Add( C, E, D );		// D = C + E
+//		p.Mult( D, G, F );		// F = D * G
+//		p.Run();
+//
+// a tile of D is computed as soon as its tile of C is ready, and a row of tiles 
+// of F as soon as that row of D is ready - without waiting for whole matrices.
+// Independent operations run at the same time.
+//
+// All matrices must already have their sizes, and must not be resized
+// nor destroyed until Run finishes. They are recognized by their addresses,
+// not by their buffers, since a copy-on-write matrix gets a new buffer when
+// it is made unique (see EMatrix.h).
+
+// The default size of a tile (in rows and columns)
+constexpr Dim	kTaskGraph_Tile { 256 };
+
+class EMTilePipeline
+{
+	using TaskId = EMTaskGraph::TaskId;
+
+	// Who accessed a tile so far
+	struct TileAccess
+	{
+		bool					fHasWriter {};
+		TaskId					fWriter {};
+		std::vector< TaskId >	fReaders;		// since the last write
+	};
+
+	// A tile is identified by its matrix and its index there
+	using TileKey = std::pair< const EMatrix *, Dim >;
+
+	EMTaskGraph							fGraph;
+	Dim									fTile {};
+	std::map< TileKey, TileAccess >		fAccess;
+	std::vector< EMatrix * >			fOutputs;	// the matrices written by the tasks
+
+public:
+
+	explicit EMTilePipeline( Dim tile = kTaskGraph_Tile ) : fTile( tile ) {}
+
+	// c = a * b
+	// c must be a.GetRows() x b.GetCols() and different from a and b.
+	void	Mult( const EMatrix & a, const EMatrix & b, EMatrix & c );
+
+	// c = a + b
+	// All have the same size. c can be a or b.
+	void	Add( const EMatrix & a, const EMatrix & b, EMatrix & c );
+
+	// Executes all operations added so far (can be called again)
+	void	Run( EMThreadPool & pool = EMThreadPool::GetDefault() );
+
+	const EMTaskGraph &		GetGraph( void ) const { return fGraph; }
+
+private:
+
+	Dim		GetTileRows( const EMatrix & m ) const { return ( m.GetRows() + fTile - 1 ) / fTile; }
+	Dim		GetTileCols( const EMatrix & m ) const { return ( m.GetCols() + fTile - 1 ) / fTile; }
+
+	TileKey		GetKey( const EMatrix & m, Dim ti, Dim tj ) const { return { & m, ti * GetTileCols( m ) + tj }; }
+
+	// Adds a task that reads the tiles in reads and writes the tiles in writes
+	void	AddTileTask( std::function< void( void ) > work, const std::vector< TileKey > & reads, const std::vector< TileKey > & writes );
+};
+
+
@@ -0,0 +1,235 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+
+
+
+
+// ------------------------------------------------------------------------
+// A work-stealing thread pool
+//
+// std::async( std::launch::async, ... ) starts a new OS thread for each call.
+// Called for each chunk of a big vector this creates thousands of threads,
+// and creating a thread costs much more than summing a chunk.
+// The pool starts its threads once and then gives them tasks.
+//
+// Each worker has its own deque of tasks. It takes tasks from the back
+// of its deque (the most recent ones, whose data are still in the cache).
+// When its deque is empty, it steals from the front of the deque of another 
+// worker, so the work spreads to all threads without a central queue.
+//
+// A thread that waits for its chunks to finish (also a worker itself) runs 
+// the pending tasks in the meantime, so ParallelFor can be nested.
+//
+//		EMThreadPool & pool = EMThreadPool::GetDefault();
+//		pool.ParallelFor( 0, n, 0, [ & ] ( std::size_t b, std::size_t e ) { for( auto i = b; i < e; ++ i ) y[ i ] = 2.0 * x[ i ]; } );
+//		auto sum = pool.ParallelReduce( 0, n, 0, 0.0, 
+//						[ & ] ( std::size_t b, std::size_t e ) { return std::accumulate( x + b, x + e, 0.0 ); }, std::plus<>() );
+//
+class EMThreadPool
+{
+public:
+
+	using Task = std::function< void( void ) >;
+
+	// With the automatic chunk size each thread gets about that many chunks to balance the load
+	static constexpr std::size_t	kChunksPerThread { 4 };
+
+private:
+
+	// The deque of one worker - the owner uses its back, the thieves its front
+	struct WorkQueue
+	{
+		std::mutex			fMutex;
+		std::deque< Task >	fTasks;
+	};
+
+	std::vector< std::unique_ptr< WorkQueue > >		fQueues;
+	std::vector< std::thread >						fThreads;
+
+	std::mutex						fSleepMutex;		// idle workers wait for new tasks on fWakeUp
+	std::condition_variable			fWakeUp;
+	std::atomic< std::size_t >		fPending { 0 };		// tasks in all deques
+	bool							fStop { false };
+
+	std::atomic< std::size_t >		fNextQueue { 0 };	// round robin for the tasks from outside the pool
+
+public:
+
+	// Starts num_of_threads workers (at least one)
+	explicit EMThreadPool( std::size_t num_of_threads = std::thread::hardware_concurrency() );
+
+	// Runs the remaining tasks and joins the workers
+	~EMThreadPool();
+
+	EMThreadPool( const EMThreadPool & ) = delete;
+	EMThreadPool & operator = ( const EMThreadPool & ) = delete;
+
+	// The pool of the process, sized to the hardware and created on the first call
+	static EMThreadPool &	GetDefault( void );
+
+	std::size_t		GetThreads( void ) const { return fThreads.size(); }
+
+public:
+
+	// Puts a task to the pool and returns its future.
+	// Do not block on the future inside a task - use ParallelFor there.
+	template < typename F >
+	auto	Submit( F f ) -> std::future< std::invoke_result_t< F > >;
+
+	// Calls body( b, e ) for the consecutive chunks [ b, e ) of [ first, last ) in parallel
+	// and returns when all are done. chunk == 0 chooses the size automatically.
+	// An exception thrown by body is passed to the caller.
+	template < typename F >
+	void	ParallelFor( std::size_t first, std::size_t last, std::size_t chunk, F body );
+
+	// Returns the values of map( b, e ) for all chunks, in the order of the chunks
+	template < typename M >
+	auto	ParallelMap( std::size_t first, std::size_t last, std::size_t chunk, M map ) -> std::vector< std::invoke_result_t< M, std::size_t, std::size_t > >;
+
+	// Reduces the values of map( b, e ) of the chunks with reduce, in the order of the chunks.
+	// For a given chunk size the result does not depend on the number of threads.
+	template < typename T, typename M, typename R >
+	T		ParallelReduce( std::size_t first, std::size_t last, std::size_t chunk, T init, M map, R reduce );
+
+	// Puts a task to the pool, without a future. Used by schedulers built 
+	// on the pool (e.g. EMTaskGraph) that count the finished tasks themselves.
+	void	Push( Task task );
+
+	// Runs the pending tasks in the calling thread until left drops to 0
+	void	HelpUntil( const std::atomic< std::size_t > & left );
+
+private:
+
+	// Takes a task - from the back of the own deque or from the front of any other
+	bool	TryGetTask( Task & task );
+
+	void	WorkerLoop( std::size_t index );
+
+	std::size_t		GetChunk( std::size_t elems, std::size_t chunk ) const;
+};
+
+
+
+// ------------------------------------------------------------------------
+// Implementation of the templates
+
+
+template < typename F >
+auto	EMThreadPool::Submit( F f ) -> std::future< std::invoke_result_t< F > >
+{
+	// std::function needs a copyable object, so the packaged_task is shared
+	auto task = std::make_shared< std::packaged_task< std::invoke_result_t< F >( void ) > >( std::move( f ) );
+	auto res = task->get_future();
+	Push( [ task ] () { ( * task )(); } );
+	return res;
+}
+
+
+template < typename F >
+void	EMThreadPool::ParallelFor( std::size_t first, std::size_t last, std::size_t chunk, F body )
+{
+	if( first >= last )
+		return;
+
+	chunk = GetChunk( last - first, chunk );
+	const std::size_t	num_of_chunks = ( last - first + chunk - 1 ) / chunk;
+
+	std::atomic< std::size_t >	left { num_of_chunks };
+	std::exception_ptr			error;
+	std::mutex					error_mutex;
+
+	for( std::size_t i = 0; i < num_of_chunks; ++ i )
+	{
+		const std::size_t b = first + i * chunk, e = std::min( b + chunk, last );
+		Push( [ &, b, e ] ()
+		{
+			try
+			{
+				body( b, e );
+			}
+			catch( ... )
+			{
+				std::lock_guard< std::mutex >	lock( error_mutex );
+				if( ! error )
+					error = std::current_exception();
+			}
+			left.fetch_sub( 1, std::memory_order_release );		// the last access to the locals of ParallelFor
+		} );
+	}
+
+	HelpUntil( left );
+
+	if( error )
+		std::rethrow_exception( error );
+}
+
+
+template < typename M >
+auto	EMThreadPool::ParallelMap( std::size_t first, std::size_t last, std::size_t chunk, M map ) -> std::vector< std::invoke_result_t< M, std::size_t, std::size_t > >
+{
+	std::vector< std::invoke_result_t< M, std::size_t, std::size_t > >	values;
+	if( first >= last )
+		return values;
+
+	chunk = GetChunk( last - first, chunk );
+	values.resize( ( last - first + chunk - 1 ) / chunk );
+
+	// Each chunk writes its own element, so nothing is shared
+	ParallelFor( first, last, chunk, [ & ] ( std::size_t b, std::size_t e ) { values[ ( b - first ) / chunk ] = map( b, e ); } );
+	return values;
+}
+
+
+template < typename T, typename M, typename R >
+T		EMThreadPool::ParallelReduce( std::size_t first, std::size_t last, std::size_t chunk, T init, M map, R reduce )
+{
+	const auto values = ParallelMap( first, last, chunk, map );
+	return std::accumulate( values.begin(), values.end(), init, reduce );
+}
+
+
+
+// ------------------------------------------------------------------------
+// The same with the default pool
+
+
+template < typename F >
+void	ParallelFor( std::size_t first, std::size_t last, std::size_t chunk, F body )
+{
+	EMThreadPool::GetDefault().ParallelFor( first, last, chunk, body );
+}
+
+template < typename T, typename M, typename R >
+T		ParallelReduce( std::size_t first, std::size_t last, std::size_t chunk, T init, M map, R reduce )
+{
+	return EMThreadPool::GetDefault().ParallelReduce( first, last, chunk, init, map, reduce );
+}
+
+
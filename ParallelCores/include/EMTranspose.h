@@ -0,0 +1,62 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+
+
+#pragma once
+
+
+#include "EMatrix.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// Matrix transposition
+//
+// The naive double loop reads one matrix along rows and writes the other
+// along columns, so for large matrices almost each write misses the cache.
+// Here both matrices are traversed in small blocks, which fit the cache.
+
+
+
+// The recursion stops at blocks of at most kTranspose_Leaf x kTranspose_Leaf
+constexpr Dim	kTranspose_Leaf { 32 };
+
+// Blocks larger than this (in elements) are transposed as separate OpenMP tasks
+constexpr Dim	kTranspose_TaskElems { 1 << 16 };
+
+// The side of the tiles swapped by the in-place transposition
+constexpr Dim	kTranspose_Tile { 32 };
+
+
+
+// The cache-oblivious transposition on raw row-major buffers:
+//
+//		B = A^T
+//
+// A is rows x cols with leading dimension lda, B is cols x rows with leading dimension ldb.
+// The larger dimension is split in halves until the blocks fit into the cache,
+// whatever its size is. Large halves are processed in parallel.
+void		Transpose_Raw( Dim rows, Dim cols, const DataType * A, Dim lda, DataType * B, Dim ldb );
+
+// Returns a transposed matrix
+// b = a^T
+EMatrix		Transpose( const EMatrix & a );
+
+// Transposes a square matrix in place
+// a = a^T
+// Tiles symmetric to the diagonal are swapped in parallel.
+void		TransposeInPlace( EMatrix & a );
+
@@ -1,31 +1,43 @@
-// ==========================================================================
-//
-// Software written by Boguslaw Cyganek (C) to be used with the book:
-// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
-// Published by Wiley, 2020
-//
-// The software is supplied as is and for educational purposes
-// without any guarantees nor responsibility of its use in any application. 
-//
-// ==========================================================================
-
-
-// Own header in " "
-#include "EMatrix.h"
-
-
-
-// Overloaded operators 
-
-EMatrix		operator + ( const EMatrix & a, const EMatrix & b );
-
-EMatrix		operator * ( const EMatrix & a, const EMatrix & b );
-
-
-
-
-
-
-
-
-
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+// Own header in " "
+#include "EMatrix.h"
+#include "EMGemm.h"
+#include "EMExpr.h"
+#include "EMTranspose.h"
+
+#include <cstdint>
+
+
+
+// Overloaded operators are in EMExpr.h
+
+// y += alpha * x
+void		Axpy( DataType alpha, const EMatrix & x, EMatrix & y );
+
+
+// Does random initialization of a matrix m - each call gives different values
+void RandInit( EMatrix & m );
+
+// Does reproducible random initialization of a matrix m.
+// The same seed gives the same matrix for any number of threads.
+void RandInit( EMatrix & m, std::uint64_t seed );
+
+
+
+
+
+
+
+
+
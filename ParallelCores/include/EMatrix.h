@@ -1,110 +1,593 @@
-// ==========================================================================
-//
-// Software written by Boguslaw Cyganek (C) to be used with the book:
-// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
-// Published by Wiley, 2020
-//
-// The software is supplied as is and for educational purposes
-// without any guarantees nor responsibility of its use in any application. 
-//
-// ==========================================================================
-
-
-
-
-
-
-// ----------------------------------------
-// Part I
-
-#include <iostream> 
-#include <vector>
-
-
-#define USE_OPEN_MP		1
-
-
-
-
-// A type alias declaration for a vector of double values (real approx.)
-using RealVec = std::vector< double >;
-
-// A type alias for vector dimensions (size)
-using Dim		= RealVec::size_type;
-
-// A type alias for vector type (e.g. double)
-using DataType	= RealVec::value_type;
-
-
-// A type alias for a vector of vectors with doubles = a real matrix
-using RealMatrix = std::vector< RealVec >;
-
-
-
-// ----------------------------------------
-// Part II
-
-#include <cassert>
-
-
-
-
-class EMatrix
-{
-
-private:
-
-	RealMatrix	fData;	// data structure (encapsulation)
-
-public:
-
-	// A parametric constructor
-	EMatrix( Dim rows, Dim cols, DataType initVal = 0.0 )
-		: fData( rows, RealVec( cols, initVal ) )
-	{	// matrix == a vector of vectors of double
-		assert( cols > 0 );
-		assert( rows > 0 );
-	}
-
-
-	// Helpers
-	auto	GetCols( void ) const { return fData[ 0 ].size(); }
-	auto	GetRows( void ) const { return fData.size(); }
-
-
-	// Thanks to this overloaded subscript operators 
-	// instead of m.fData[2][3] we can write directly m[2][3] 
-	auto &			operator[] ( Dim idx ) { return fData[ idx ]; }			
-	const auto &	operator[] ( Dim idx ) const { return fData[ idx ]; }
-
-	// We need only these two pairs of functions to have a range-based for loop
-	auto			begin() { return fData.begin(); }
-	auto			end()	{ return fData.end(); }
-
-	auto			begin() const { return fData.begin(); }
-	auto			end()	const { return fData.end(); }
-
-
-
-	// friends are functions which can freely access fData
-	friend std::ostream & operator << ( std::ostream & o, const EMatrix & matrix );
-	friend std::istream & operator >> ( std::istream & i, EMatrix & matrix );
-
-
-};
-
-
-
-
-
-
-// ----------------------------------------
-
-EMatrix		operator + ( const EMatrix & a, const EMatrix & b );
-
-EMatrix		operator * ( const EMatrix & a, const EMatrix & b );
-
-
-
-
-
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#pragma once
+
+
+
+
+
+// ----------------------------------------
+// Part I
+
+#include <iostream> 
+#include <vector>
+
+
+#define USE_OPEN_MP		1
+
+
+
+
+// A type alias declaration for a vector of double values (real approx.)
+using RealVec = std::vector< double >;
+
+// A type alias for vector dimensions (size)
+using Dim		= RealVec::size_type;
+
+// A type alias for vector type (e.g. double)
+using DataType	= RealVec::value_type;
+
+
+// A type alias for a vector of vectors with doubles = a real matrix
+using RealMatrix = std::vector< RealVec >;
+
+
+
+// ----------------------------------------
+// Part II
+
+#include <cassert>
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <type_traits>
+#include <atomic>
+
+
+
+
+#include "EMArena.h"
+
+
+
+// The base of the lazy expressions (see EMExpr.h)
+template < typename E >
+struct EMExpr;
+
+
+template < typename T >
+class EMatrixFor
+{
+	// The buffer is raw memory, filled and copied with std::fill_n and std::copy_n
+	static_assert( std::is_trivially_copyable_v< T > && std::is_trivially_destructible_v< T >, "EMatrixFor needs simple elements" );
+
+public:
+
+	using value_type = T;
+
+	// Each row starts at an address aligned to kAlignment bytes 
+	// (a cache line, also the width of the AVX-512 register).
+	static constexpr std::size_t	kAlignment { 64 };
+
+	// The number of T elements in kAlignment bytes
+	static constexpr Dim			kAlignElems { kAlignment / sizeof( T ) };
+
+	// Frees a buffer that was allocated with the aligned operator new,
+	// or gives it back to the arena it came from (see EMArena.h)
+	struct AlignedDeleter
+	{
+		EMArena *		fArena;
+		std::size_t		fLevel;		// the scope level of an arena buffer, 0 for the heap
+
+		AlignedDeleter( void ) : fArena( nullptr ), fLevel( 0 ) {}
+		AlignedDeleter( EMArena * arena, std::size_t level ) : fArena( arena ), fLevel( level ) {}
+
+		void operator() ( T * p ) const 
+		{ 
+			if( fArena != nullptr )
+				fArena->Release( p );
+			else
+				::operator delete [] ( p, std::align_val_t( kAlignment ) ); 
+		}
+	};
+
+	// An aligned buffer - also used by the kernels for their scratch memory
+	using DataBuf = std::unique_ptr< T [], AlignedDeleter >;
+
+	// If this thread is in an EMArena::Scope, the buffer comes from its arena
+	static DataBuf	AllocDataBuf( Dim elems )
+	{
+		if( EMArena * arena = EMArena::GetCurrent() )
+			return DataBuf( static_cast< T * >( arena->Allocate( elems * sizeof( T ) ) ), AlignedDeleter( arena, EMArena::GetCurrentLevel() ) );
+
+		return AllocHeapBuf( elems );
+	}
+
+	static DataBuf	AllocHeapBuf( Dim elems )
+	{
+		return DataBuf( static_cast< T * >( ::operator new [] ( elems * sizeof( T ), std::align_val_t( kAlignment ) ) ) );
+	}
+
+private:
+
+	// All elements are stored row-by-row in ONE contiguous buffer.
+	// It is held by shared_ptr, so copy-on-write matrices can share it.
+	using SharedBuf = std::shared_ptr< T [] >;
+
+	SharedBuf	fDataBuf;	// data structure (encapsulation)
+
+	Dim			fRows {};
+	Dim			fCols {};
+	Dim			fLeadDim {};	// distance (in elements) between beginnings of the two consecutive rows
+
+	bool		fCopyOnWrite {};	// copies share the buffer until one of them is changed
+
+
+	// Rows are padded to a multiple of kAlignElems, so each of them is aligned
+	static Dim		ComputeLeadDim( Dim cols ) { return ( cols + kAlignElems - 1 ) / kAlignElems * kAlignElems; }
+
+	// Matrices of at least that many elements are filled and copied in parallel, 
+	// by rows with the static schedule. The OS maps a page on the NUMA node of the thread 
+	// which touches it first, so each thread later finds its rows in its local memory
+	// (if it processes them with the same static schedule, as the GEMV does).
+	static constexpr Dim	kFirstTouchElems { 1 << 15 };
+
+	// The scope level of the buffer, 0 for the heap (see AlignedDeleter)
+	std::size_t		GetBufLevel( void ) const 
+	{ 
+		const auto * deleter = std::get_deleter< AlignedDeleter >( fDataBuf );
+		return deleter != nullptr ? deleter->fLevel : 0;
+	}
+
+	// True if both buffers are from the heap, or both from the same arena scope
+	bool			HasSameBufOwner( const EMatrixFor & m ) const
+	{
+		const auto * d = std::get_deleter< AlignedDeleter >( fDataBuf );
+		const auto * m_d = std::get_deleter< AlignedDeleter >( m.fDataBuf );
+		const EMArena * arena = d != nullptr ? d->fArena : nullptr;
+		const EMArena * m_arena = m_d != nullptr ? m_d->fArena : nullptr;
+		return arena == m_arena && GetBufLevel() == m.GetBufLevel();
+	}
+
+	void			SwapBuffers( EMatrixFor & m ) noexcept
+	{
+		fDataBuf.swap( m.fDataBuf );
+		std::swap( fRows, m.fRows );
+		std::swap( fCols, m.fCols );
+		std::swap( fLeadDim, m.fLeadDim );
+		std::swap( fCopyOnWrite, m.fCopyOnWrite );
+	}
+
+	// Only heap buffers are shared - an arena buffer would be gone with its scope
+	bool			CanShareWith( const EMatrixFor & m ) const { return m.fCopyOnWrite && m.GetBufLevel() == 0; }
+
+public:
+
+	// A parametric constructor
+	EMatrixFor( Dim rows, Dim cols, T initVal = T {} )
+		: fDataBuf( AllocDataBuf( rows * ComputeLeadDim( cols ) ) ), fRows( rows ), fCols( cols ), fLeadDim( ComputeLeadDim( cols ) )
+	{	// matrix == one buffer of rows * fLeadDim elements
+		assert( cols > 0 );
+		assert( rows > 0 );
+
+		#if USE_OPEN_MP
+		#pragma omp parallel for schedule( static ) if( fRows * fLeadDim >= kFirstTouchElems )
+		#endif
+		for( Dim r = 0; r < fRows; ++ r )
+			std::fill_n( fDataBuf.get() + r * fLeadDim, fLeadDim, initVal );
+	}
+
+	// Copy constructor - a deep copy of the buffer, 
+	// or only one more owner of it if m is copy-on-write
+	EMatrixFor( const EMatrixFor & m )
+		: fRows( m.fRows ), fCols( m.fCols ), fLeadDim( m.fLeadDim ), fCopyOnWrite( m.fCopyOnWrite )
+	{
+		if( CanShareWith( m ) )
+		{
+			fDataBuf = m.fDataBuf;
+			return;
+		}
+
+		fDataBuf = AllocDataBuf( fRows * fLeadDim );
+
+		#if USE_OPEN_MP
+		#pragma omp parallel for schedule( static ) if( fRows * fLeadDim >= kFirstTouchElems )
+		#endif
+		for( Dim r = 0; r < fRows; ++ r )
+			std::copy_n( m.fDataBuf.get() + r * fLeadDim, fLeadDim, fDataBuf.get() + r * fLeadDim );
+	}
+
+	// A matrix of other elements, e.g. of floats from a matrix of doubles.
+	// Each element goes through double, to which all of them convert.
+	template < typename U >
+	explicit EMatrixFor( const EMatrixFor< U > & m )
+		: EMatrixFor( m.GetRows(), m.GetCols() )
+	{
+		for( Dim r = 0; r < fRows; ++ r )
+			std::transform( m[ r ].begin(), m[ r ].end(), ( * this )[ r ].begin(), 
+							[] ( const U & u ) { return static_cast< T >( static_cast< double >( u ) ); } );
+	}
+
+	// Assignment operator
+	EMatrixFor & operator = ( const EMatrixFor & m )
+	{
+		if( this != & m )
+		{
+			const Dim elems = fRows * fLeadDim;
+
+			fRows = m.fRows;
+			fCols = m.fCols;
+			fLeadDim = m.fLeadDim;
+			fCopyOnWrite = m.fCopyOnWrite;
+
+			if( CanShareWith( m ) )
+			{
+				fDataBuf = m.fDataBuf;
+				return * this;
+			}
+
+			// Reallocate only if the number of elements differs (or the buffer is shared). 
+			// The new buffer is from the heap, since this matrix may be older than the current arena scope.
+			if( IsShared() || elems != fRows * fLeadDim )
+				fDataBuf = AllocHeapBuf( fRows * fLeadDim );
+
+			// In parallel by rows, as in the copy constructor (first touch of a new buffer)
+			#if USE_OPEN_MP
+			#pragma omp parallel for schedule( static ) if( fRows * fLeadDim >= kFirstTouchElems )
+			#endif
+			for( Dim r = 0; r < fRows; ++ r )
+				std::copy_n( m.fDataBuf.get() + r * fLeadDim, fLeadDim, fDataBuf.get() + r * fLeadDim );
+		}
+		return * this;
+	}
+
+	// The move constructor takes the buffer of m, which is left empty
+	EMatrixFor( EMatrixFor && m ) noexcept
+	{
+		SwapBuffers( m );
+	}
+
+	// The buffers are exchanged only if they come from the same place (the heap 
+	// or the same arena scope). Otherwise the one from a deeper scope could outlive 
+	// its scope in the other matrix - e.g. in x = x + t; in a loop with a scope, 
+	// or when a heap matrix is moved into one from an arena. Then only the elements are copied.
+	EMatrixFor & operator = ( EMatrixFor && m )
+	{
+		if( ! HasSameBufOwner( m ) )
+			return * this = static_cast< const EMatrixFor & >( m );
+
+		SwapBuffers( m );
+		return * this;
+	}
+
+	// The same rule - the buffers from different places are not exchanged, the elements are
+	void Swap( EMatrixFor & m )
+	{
+		if( HasSameBufOwner( m ) )
+		{
+			SwapBuffers( m );
+			return;
+		}
+
+		const EMatrixFor	tmp( static_cast< const EMatrixFor & >( * this ) );
+		* this = static_cast< const EMatrixFor & >( m );
+		m = tmp;
+	}
+
+	// ---------------------------------------------------------------
+	// Copy-on-write
+	//
+	// A matrix which is passed around by value but mostly only read
+	// can be made copy-on-write. Then its copies (and their copies) only
+	// share its buffer, and a copy duplicates it at the first mutable access,
+	// i.e. with the non-const operator [], begin, end, or GetDataBuf.
+	// The const access never copies, so any number of threads can read
+	// the shared matrices at the same time.
+	//
+	//			EMatrix	a( 1000, 1000 );
+	//			RandInit( a );
+	//			a.SetCopyOnWrite( true );
+	//			EMatrix b( a );		// no copy, a and b share the buffer
+	//			b[ 0 ][ 0 ] = 1.0;	// now b gets its own buffer
+	//
+	// As with std::string, a pointer or a RowProxy taken from the non-const 
+	// matrix is not valid after the matrix is copied. Also, the first write to a shared
+	// matrix should not be in a parallel loop - MakeUnique first and take the data pointer
+	// before the loop, as the kernels of this library do.
+
+	void	SetCopyOnWrite( bool cow ) 
+	{ 
+		MakeUnique();	// so only the copy-on-write matrices share their buffers
+		fCopyOnWrite = cow; 
+	}
+	bool	IsCopyOnWrite( void ) const { return fCopyOnWrite; }
+
+	// True if other matrices use the same buffer
+	bool	IsShared( void ) const { return fDataBuf.use_count() > 1; }
+
+	// Gets this matrix its own buffer, if it is shared
+	void	MakeUnique( void )
+	{
+		if( ! fCopyOnWrite )
+			return;		// a plain matrix never shares
+
+		if( IsShared() )
+		{
+			SharedBuf buf( AllocHeapBuf( fRows * fLeadDim ) );
+			std::copy_n( fDataBuf.get(), fRows * fLeadDim, buf.get() );
+			fDataBuf = std::move( buf );
+		}
+		else
+		{
+			// The last other owner could have just read the buffer and released it
+			// in another thread. Its release synchronizes with this acquire.
+			std::atomic_thread_fence( std::memory_order_acquire );
+		}
+	}
+
+
+	// Helpers
+	auto	GetCols( void ) const { return fCols; }
+	auto	GetRows( void ) const { return fRows; }
+	auto	GetLeadDim( void ) const { return fLeadDim; }
+
+	// Raw access to the buffer - row r starts at GetDataBuf() + r * GetLeadDim()
+	T *			GetDataBuf( void ) { MakeUnique(); return fDataBuf.get(); }
+	const T *	GetDataBuf( void ) const { return fDataBuf.get(); }
+
+
+	// A light-weight view of a single row. It is returned by operator [],
+	// so m[2][3] still works, and it has begin/end for the range-based for loop.
+	template < typename U >
+	class RowIterator;
+
+	template < typename U >
+	class RowProxy
+	{
+		U *		fRowPtr {};
+		Dim		fCols {};
+
+		friend class RowIterator< U >;
+
+	public:
+
+		RowProxy( U * row_ptr, Dim cols ) : fRowPtr( row_ptr ), fCols( cols ) {}
+
+		U &		operator[] ( Dim idx ) const { assert( idx < fCols ); return fRowPtr[ idx ]; }
+
+		U *		begin() const { return fRowPtr; }
+		U *		end()	const { return fRowPtr + fCols; }
+
+		U *		data()	const { return fRowPtr; }
+		Dim		size()	const { return fCols; }
+	};
+
+	// Traverses the matrix row-by-row. The iterator holds a RowProxy
+	// and returns a reference to it, so "for( auto & row : m )" still compiles.
+	template < typename U >
+	class RowIterator
+	{
+		RowProxy< U >	fRow;
+		Dim				fLeadDim {};
+
+	public:
+
+		RowIterator( U * row_ptr, Dim cols, Dim lead_dim ) : fRow( row_ptr, cols ), fLeadDim( lead_dim ) {}
+
+		RowProxy< U > &	operator * () { return fRow; }
+		RowProxy< U > *	operator -> () { return & fRow; }
+
+		RowIterator &	operator ++ () { fRow.fRowPtr += fLeadDim; return * this; }
+
+		bool	operator == ( const RowIterator & it ) const { return fRow.fRowPtr == it.fRow.fRowPtr; }
+		bool	operator != ( const RowIterator & it ) const { return fRow.fRowPtr != it.fRow.fRowPtr; }
+	};
+
+	// Thanks to this overloaded subscript operators 
+	// instead of m.fData[2][3] we can write directly m[2][3] 
+	RowProxy< T >		operator[] ( Dim idx ) 
+		{ assert( idx < fRows ); return { GetDataBuf() + idx * fLeadDim, fCols }; }
+	RowProxy< const T >	operator[] ( Dim idx ) const 
+		{ assert( idx < fRows ); return { fDataBuf.get() + idx * fLeadDim, fCols }; }
+
+	// We need only these two pairs of functions to have a range-based for loop
+	auto			begin() { return RowIterator< T >( GetDataBuf(), fCols, fLeadDim ); }
+	auto			end()	{ return RowIterator< T >( GetDataBuf() + fRows * fLeadDim, fCols, fLeadDim ); }
+
+	auto			begin() const { return RowIterator< const T >( fDataBuf.get(), fCols, fLeadDim ); }
+	auto			end()	const { return RowIterator< const T >( fDataBuf.get() + fRows * fLeadDim, fCols, fLeadDim ); }
+
+
+
+
+	// Construction and assignment from lazy expressions, such as a + b or a * b + c.
+	// They are evaluated in one pass, straight into this matrix (see EMExpr.h).
+	template < typename E >
+	EMatrixFor( const EMExpr< E > & expr );
+
+	template < typename E >
+	EMatrixFor &		operator = ( const EMExpr< E > & expr );
+
+	template < typename E >
+	EMatrixFor &		operator += ( const EMExpr< E > & expr );
+
+};
+
+
+
+// The matrix of doubles - all the kernels and expressions are written for it
+using EMatrix = EMatrixFor< DataType >;
+
+
+// Stream out a matrix to the stream out. Assume text mode.
+std::ostream & operator << ( std::ostream & o, const EMatrix & matrix );
+
+// Stream in a matrix from the stream in. Assume text mode.
+std::istream & operator >> ( std::istream & i, EMatrix & matrix );
+
+
+
+
+
+// ----------------------------------------
+// The arithmetical operators build lazy expressions - see EMExpr.h
+
+
+
+
+
+// ----------------------------------------
+// Other element types
+//
+// EMatrixFor< float > halves the memory traffic and doubles the number of 
+// SIMD lanes, EMatrixFor< FxFor< ... > > holds fixed point numbers (see FxFor.h).
+// For them the operators below compute at once (no expressions), 
+// with plain loops which the compiler can vectorize.
+// The mixed precision product of floats is MultMatrix_Mixed (see EMGemm.h).
+
+
+// True for the element types that use the operators below
+template < typename T >
+constexpr bool kIsOtherElem = ! std::is_same_v< T, DataType >;
+
+
+template < typename T >
+std::ostream &	operator << ( std::ostream & o, const EMatrixFor< T > & matrix )
+{
+	for( const auto & row : matrix )
+	{
+		for( const auto & data : row )
+			o << static_cast< double >( data ) << "\t";
+
+		o << std::endl;
+	}
+
+	return o;
+}
+
+
+// Calls op( c_row, a_row, b_row ) for all rows, in parallel
+template < typename T, typename Op >
+void	ForEachRow( EMatrixFor< T > & c, const EMatrixFor< T > & a, const EMatrixFor< T > & b, Op op )
+{
+	// The buffer of c is taken (and made unique) once, before the parallel loop.
+	// a and b are read with the const access, which never copies.
+	T * const	c_data = c.GetDataBuf();
+	const Dim	c_ld = c.GetLeadDim();
+
+	#if USE_OPEN_MP
+	#pragma omp parallel for schedule( static )
+	#endif
+	for( Dim r = 0; r < c.GetRows(); ++ r )
+		op( c_data + r * c_ld, a[ r ].data(), b[ r ].data() );
+}
+
+
+template < typename T, typename = std::enable_if_t< kIsOtherElem< T > > >
+EMatrixFor< T > &	operator += ( EMatrixFor< T > & a, const EMatrixFor< T > & b )
+{
+	assert( a.GetRows() == b.GetRows() );	// dim must be the same
+	assert( a.GetCols() == b.GetCols() );
+
+	const Dim cols = a.GetCols();
+	ForEachRow( a, a, b, [ cols ] ( T * c_row, const T * a_row, const T * b_row ) 
+	{
+		for( Dim j = 0; j < cols; ++ j )
+			c_row[ j ] = a_row[ j ] + b_row[ j ];
+	} );
+
+	return a;
+}
+
+template < typename T, typename = std::enable_if_t< kIsOtherElem< T > > >
+EMatrixFor< T >		operator + ( const EMatrixFor< T > & a, const EMatrixFor< T > & b )
+{
+	EMatrixFor< T >	c( a );
+	return c += b;
+}
+
+template < typename T, typename = std::enable_if_t< kIsOtherElem< T > > >
+EMatrixFor< T >		operator - ( const EMatrixFor< T > & a, const EMatrixFor< T > & b )
+{
+	assert( a.GetRows() == b.GetRows() );	// dim must be the same
+	assert( a.GetCols() == b.GetCols() );
+
+	EMatrixFor< T >	c( a.GetRows(), a.GetCols() );
+
+	const Dim cols = a.GetCols();
+	ForEachRow( c, a, b, [ cols ] ( T * c_row, const T * a_row, const T * b_row ) 
+	{
+		for( Dim j = 0; j < cols; ++ j )
+			c_row[ j ] = a_row[ j ] - b_row[ j ];
+	} );
+
+	return c;
+}
+
+template < typename T, typename = std::enable_if_t< kIsOtherElem< T > > >
+EMatrixFor< T >		operator * ( T s, const EMatrixFor< T > & a )
+{
+	EMatrixFor< T >	c( a.GetRows(), a.GetCols() );
+
+	const Dim cols = a.GetCols();
+	ForEachRow( c, a, a, [ cols, s ] ( T * c_row, const T * a_row, const T * ) 
+	{
+		for( Dim j = 0; j < cols; ++ j )
+			c_row[ j ] = s * a_row[ j ];
+	} );
+
+	return c;
+}
+
+// The ikj loop - for each a_ik the row k of b is scaled and added to the row i of c,
+// so the innermost loop is unit-stride. It runs on blocks of kElemBlock rows of c
+// and of b, so the rows of b are reused from the cache. Blocks of c are computed in parallel.
+// The elements are accumulated in T, i.e. for floats in single precision.
+template < typename T, typename = std::enable_if_t< kIsOtherElem< T > > >
+EMatrixFor< T >		operator * ( const EMatrixFor< T > & a, const EMatrixFor< T > & b )
+{
+	assert( a.GetCols() == b.GetRows() );			// Dimensions must be the same
+
+	constexpr Dim kElemBlock { 64 };
+
+	EMatrixFor< T >	c( a.GetRows(), b.GetCols() );
+
+	const Dim rows = a.GetRows(), cols = b.GetCols(), inner = a.GetCols();
+	const Dim row_blocks = ( rows + kElemBlock - 1 ) / kElemBlock;
+
+	#if USE_OPEN_MP
+	#pragma omp parallel for schedule( dynamic )
+	#endif
+	for( Dim ib = 0; ib < row_blocks; ++ ib )
+		for( Dim k0 = 0; k0 < inner; k0 += kElemBlock )
+			for( Dim i = ib * kElemBlock; i < std::min( rows, ( ib + 1 ) * kElemBlock ); ++ i )
+			{
+				T *			c_row = c[ i ].data();
+				const T *	a_row = a[ i ].data();
+
+				for( Dim k = k0; k < std::min( inner, k0 + kElemBlock ); ++ k )
+				{
+					const T			a_ik = a_row[ k ];
+					const T *		b_row = b[ k ].data();
+					#if USE_OPEN_MP
+					#pragma omp simd
+					#endif
+					for( Dim j = 0; j < cols; ++ j )
+						c_row[ j ] += a_ik * b_row[ j ];
+				}
+			}
+
+	return c;
+}
+
+
@@ -1,39 +1,75 @@
-// ==========================================================================
-//
-// Software written by Boguslaw Cyganek (C) to be used with the book:
-// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
-// Published by Wiley, 2020
-//
-// The software is supplied as is and for educational purposes
-// without any guarantees nor responsibility of its use in any application. 
-//
-// ==========================================================================
-
-
-// System headers in < >
-#include <time.h>
-
-
-// ------------------------------------
-// A helper simple random generator
-
-// Marsaglia's Xorshift random numbers
-struct MarsXorShift
-{
-	// Start value - must be different from 0
-	unsigned long r_a_n_d { (unsigned long) time( nullptr ) & 0xFF };
-
-	// These values were found by G. Marsaglia
-	// to generate quite good random values
-	unsigned long GetNext( void )
-	{
-		r_a_n_d ^= r_a_n_d << 13;	// << is bit left shift
-		r_a_n_d ^= r_a_n_d >> 17;	// ^= is XOR 
-		r_a_n_d ^= r_a_n_d << 5;
-
-		return r_a_n_d;
-	}
-};
-
-
-
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+// System headers in < >
+#include <time.h>
+#include <cstdint>
+#include <random>
+
+
+// ------------------------------------
+// A helper simple random generator
+
+// SplitMix64 is a counter-based generator - the n-th value depends
+// only on the seed and n. So any position in the sequence can be reached
+// at once, and each thread can generate its own part of the sequence.
+struct SplitMix64
+{
+	static constexpr std::uint64_t kGamma { 0x9E3779B97F4A7C15ull };
+
+	std::uint64_t	fState {};
+
+	explicit SplitMix64( std::uint64_t seed = 0 ) : fState( seed ) {}
+
+	// Scrambles bits of x - this turns a counter into a random value
+	static std::uint64_t Mix( std::uint64_t x )
+	{
+		x = ( x ^ ( x >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+		x = ( x ^ ( x >> 27 ) ) * 0x94D049BB133111EBull;
+		return x ^ ( x >> 31 );
+	}
+
+	std::uint64_t	GetNext( void ) { return Mix( fState += kGamma ); }
+
+	// Skips n values in constant time
+	void			Jump( std::uint64_t n ) { fState += n * kGamma; }
+};
+
+
+// Marsaglia's Xorshift random numbers
+struct MarsXorShift
+{
+	// Start value - must be different from 0
+	unsigned long r_a_n_d { InitSeed() };
+
+	// Mixes the time with the random device, so that runs started
+	// in the same second also get different seeds
+	static unsigned long InitSeed( void )
+	{
+		const auto seed = SplitMix64::Mix( (std::uint64_t) time( nullptr ) ^ (std::uint64_t) std::random_device{}() << 32 );
+		return seed != 0 ? (unsigned long) seed : 1;
+	}
+
+	// These values were found by G. Marsaglia
+	// to generate quite good random values
+	unsigned long GetNext( void )
+	{
+		r_a_n_d ^= r_a_n_d << 13;	// << is bit left shift
+		r_a_n_d ^= r_a_n_d >> 17;	// ^= is XOR 
+		r_a_n_d ^= r_a_n_d << 5;
+
+		return r_a_n_d;
+	}
+};
+
+
+
@@ -0,0 +1,256 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+
+
+
+
+#pragma once
+
+
+#include <array>
+#include <utility>
+#include <type_traits>
+
+#include "EMatrix.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// Fixed-size matrices
+//
+// TMatrixFor< T, Rows, Cols > is a small matrix, such as a 3x3 rotation or
+// a 4x4 homogeneous transform, with the dimensions known at compile time.
+// Its elements are stored row-by-row in a std::array inside the object,
+// so there are no heap allocations, and it can be used in constexpr code.
+// Wrong dimensions in +, - or * are compile errors, not runtime asserts.
+//
+// The loops of the small operations are unrolled with index sequences,
+// so the compiler sees straight-line code (and can keep it in registers).
+
+
+
+// The operations with more element operations are not unrolled
+// (the plain loops are left to the optimizer)
+constexpr Dim	kTMatrix_UnrollLimit { 512 };
+
+
+
+// Calls f( std::integral_constant< Dim, i > ) for i = 0, 1, ..., N - 1,
+// with no loop at all - the fold expression expands to N calls.
+template < typename F, Dim... I >
+constexpr void UnrollFor_Impl( F && f, std::integer_sequence< Dim, I... > )
+{
+	( f( std::integral_constant< Dim, I > {} ), ... );
+}
+
+template < Dim N, typename F >
+constexpr void UnrollFor( F && f )
+{
+	UnrollFor_Impl( f, std::make_integer_sequence< Dim, N > {} );
+}
+
+// Unrolls if Work <= kTMatrix_UnrollLimit, otherwise a normal loop
+template < Dim N, Dim Work, typename F >
+constexpr void UnrollIfSmall( F && f )
+{
+	if constexpr( Work <= kTMatrix_UnrollLimit )
+		UnrollFor< N >( f );
+	else
+		for( Dim i = 0; i < N; ++ i )
+			f( i );
+}
+
+
+
+template < typename T, Dim Rows, Dim Cols >
+class TMatrixFor
+{
+	static_assert( Rows > 0 && Cols > 0, "TMatrixFor cannot be empty" );
+
+public:
+
+	using value_type = T;
+
+	static constexpr Dim	kRows { Rows };
+	static constexpr Dim	kCols { Cols };
+	static constexpr Dim	kElems { Rows * Cols };
+
+private:
+
+	std::array< T, kElems >		fData {};		// row-by-row, inline
+
+public:
+
+	// All elements set to T {}
+	constexpr TMatrixFor( void ) = default;
+
+	// All elements set to init_val
+	constexpr explicit TMatrixFor( T init_val )
+	{
+		UnrollIfSmall< kElems, kElems >( [ & ] ( Dim i ) { fData[ i ] = init_val; } );
+	}
+
+	// Row-by-row, e.g. TMatrixFor< double, 2, 2 > m( { 1.0, 2.0, 3.0, 4.0 } );
+	constexpr explicit TMatrixFor( const std::array< T, kElems > & data ) : fData( data ) {}
+
+	// From a dynamic matrix - its size is known only at runtime, so it is asserted
+	explicit TMatrixFor( const EMatrix & m )
+	{
+		assert( m.GetRows() == Rows && m.GetCols() == Cols );
+		for( Dim r = 0; r < Rows; ++ r )
+			for( Dim c = 0; c < Cols; ++ c )
+				fData[ r * Cols + c ] = static_cast< T >( m[ r ][ c ] );
+	}
+
+	// Returns a copy as a dynamic matrix
+	EMatrix		ToEMatrix( void ) const
+	{
+		EMatrix	m( Rows, Cols );
+		for( Dim r = 0; r < Rows; ++ r )
+			for( Dim c = 0; c < Cols; ++ c )
+				m[ r ][ c ] = static_cast< DataType >( fData[ r * Cols + c ] );
+		return m;
+	}
+
+	static constexpr TMatrixFor		Identity( void )
+	{
+		static_assert( Rows == Cols, "Identity must be square" );
+
+		TMatrixFor	e;
+		UnrollIfSmall< Rows, Rows >( [ & ] ( Dim i ) { e( i, i ) = T( 1 ); } );
+		return e;
+	}
+
+public:
+
+	static constexpr Dim	GetRows( void ) { return Rows; }
+	static constexpr Dim	GetCols( void ) { return Cols; }
+
+	constexpr T *			GetData( void ) { return fData.data(); }
+	constexpr const T *		GetData( void ) const { return fData.data(); }
+
+	// m( r, c )
+	constexpr T &			operator () ( Dim r, Dim c ) { return fData[ r * Cols + c ]; }
+	constexpr const T &		operator () ( Dim r, Dim c ) const { return fData[ r * Cols + c ]; }
+
+	// m[ r ][ c ] - returns a pointer to the row r
+	constexpr T *			operator [] ( Dim r ) { return fData.data() + r * Cols; }
+	constexpr const T *		operator [] ( Dim r ) const { return fData.data() + r * Cols; }
+
+public:
+
+	constexpr TMatrixFor &	operator += ( const TMatrixFor & b )
+	{
+		UnrollIfSmall< kElems, kElems >( [ & ] ( Dim i ) { fData[ i ] += b.fData[ i ]; } );
+		return * this;
+	}
+
+	constexpr TMatrixFor &	operator -= ( const TMatrixFor & b )
+	{
+		UnrollIfSmall< kElems, kElems >( [ & ] ( Dim i ) { fData[ i ] -= b.fData[ i ]; } );
+		return * this;
+	}
+
+	constexpr TMatrixFor &	operator *= ( T s )
+	{
+		UnrollIfSmall< kElems, kElems >( [ & ] ( Dim i ) { fData[ i ] *= s; } );
+		return * this;
+	}
+
+	constexpr bool	operator == ( const TMatrixFor & b ) const
+	{
+		bool equal { true };
+		UnrollIfSmall< kElems, kElems >( [ & ] ( Dim i ) { equal = equal && fData[ i ] == b.fData[ i ]; } );
+		return equal;
+	}
+
+	constexpr bool	operator != ( const TMatrixFor & b ) const { return ! ( * this == b ); }
+};
+
+
+
+// The sizes are template parameters, so a mismatch stops the compilation
+// with a clear message (not just "no matching operator").
+
+template < typename T, Dim R1, Dim C1, Dim R2, Dim C2 >
+constexpr auto	operator + ( const TMatrixFor< T, R1, C1 > & a, const TMatrixFor< T, R2, C2 > & b )
+{
+	static_assert( R1 == R2 && C1 == C2, "Matrices to add must be of the same size" );
+	auto c { a };
+	return c += b;
+}
+
+template < typename T, Dim R1, Dim C1, Dim R2, Dim C2 >
+constexpr auto	operator - ( const TMatrixFor< T, R1, C1 > & a, const TMatrixFor< T, R2, C2 > & b )
+{
+	static_assert( R1 == R2 && C1 == C2, "Matrices to subtract must be of the same size" );
+	auto c { a };
+	return c -= b;
+}
+
+template < typename T, Dim R, Dim C >
+constexpr auto	operator * ( T s, const TMatrixFor< T, R, C > & a )
+{
+	auto c { a };
+	return c *= s;
+}
+
+// ( R x K ) * ( K x C ) -> R x C
+template < typename T, Dim R, Dim K1, Dim K2, Dim C >
+constexpr auto	operator * ( const TMatrixFor< T, R, K1 > & a, const TMatrixFor< T, K2, C > & b )
+{
+	static_assert( K1 == K2, "The number of columns of a must be the same as the number of rows of b" );
+
+	constexpr Dim kWork { R * C * K1 };
+
+	TMatrixFor< T, R, C >	c;
+	UnrollIfSmall< R, kWork >( [ & ] ( Dim i ) 
+	{
+		UnrollIfSmall< C, kWork >( [ & ] ( Dim j ) 
+		{
+			T sum {};
+			UnrollIfSmall< K1, kWork >( [ & ] ( Dim k ) { sum += a( i, k ) * b( k, j ); } );
+			c( i, j ) = sum;
+		} );
+	} );
+	return c;
+}
+
+template < typename T, Dim R, Dim C >
+constexpr auto	Transpose( const TMatrixFor< T, R, C > & a )
+{
+	TMatrixFor< T, C, R >	at;
+	UnrollIfSmall< R, R * C >( [ & ] ( Dim i )
+	{
+		UnrollIfSmall< C, R * C >( [ & ] ( Dim j ) { at( j, i ) = a( i, j ); } );
+	} );
+	return at;
+}
+
+
+template < typename T, Dim R, Dim C >
+std::ostream &	operator << ( std::ostream & o, const TMatrixFor< T, R, C > & a )
+{
+	for( Dim r = 0; r < R; ++ r )
+	{
+		for( Dim c = 0; c < C; ++ c )
+			o << a( r, c ) << "\t";
+		o << std::endl;
+	}
+	return o;
+}
+
+
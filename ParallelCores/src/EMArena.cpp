@@ -0,0 +1,116 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+
+
+#include <algorithm>
+#include <cassert>
+
+
+#include "EMArena.h"
+
+
+
+
+namespace
+{
+
+	// Each thread has its own current arena
+	thread_local EMArena *		gCurrentArena { nullptr };
+	thread_local std::size_t	gScopeLevel { 0 };
+
+}
+
+
+
+EMArena::~EMArena()
+{
+	assert( fLive == 0 );		// some buffers still point to the blocks
+}
+
+
+void *			EMArena::Allocate( std::size_t bytes )
+{
+	bytes = ( bytes + kAlignment - 1 ) / kAlignment * kAlignment;
+
+	// Go to the next block if this one is too small. The same sequence of
+	// requests in the next iteration finds the same blocks, so nothing is allocated.
+	while( fCurBlock < fBlocks.size() && fOffset + bytes > fBlocks[ fCurBlock ].fBytes )
+	{
+		++ fCurBlock;
+		fOffset = 0;
+	}
+
+	if( fCurBlock == fBlocks.size() )
+	{
+		const std::size_t block_bytes = std::max( fBlockBytes, bytes );
+		fBlocks.push_back( { std::unique_ptr< char [], BlockDeleter >( static_cast< char * >( ::operator new [] ( block_bytes, std::align_val_t( kAlignment ) ) ) ), block_bytes } );
+		fOffset = 0;
+	}
+
+	char * p = fBlocks[ fCurBlock ].fData.get() + fOffset;
+	fOffset += bytes;
+	++ fLive;
+	return p;
+}
+
+
+std::size_t		EMArena::GetCapacity( void ) const
+{
+	std::size_t capacity {};
+	for( const auto & b : fBlocks )
+		capacity += b.fBytes;
+	return capacity;
+}
+
+
+EMArena *		EMArena::GetCurrent( void )
+{
+	return gCurrentArena;
+}
+
+std::size_t		EMArena::GetCurrentLevel( void )
+{
+	return gScopeLevel;
+}
+
+
+
+// ------------------------------------------------------------------------
+
+
+
+EMArena::Scope::Scope( EMArena & arena )
+	: fArena( arena ), fPrevArena( gCurrentArena ), 
+	  fBlock( arena.fCurBlock ), fOffset( arena.fOffset ), fLive( arena.fLive )
+{
+	gCurrentArena = & arena;
+	++ gScopeLevel;
+}
+
+
+EMArena::Scope::~Scope()
+{
+	// All matrices from this scope must be gone now
+	assert( fArena.fLive == fLive );
+
+	fArena.fCurBlock = fBlock;
+	fArena.fOffset = fOffset;
+
+	gCurrentArena = fPrevArena;
+	-- gScopeLevel;
+}
+
+
+
@@ -0,0 +1,124 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+
+
+#include <algorithm>
+#include <omp.h>		// Header for OpenMP
+
+
+#include "EMBatch.h"
+#include "EMSimd.h"
+
+
+
+
+EMBatch::EMBatch( Dim count, Dim rows, Dim cols )
+	: fDataBuf( EMatrix::AllocDataBuf( ( count + kBatch_Lanes - 1 ) / kBatch_Lanes * rows * cols * kBatch_Lanes ) ), 
+	  fCount( count ), fRows( rows ), fCols( cols )
+{
+	std::fill( fDataBuf.get(), fDataBuf.get() + GetGroups() * GetGroupElems(), 0.0 );
+}
+
+
+EMBatch::EMBatch( const std::vector< EMatrix > & ms )
+	: EMBatch( ms.size(), ms.empty() ? 0 : ms[ 0 ].GetRows(), ms.empty() ? 0 : ms[ 0 ].GetCols() )
+{
+	#pragma omp parallel for schedule( static ) if( fCount > kBatch_ChunkGroups * kBatch_Lanes )
+	for( Dim k = 0; k < fCount; ++ k )
+		Set( k, ms[ k ] );
+}
+
+
+EMBatch::EMBatch( const EMBatch & b )
+	: fDataBuf( EMatrix::AllocDataBuf( b.GetGroups() * b.GetGroupElems() ) ), 
+	  fCount( b.fCount ), fRows( b.fRows ), fCols( b.fCols )
+{
+	std::copy( b.fDataBuf.get(), b.fDataBuf.get() + GetGroups() * GetGroupElems(), fDataBuf.get() );
+}
+
+
+EMBatch & EMBatch::operator = ( const EMBatch & b )
+{
+	if( this != & b )
+		* this = EMBatch( b );
+	return * this;
+}
+
+
+void		EMBatch::Set( Dim k, const EMatrix & m )
+{
+	assert( m.GetRows() == fRows && m.GetCols() == fCols );
+
+	for( Dim r = 0; r < fRows; ++ r )
+		for( Dim c = 0; c < fCols; ++ c )
+			( * this )( k, r, c ) = m[ r ][ c ];
+}
+
+
+EMatrix		EMBatch::Get( Dim k ) const
+{
+	EMatrix	m( fRows, fCols );
+
+	for( Dim r = 0; r < fRows; ++ r )
+		for( Dim c = 0; c < fCols; ++ c )
+			m[ r ][ c ] = ( * this )( k, r, c );
+
+	return m;
+}
+
+
+
+// ------------------------------------------------------------------------
+
+
+
+void		MultBatch( const EMBatch & a, const EMBatch & b, EMBatch & c )
+{
+	assert( a.GetCount() == b.GetCount() && a.GetCount() == c.GetCount() );
+	assert( a.GetCols() == b.GetRows() );
+	assert( c.GetRows() == a.GetRows() && c.GetCols() == b.GetCols() );
+
+	const Dim	groups = a.GetGroups();
+	const Dim	chunks = ( groups + kBatch_ChunkGroups - 1 ) / kBatch_ChunkGroups;
+
+	const Dim	m = a.GetRows(), n = b.GetCols(), k = a.GetCols();
+
+	const DataType *	a_buf = a.GetDataBuf();
+	const DataType *	b_buf = b.GetDataBuf();
+	DataType *			c_buf = c.GetDataBuf();
+
+	auto BatchMult = GetKernels().BatchMult;
+
+	// The padding matrices are 0, so whole groups are multiplied
+	#pragma omp parallel for schedule( static ) if( chunks > 1 )
+	for( Dim ch = 0; ch < chunks; ++ ch )
+	{
+		const Dim g0 = ch * kBatch_ChunkGroups;
+		const Dim gn = std::min( kBatch_ChunkGroups, groups - g0 );
+
+		BatchMult( gn, m, n, k, a_buf + g0 * a.GetGroupElems(), b_buf + g0 * b.GetGroupElems(), c_buf + g0 * c.GetGroupElems() );
+	}
+}
+
+
+EMBatch		MultBatch( const EMBatch & a, const EMBatch & b )
+{
+	EMBatch c( a.GetCount(), a.GetRows(), b.GetCols() );
+	MultBatch( a, b, c );
+	return c;
+}
+
+
+
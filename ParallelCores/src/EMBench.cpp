@@ -0,0 +1,309 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <omp.h>		// Header for OpenMP
+
+
+#include "EMBench.h"
+#include "EMUtility.h"
+#include "EMGemv.h"
+#include "EMSimd.h"
+
+
+
+
+namespace
+{
+
+	// The results of the reductions go here, so the compiler cannot skip them
+	volatile DataType	gBenchSink {};
+
+
+	// An operation set up for one size. It owns its matrices.
+	struct BenchOp
+	{
+		std::function< void( void ) >	fRun;
+
+		double		fWork {};			// FLOPs or bytes moved by one run
+		bool		fIsFlops {};
+	};
+
+
+	// Returns random matrices, the same in each run
+	EMatrix		BenchMatrix( Dim rows, Dim cols, std::uint64_t seed )
+	{
+		EMatrix	m( rows, cols );		// first touched in parallel
+		RandInit( m, seed );
+		return m;
+	}
+
+
+	// The matrices are read row by row, so the padding of the rows is not counted
+	constexpr double	kElemBytes { sizeof( DataType ) };
+
+
+	BenchOp		MakeBenchOp( const std::string & name, Dim n )
+	{
+		const double n2 = double( n ) * double( n );
+
+		if( name == "add" )
+		{
+			// c = a + b reads two and writes one matrix
+			auto run = [ a = BenchMatrix( n, n, 1 ), b = BenchMatrix( n, n, 2 ), c = EMatrix( n, n ) ] () mutable { c = a + b; };
+			return { run, 3.0 * n2 * kElemBytes, false };
+		}
+
+		if( name == "mul" )
+		{
+			auto run = [ a = BenchMatrix( n, n, 1 ), b = BenchMatrix( n, n, 2 ), c = EMatrix( n, n ) ] () mutable { c = a * b; };
+			return { run, 2.0 * n2 * double( n ), true };
+		}
+
+		if( name == "transpose" )
+		{
+			// Into the same output each time, so no allocation is measured
+			auto run = [ n, a = BenchMatrix( n, n, 1 ), t = EMatrix( n, n ) ] () mutable 
+						{ Transpose_Raw( n, n, a.GetDataBuf(), a.GetLeadDim(), t.GetDataBuf(), t.GetLeadDim() ); };
+			return { run, 2.0 * n2 * kElemBytes, false };
+		}
+
+		if( name == "gemv" || name == "gemv_trans" )
+		{
+			// A is read once, the vectors are negligible
+			auto run = [ a = BenchMatrix( n, n, 1 ), x = RealVec( n, 1.0 / n ), y = RealVec( n ), trans = name == "gemv_trans" ] () mutable
+						{ trans ? Gemv_Trans( a, x.data(), y.data() ) : Gemv( a, x.data(), y.data() ); };
+			return { run, n2 * kElemBytes, false };
+		}
+
+		if( name == "dot" )
+		{
+			// The inner product of the n^2 elements of a and b - row by row with the SIMD kernel
+			auto run = [ a = BenchMatrix( n, n, 1 ), b = BenchMatrix( n, n, 2 ) ] ()
+			{
+				const Dim	rows = a.GetRows(), cols = a.GetCols(), ld = a.GetLeadDim();
+				const DataType *	A = a.GetDataBuf();
+				const DataType *	B = b.GetDataBuf();
+
+				const auto dot = GetKernels().Dot;
+
+				DataType sum {};
+				#pragma omp parallel for reduction( + : sum ) schedule( static )
+				for( Dim r = 0; r < rows; ++ r )
+					sum += dot( cols, A + r * ld, B + r * ld );
+
+				gBenchSink = sum;
+			};
+			return { run, 2.0 * n2 * kElemBytes, false };
+		}
+
+		if( name == "dot_kahan" || name == "dot_neumaier" || name == "dot2" )
+		{
+			// The same with the compensated kernels (see EMDot.h)
+			const auto & kernels = GetKernels();
+			const auto dot = name == "dot_kahan" ? kernels.DotKahan : name == "dot_neumaier" ? kernels.DotNeumaier : kernels.Dot2;
+
+			auto run = [ dot, a = BenchMatrix( n, n, 1 ), b = BenchMatrix( n, n, 2 ) ] ()
+			{
+				const Dim	rows = a.GetRows(), cols = a.GetCols(), ld = a.GetLeadDim();
+				const DataType *	A = a.GetDataBuf();
+				const DataType *	B = b.GetDataBuf();
+
+				DataType sum {};
+				#pragma omp parallel for reduction( + : sum ) schedule( static )
+				for( Dim r = 0; r < rows; ++ r )
+				{
+					const auto row_sum = dot( cols, A + r * ld, B + r * ld );
+					sum += row_sum.fSum + row_sum.fErr;
+				}
+
+				gBenchSink = sum;
+			};
+			return { run, 2.0 * n2 * kElemBytes, false };
+		}
+
+		if( name == "sum" )
+		{
+			// The sum of all elements
+			auto run = [ a = BenchMatrix( n, n, 1 ) ] ()
+			{
+				const Dim	rows = a.GetRows(), cols = a.GetCols(), ld = a.GetLeadDim();
+				const DataType *	A = a.GetDataBuf();
+
+				DataType sum {};
+				#pragma omp parallel for reduction( + : sum ) schedule( static )
+				for( Dim r = 0; r < rows; ++ r )
+				{
+					const DataType *	row = A + r * ld;
+					DataType			row_sum {};
+					#pragma omp simd reduction( + : row_sum )
+					for( Dim c = 0; c < cols; ++ c )
+						row_sum += row[ c ];
+					sum += row_sum;
+				}
+
+				gBenchSink = sum;
+			};
+			return { run, n2 * kElemBytes, false };
+		}
+
+		assert( false );	// unknown name
+		return {};
+	}
+
+
+	// 1, 2, 4, ... and the max number of threads
+	std::vector< int >	DefaultThreads( void )
+	{
+		const int kMaxThreads = omp_get_max_threads();
+
+		std::vector< int >	threads;
+		for( int t = 1; t < kMaxThreads; t *= 2 )
+			threads.push_back( t );
+		threads.push_back( kMaxThreads );
+		return threads;
+	}
+
+}
+
+
+
+double		BenchTimes::GetMedian( void ) const
+{
+	assert( fTimes.size() > 0 );
+	const auto k = fTimes.size();
+	return k % 2 == 1 ? fTimes[ k / 2 ] : 0.5 * ( fTimes[ k / 2 - 1 ] + fTimes[ k / 2 ] );
+}
+
+
+double		BenchTimes::GetPercentile( double p ) const
+{
+	assert( fTimes.size() > 0 );
+	assert( p >= 0.0 && p <= 100.0 );
+
+	// The smallest time that is not less than p percent of the times
+	const auto rank = static_cast< std::size_t >( std::ceil( p / 100.0 * fTimes.size() ) );
+	return fTimes[ std::clamp< std::size_t >( rank, 1, fTimes.size() ) - 1 ];
+}
+
+
+BenchTimes	TimeTrials( const std::function< void( void ) > & op, int warm_ups, int trials )
+{
+	assert( trials > 0 );
+
+	for( int i = 0; i < warm_ups; ++ i )
+		op();
+
+	BenchTimes	times;
+	for( int i = 0; i < trials; ++ i )
+	{
+		auto start_time = omp_get_wtime();
+		op();
+		times.fTimes.push_back( omp_get_wtime() - start_time );
+	}
+
+	std::sort( times.fTimes.begin(), times.fTimes.end() );
+	return times;
+}
+
+
+
+std::vector< std::string >	GetBenchOps( void )
+{
+	return { "add", "mul", "transpose", "gemv", "gemv_trans", "dot", "dot_kahan", "dot_neumaier", "dot2", "sum" };
+}
+
+
+std::vector< BenchResult >	RunBenchSuite( const BenchConfig & config, std::ostream & log )
+{
+	const auto	ops		= config.fOps.empty() ? GetBenchOps() : config.fOps;
+	const auto	threads	= config.fThreads.empty() ? DefaultThreads() : config.fThreads;
+
+	const int	kMaxThreads = omp_get_max_threads();		// restored at the end
+
+	log << "SIMD: " << GetKernels().fName << ", max threads: " << kMaxThreads << std::endl;
+
+	std::vector< BenchResult >	results;
+
+	for( const auto & name : ops )
+	{
+		for( const auto n : config.fSizes )
+		{
+			BenchOp		op { MakeBenchOp( name, n ) };
+
+			for( const auto t : threads )
+			{
+				omp_set_num_threads( t );
+
+				const BenchTimes	times { TimeTrials( op.fRun, config.fWarmUps, config.fTrials ) };
+
+				BenchResult		res;
+				res.fOp			= name;
+				res.fSize		= n;
+				res.fThreads	= t;
+				res.fTrials		= config.fTrials;
+				res.fMedian		= times.GetMedian();
+				res.fMin		= times.GetMin();
+				res.fP95		= times.GetPercentile( 95.0 );
+				res.fRate		= op.fWork / res.fMedian * 1e-9;
+				res.fUnit		= op.fIsFlops ? "GFLOP/s" : "GB/s";
+
+				log << std::left << std::setw( 14 ) << name << "n=" << std::setw( 7 ) << n << "t=" << std::setw( 4 ) << t << std::right
+					<< std::fixed << std::setprecision( 3 )
+					<< "median " << std::setw( 10 ) << res.fMedian * 1e3 << " ms   min " << std::setw( 10 ) << res.fMin * 1e3 
+					<< " ms   p95 " << std::setw( 10 ) << res.fP95 * 1e3 << " ms   "
+					<< std::setprecision( 2 ) << std::setw( 8 ) << res.fRate << " " << res.fUnit << std::defaultfloat << std::endl;
+
+				results.push_back( res );
+			}
+		}
+	}
+
+	omp_set_num_threads( kMaxThreads );
+
+	return results;
+}
+
+
+
+void		WriteBenchCsv( std::ostream & os, const std::vector< BenchResult > & results )
+{
+	os << "op,size,threads,trials,median_s,min_s,p95_s,rate,unit\n";
+	os << std::setprecision( 9 );
+	for( const auto & r : results )
+		os	<< r.fOp << ',' << r.fSize << ',' << r.fThreads << ',' << r.fTrials << ',' 
+			<< r.fMedian << ',' << r.fMin << ',' << r.fP95 << ',' << r.fRate << ',' << r.fUnit << '\n';
+}
+
+
+void		WriteBenchJson( std::ostream & os, const std::vector< BenchResult > & results )
+{
+	os << std::setprecision( 9 );
+	os << "{\n";
+	os << "  \"simd\": \"" << GetKernels().fName << "\",\n";
+	os << "  \"max_threads\": " << omp_get_max_threads() << ",\n";
+	os << "  \"results\": [";
+	for( std::size_t i = 0; i < results.size(); ++ i )
+	{
+		const auto & r = results[ i ];
+		os	<< ( i > 0 ? "," : "" ) << "\n    { "
+			<< "\"op\": \"" << r.fOp << "\", \"size\": " << r.fSize << ", \"threads\": " << r.fThreads << ", \"trials\": " << r.fTrials 
+			<< ", \"median_s\": " << r.fMedian << ", \"min_s\": " << r.fMin << ", \"p95_s\": " << r.fP95 
+			<< ", \"rate\": " << r.fRate << ", \"unit\": \"" << r.fUnit << "\" }";
+	}
+	os << "\n  ]\n}\n";
+}
+
+
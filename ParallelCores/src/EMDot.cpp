@@ -0,0 +1,75 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#include "EMDot.h"
+#include "EMThreadPool.h"
+
+
+
+
+namespace
+{
+
+	EMDotSum	DotSum( Dim n, const DataType * x, const DataType * y, EDotAlg alg )
+	{
+		const auto & kernels = GetKernels();
+		switch( alg )
+		{
+			case EDotAlg::kKahan:		return kernels.DotKahan( n, x, y );
+			case EDotAlg::kNeumaier:	return kernels.DotNeumaier( n, x, y );
+			default:					return kernels.Dot2( n, x, y );
+		}
+	}
+
+}
+
+
+
+DataType		Dot_Kahan( Dim n, const DataType * x, const DataType * y )
+{
+	return Dot_Compensated( n, x, y, EDotAlg::kKahan );
+}
+
+DataType		Dot_Neumaier( Dim n, const DataType * x, const DataType * y )
+{
+	return Dot_Compensated( n, x, y, EDotAlg::kNeumaier );
+}
+
+DataType		Dot2( Dim n, const DataType * x, const DataType * y )
+{
+	return Dot_Compensated( n, x, y, EDotAlg::kDot2 );
+}
+
+
+DataType		Dot_Compensated( Dim n, const DataType * x, const DataType * y, EDotAlg alg )
+{
+	const auto sum = DotSum( n, x, y, alg );
+	return sum.fSum + sum.fErr;
+}
+
+
+DataType		Dot_Compensated_Par( Dim n, const DataType * x, const DataType * y, EDotAlg alg, Dim chunk )
+{
+	const auto parts = EMThreadPool::GetDefault().ParallelMap( 0, n, chunk, 
+							[ x, y, alg ] ( Dim b, Dim e ) { return DotSum( e - b, x + b, y + b, alg ); } );
+
+	// The parts are added in the order of the chunks, their errors are kept in fErr
+	EMDotSum total {};
+	for( const auto & part : parts )
+	{
+		DataType e {};
+		TwoSum( total.fSum, part.fSum, total.fSum, e );
+		total.fErr += e + part.fErr;
+	}
+
+	return total.fSum + total.fErr;
+}
@@ -0,0 +1,280 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+// This file is compiled without contracting a * b + s into FMA (see CMakeLists.txt).
+// The compensated steps need each product and sum rounded on its own - a fused 
+// a * b + s breaks the error-free transformations. The other kernels (EMSimd.cpp)
+// are free to use the contraction.
+
+#include <cmath>
+
+#if defined( _M_X64 ) || defined( __x86_64__ )
+	#define EM_X86_64	1
+	#include <immintrin.h>
+#endif
+
+// As in EMSimd.cpp
+#if defined( __GNUC__ )
+	#define EM_TARGET_AVX2		__attribute__(( target( "avx2,fma" ) ))
+	#define EM_TARGET_AVX512	__attribute__(( target( "avx512f,avx2,fma" ) ))
+#else
+	#define EM_TARGET_AVX2
+	#define EM_TARGET_AVX512
+#endif
+
+
+#include "EMDot.h"
+
+
+
+
+namespace
+{
+
+	// -----------------------------------------------
+	// The compensated dot products (see EMDot.h)
+	//
+	// Each lane keeps a running sum s and a compensation c, so s + c is more 
+	// accurate than s alone. The lanes are independent, so there is no long chain 
+	// of dependent additions as in the serial algorithms.
+
+	// One step: s + c += a * b
+	template < EDotAlg Alg >
+	inline void DotStep( DataType a, DataType b, DataType & s, DataType & c )
+	{
+		const DataType p = a * b;
+
+		if constexpr( Alg == EDotAlg::kKahan )
+		{
+			const DataType y = p + c;		// the correction goes into the next summand
+			const DataType t = s + y;
+			c = ( s - t ) + y;				// what of y did not make it into t
+			s = t;
+		}
+		else if constexpr( Alg == EDotAlg::kNeumaier )
+		{
+			// The lost bits are recovered from the smaller of s and p
+			const DataType t = s + p;
+			c += std::fabs( s ) >= std::fabs( p ) ? ( s - t ) + p : ( p - t ) + s;
+			s = t;
+		}
+		else
+		{
+			// Dot2 - also the rounding error of the product is kept, a * b == p + pe.
+			// Without FMA in hardware std::fma is slow, but it is still exact.
+			const DataType pe = std::fma( a, b, - p );
+			DataType e {};
+			TwoSum( s, p, s, e );
+			c += e + pe;
+		}
+	}
+
+	// Adds up the lanes - the errors of these additions go to fErr too
+	EMDotSum SumLanes( const DataType * s, const DataType * c, Dim lanes )
+	{
+		EMDotSum sum {};
+		for( Dim l = 0; l < lanes; ++ l )
+		{
+			DataType e {};
+			TwoSum( sum.fSum, s[ l ], sum.fSum, e );
+			sum.fErr += e + c[ l ];
+		}
+		return sum;
+	}
+
+
+#if EM_X86_64
+
+	// The compensated dot products - the steps as in DotStep, on 4 lanes
+	template < EDotAlg Alg >
+	EM_TARGET_AVX2 inline void DotStep_AVX2( __m256d a, __m256d b, __m256d & s, __m256d & c )
+	{
+		const __m256d p = _mm256_mul_pd( a, b );
+
+		if constexpr( Alg == EDotAlg::kKahan )
+		{
+			const __m256d y = _mm256_add_pd( p, c );
+			const __m256d t = _mm256_add_pd( s, y );
+			c = _mm256_add_pd( _mm256_sub_pd( s, t ), y );
+			s = t;
+		}
+		else if constexpr( Alg == EDotAlg::kNeumaier )
+		{
+			// No branches - the larger and the smaller of s and p are blended
+			const __m256d abs_mask = _mm256_castsi256_pd( _mm256_set1_epi64x( 0x7FFFFFFFFFFFFFFF ) );
+			const __m256d s_ge_p = _mm256_cmp_pd( _mm256_and_pd( s, abs_mask ), _mm256_and_pd( p, abs_mask ), _CMP_GE_OQ );
+			const __m256d big = _mm256_blendv_pd( p, s, s_ge_p );
+			const __m256d small = _mm256_blendv_pd( s, p, s_ge_p );
+			const __m256d t = _mm256_add_pd( s, p );
+			c = _mm256_add_pd( c, _mm256_add_pd( _mm256_sub_pd( big, t ), small ) );
+			s = t;
+		}
+		else
+		{
+			const __m256d pe = _mm256_fmsub_pd( a, b, p );		// TwoProd - a * b - p is exact
+			const __m256d t = _mm256_add_pd( s, p );			// TwoSum
+			const __m256d z = _mm256_sub_pd( t, s );
+			const __m256d e = _mm256_add_pd( _mm256_sub_pd( s, _mm256_sub_pd( t, z ) ), _mm256_sub_pd( p, z ) );
+			c = _mm256_add_pd( c, _mm256_add_pd( e, pe ) );
+			s = t;
+		}
+	}
+
+	EM_TARGET_AVX512 __mmask8 TailMask( Dim n )
+	{
+		return static_cast< __mmask8 >( ( 1u << n ) - 1u );
+	}
+
+	// The compensated dot products - the steps as in DotStep, on 8 lanes
+	template < EDotAlg Alg >
+	EM_TARGET_AVX512 inline void DotStep_AVX512( __m512d a, __m512d b, __m512d & s, __m512d & c )
+	{
+		const __m512d p = _mm512_mul_pd( a, b );
+
+		if constexpr( Alg == EDotAlg::kKahan )
+		{
+			const __m512d y = _mm512_add_pd( p, c );
+			const __m512d t = _mm512_add_pd( s, y );
+			c = _mm512_add_pd( _mm512_sub_pd( s, t ), y );
+			s = t;
+		}
+		else if constexpr( Alg == EDotAlg::kNeumaier )
+		{
+			const __mmask8 s_ge_p = _mm512_cmp_pd_mask( _mm512_abs_pd( s ), _mm512_abs_pd( p ), _CMP_GE_OQ );
+			const __m512d big = _mm512_mask_blend_pd( s_ge_p, p, s );
+			const __m512d small = _mm512_mask_blend_pd( s_ge_p, s, p );
+			const __m512d t = _mm512_add_pd( s, p );
+			c = _mm512_add_pd( c, _mm512_add_pd( _mm512_sub_pd( big, t ), small ) );
+			s = t;
+		}
+		else
+		{
+			const __m512d pe = _mm512_fmsub_pd( a, b, p );
+			const __m512d t = _mm512_add_pd( s, p );
+			const __m512d z = _mm512_sub_pd( t, s );
+			const __m512d e = _mm512_add_pd( _mm512_sub_pd( s, _mm512_sub_pd( t, z ) ), _mm512_sub_pd( p, z ) );
+			c = _mm512_add_pd( c, _mm512_add_pd( e, pe ) );
+			s = t;
+		}
+	}
+
+#endif // EM_X86_64
+
+}
+
+
+
+template < EDotAlg Alg >
+EMDotSum CompensatedDot_Scalar( Dim n, const DataType * x, const DataType * y )
+{
+	DataType s[ 4 ] {}, c[ 4 ] {};
+	Dim i {};
+	for( ; i + 4 <= n; i += 4 )
+	{
+		DotStep< Alg >( x[ i ],		y[ i ],		s[ 0 ], c[ 0 ] );
+		DotStep< Alg >( x[ i + 1 ], y[ i + 1 ], s[ 1 ], c[ 1 ] );
+		DotStep< Alg >( x[ i + 2 ], y[ i + 2 ], s[ 2 ], c[ 2 ] );
+		DotStep< Alg >( x[ i + 3 ], y[ i + 3 ], s[ 3 ], c[ 3 ] );
+	}
+	for( ; i < n; ++ i )
+		DotStep< Alg >( x[ i ], y[ i ], s[ 0 ], c[ 0 ] );
+	return SumLanes( s, c, 4 );
+}
+
+
+#if EM_X86_64
+
+// Four registers give 16 independent lanes - enough to hide the latency 
+// of the dependent additions in a step, so the loop runs at the speed of the memory
+template < EDotAlg Alg >
+EM_TARGET_AVX2 EMDotSum CompensatedDot_AVX2( Dim n, const DataType * x, const DataType * y )
+{
+	__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+	__m256d c0 = _mm256_setzero_pd(), c1 = _mm256_setzero_pd(), c2 = _mm256_setzero_pd(), c3 = _mm256_setzero_pd();
+	Dim i {};
+	for( ; i + 16 <= n; i += 16 )
+	{
+		DotStep_AVX2< Alg >( _mm256_loadu_pd( x + i ),		_mm256_loadu_pd( y + i ),		s0, c0 );
+		DotStep_AVX2< Alg >( _mm256_loadu_pd( x + i + 4 ),	_mm256_loadu_pd( y + i + 4 ),	s1, c1 );
+		DotStep_AVX2< Alg >( _mm256_loadu_pd( x + i + 8 ),	_mm256_loadu_pd( y + i + 8 ),	s2, c2 );
+		DotStep_AVX2< Alg >( _mm256_loadu_pd( x + i + 12 ),	_mm256_loadu_pd( y + i + 12 ),	s3, c3 );
+	}
+	for( ; i + 4 <= n; i += 4 )
+		DotStep_AVX2< Alg >( _mm256_loadu_pd( x + i ), _mm256_loadu_pd( y + i ), s0, c0 );
+
+	// The 16 lanes and one more for the tail
+	alignas( 32 ) DataType s[ 17 ] {}, c[ 17 ] {};
+	_mm256_store_pd( s, s0 );		_mm256_store_pd( c, c0 );
+	_mm256_store_pd( s + 4, s1 );	_mm256_store_pd( c + 4, c1 );
+	_mm256_store_pd( s + 8, s2 );	_mm256_store_pd( c + 8, c2 );
+	_mm256_store_pd( s + 12, s3 );	_mm256_store_pd( c + 12, c3 );
+
+	for( ; i < n; ++ i )
+		DotStep< Alg >( x[ i ], y[ i ], s[ 16 ], c[ 16 ] );
+
+	return SumLanes( s, c, 17 );
+}
+
+// 32 lanes; the zeros of the masked tail do not change the sums
+template < EDotAlg Alg >
+EM_TARGET_AVX512 EMDotSum CompensatedDot_AVX512( Dim n, const DataType * x, const DataType * y )
+{
+	__m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd(), s2 = _mm512_setzero_pd(), s3 = _mm512_setzero_pd();
+	__m512d c0 = _mm512_setzero_pd(), c1 = _mm512_setzero_pd(), c2 = _mm512_setzero_pd(), c3 = _mm512_setzero_pd();
+	Dim i {};
+	for( ; i + 32 <= n; i += 32 )
+	{
+		DotStep_AVX512< Alg >( _mm512_loadu_pd( x + i ),		_mm512_loadu_pd( y + i ),		s0, c0 );
+		DotStep_AVX512< Alg >( _mm512_loadu_pd( x + i + 8 ),	_mm512_loadu_pd( y + i + 8 ),	s1, c1 );
+		DotStep_AVX512< Alg >( _mm512_loadu_pd( x + i + 16 ),	_mm512_loadu_pd( y + i + 16 ),	s2, c2 );
+		DotStep_AVX512< Alg >( _mm512_loadu_pd( x + i + 24 ),	_mm512_loadu_pd( y + i + 24 ),	s3, c3 );
+	}
+	for( ; i + 8 <= n; i += 8 )
+		DotStep_AVX512< Alg >( _mm512_loadu_pd( x + i ), _mm512_loadu_pd( y + i ), s0, c0 );
+	if( i < n )
+	{
+		const __mmask8 m = TailMask( n - i );
+		DotStep_AVX512< Alg >( _mm512_maskz_loadu_pd( m, x + i ), _mm512_maskz_loadu_pd( m, y + i ), s1, c1 );
+	}
+
+	alignas( 64 ) DataType s[ 32 ], c[ 32 ];
+	_mm512_store_pd( s, s0 );		_mm512_store_pd( c, c0 );
+	_mm512_store_pd( s + 8, s1 );	_mm512_store_pd( c + 8, c1 );
+	_mm512_store_pd( s + 16, s2 );	_mm512_store_pd( c + 16, c2 );
+	_mm512_store_pd( s + 24, s3 );	_mm512_store_pd( c + 24, c3 );
+
+	return SumLanes( s, c, 32 );
+}
+
+#endif // EM_X86_64
+
+
+
+// The instances for the kernel tables in EMSimd.cpp
+
+template EMDotSum	CompensatedDot_Scalar< EDotAlg::kKahan >	( Dim n, const DataType * x, const DataType * y );
+template EMDotSum	CompensatedDot_Scalar< EDotAlg::kNeumaier >	( Dim n, const DataType * x, const DataType * y );
+template EMDotSum	CompensatedDot_Scalar< EDotAlg::kDot2 >		( Dim n, const DataType * x, const DataType * y );
+
+#if EM_X86_64
+template EMDotSum	CompensatedDot_AVX2< EDotAlg::kKahan >		( Dim n, const DataType * x, const DataType * y );
+template EMDotSum	CompensatedDot_AVX2< EDotAlg::kNeumaier >	( Dim n, const DataType * x, const DataType * y );
+template EMDotSum	CompensatedDot_AVX2< EDotAlg::kDot2 >		( Dim n, const DataType * x, const DataType * y );
+
+template EMDotSum	CompensatedDot_AVX512< EDotAlg::kKahan >	( Dim n, const DataType * x, const DataType * y );
+template EMDotSum	CompensatedDot_AVX512< EDotAlg::kNeumaier >	( Dim n, const DataType * x, const DataType * y );
+template EMDotSum	CompensatedDot_AVX512< EDotAlg::kDot2 >		( Dim n, const DataType * x, const DataType * y );
+#endif // EM_X86_64
+
+
@@ -0,0 +1,259 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+#include <algorithm>
+#include <omp.h>		// Header for OpenMP
+
+
+#include "EMGemm.h"
+#include "EMSimd.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// The blocked GEMM follows the well known Goto/BLIS scheme:
+//
+//	for jc - panels of kGemm_NC columns of B and C
+//		for pc - panels of kGemm_KC rows of B (cols of A)
+//			pack B panel (shared by all threads)
+//			for ic - blocks of kGemm_MC rows of A and C		<- parallel
+//				pack A block (each thread has its own)
+//				for jr - slivers of kGemm_NR columns
+//					for ir - slivers of kGemm_MR rows
+//						micro-kernel: kGemm_MR x kGemm_NR block of C
+//
+// Packing copies the operands into the exact order in which 
+// the micro-kernel reads them, so its loads are always unit-stride.
+
+
+namespace
+{
+
+	// The packing functions also convert the elements of A and B (S is double or float)
+	// to DataType, so the micro-kernel always accumulates in double precision.
+
+	// Packs an mc x kc block of A into slivers of kGemm_MR rows.
+	// Each sliver is stored column-by-column. Missing rows are zero padded.
+	template < typename S >
+	void PackA( Dim mc, Dim kc, const S * A, Dim lda, DataType * a_pack )
+	{
+		for( Dim i = 0; i < mc; i += kGemm_MR )
+		{
+			const Dim mr = std::min( kGemm_MR, mc - i );
+
+			for( Dim p = 0; p < kc; ++ p )
+			{
+				for( Dim r = 0; r < mr; ++ r )
+					* a_pack ++ = A[ ( i + r ) * lda + p ];
+
+				for( Dim r = mr; r < kGemm_MR; ++ r )
+					* a_pack ++ = 0.0;
+			}
+		}
+	}
+
+	// Packs one kc x nr sliver of B (nr <= kGemm_NR) row-by-row.
+	// Missing columns are zero padded.
+	template < typename S >
+	void PackB( Dim kc, Dim nr, const S * B, Dim ldb, DataType * b_pack )
+	{
+		for( Dim p = 0; p < kc; ++ p )
+		{
+			const S * b_row = B + p * ldb;
+
+			for( Dim c = 0; c < nr; ++ c )
+				* b_pack ++ = b_row[ c ];
+
+			for( Dim c = nr; c < kGemm_NR; ++ c )
+				* b_pack ++ = 0.0;
+		}
+	}
+
+	// The same as PackB, but the sliver is read from B^T, i.e. from nr rows 
+	// of kc elements. So the reads are unit-stride and the writes go to L1.
+	template < typename S >
+	void PackB_Trans( Dim kc, Dim nr, const S * Bt, Dim ldb, DataType * b_pack )
+	{
+		for( Dim c = 0; c < kGemm_NR; ++ c )
+		{
+			const S * bt_row = Bt + c * ldb;
+
+			for( Dim p = 0; p < kc; ++ p )
+				b_pack[ p * kGemm_NR + c ] = c < nr ? bt_row[ p ] : 0.0;
+		}
+	}
+
+
+	template < typename S >
+	void Gemm_Blocked_Impl(	Dim M, Dim N, Dim K, 
+							const S * A, Dim lda, 
+							const S * B, Dim ldb, 
+							DataType * C, Dim ldc, 
+							bool b_trans, bool parallel = true )
+	{
+		if( M == 0 || N == 0 || K == 0 )
+			return;
+
+		const Dim kc_max = std::min( kGemm_KC, K );
+		const Dim nc_max = std::min( kGemm_NC, ( N + kGemm_NR - 1 ) / kGemm_NR * kGemm_NR );
+
+		// The best micro-kernel for this CPU
+		const auto micro_kernel = GetKernels().MicroKernel;
+
+		// The panel of B is shared by all threads
+		auto b_pack_buf = EMatrix::AllocDataBuf( kc_max * nc_max );
+		DataType * b_pack = b_pack_buf.get();
+
+		#pragma omp parallel if( parallel ) shared( M, N, K, A, lda, B, ldb, C, ldc, b_trans, b_pack, kc_max, micro_kernel )
+		{
+			// Each thread packs its blocks of A into its own buffer
+			auto a_pack_buf = EMatrix::AllocDataBuf( kGemm_MC * kc_max );
+			DataType * a_pack = a_pack_buf.get();
+
+			for( Dim jc = 0; jc < N; jc += kGemm_NC )
+			{
+				const Dim nc = std::min( kGemm_NC, N - jc );
+				const Dim n_slivers = ( nc + kGemm_NR - 1 ) / kGemm_NR;
+
+				for( Dim pc = 0; pc < K; pc += kGemm_KC )
+				{
+					const Dim kc = std::min( kGemm_KC, K - pc );
+
+					// All threads cooperate in packing the panel of B
+					#pragma omp for schedule( static )
+					for( Dim s = 0; s < n_slivers; ++ s )
+					{
+						const Dim j = jc + s * kGemm_NR;
+						if( b_trans )
+							PackB_Trans( kc, std::min( kGemm_NR, nc - s * kGemm_NR ), B + j * ldb + pc, ldb, b_pack + s * kc * kGemm_NR );
+						else
+							PackB( kc, std::min( kGemm_NR, nc - s * kGemm_NR ), B + pc * ldb + j, ldb, b_pack + s * kc * kGemm_NR );
+					}
+					// Here is the barrier - the panel of B is ready
+
+					const Dim m_blocks = ( M + kGemm_MC - 1 ) / kGemm_MC;
+
+					// Macro-tiles of C (kGemm_MC x nc) go to the threads 
+					#pragma omp for schedule( dynamic )
+					for( Dim ib = 0; ib < m_blocks; ++ ib )
+					{
+						const Dim ic = ib * kGemm_MC;
+						const Dim mc = std::min( kGemm_MC, M - ic );
+
+						PackA( mc, kc, A + ic * lda + pc, lda, a_pack );
+
+						for( Dim s = 0; s < n_slivers; ++ s )
+						{
+							const Dim nr = std::min( kGemm_NR, nc - s * kGemm_NR );
+
+							for( Dim ir = 0; ir < mc; ir += kGemm_MR )
+								micro_kernel(	kc, a_pack + ir * kc, b_pack + s * kc * kGemm_NR, 
+												C + ( ic + ir ) * ldc + jc + s * kGemm_NR, ldc, 
+												std::min( kGemm_MR, mc - ir ), nr );
+						}
+					}
+					// Here is the barrier - the panel of B can be overwritten
+				}
+			}
+		}
+	}
+
+}
+
+
+
+void Gemm_Blocked(	Dim M, Dim N, Dim K, 
+					const DataType * A, Dim lda, 
+					const DataType * B, Dim ldb, 
+					DataType * C, Dim ldc, 
+					bool b_trans )
+{
+	Gemm_Blocked_Impl( M, N, K, A, lda, B, ldb, C, ldc, b_trans );
+}
+
+void Gemm_Tile(		Dim M, Dim N, Dim K, 
+					const DataType * A, Dim lda, 
+					const DataType * B, Dim ldb, 
+					DataType * C, Dim ldc )
+{
+	Gemm_Blocked_Impl( M, N, K, A, lda, B, ldb, C, ldc, false, false );
+}
+
+void Gemm_Blocked(	Dim M, Dim N, Dim K, 
+					const float * A, Dim lda, 
+					const float * B, Dim ldb, 
+					DataType * C, Dim ldc, 
+					bool b_trans )
+{
+	Gemm_Blocked_Impl( M, N, K, A, lda, B, ldb, C, ldc, b_trans );
+}
+
+
+
+// The cache-blocked multiplication with packed panels of a and b.
+// It can be used as follows: c = MultMatrix_Blocked( a, b );
+EMatrix		MultMatrix_Blocked( const EMatrix & a, const EMatrix & b )
+{
+	assert( a.GetCols() == b.GetRows() );			// Dimensions must be the same
+
+	EMatrix	c( a.GetRows(), b.GetCols(), 0.0 );	// Output matrix has these dimensions
+
+	Gemm_Blocked(	a.GetRows(), b.GetCols(), a.GetCols(), 
+					a.GetDataBuf(), a.GetLeadDim(), 
+					b.GetDataBuf(), b.GetLeadDim(), 
+					c.GetDataBuf(), c.GetLeadDim() );
+
+	return c;
+}
+
+
+
+// The same product with b given as its transposition.
+// It can be used as follows: c = MultMatrix_TransB( a, Transpose( b ) );
+EMatrix		MultMatrix_TransB( const EMatrix & a, const EMatrix & bt )
+{
+	assert( a.GetCols() == bt.GetCols() );			// Dimensions must be the same
+
+	EMatrix	c( a.GetRows(), bt.GetRows(), 0.0 );	// Output matrix has these dimensions
+
+	Gemm_Blocked(	a.GetRows(), bt.GetRows(), a.GetCols(), 
+					a.GetDataBuf(), a.GetLeadDim(), 
+					bt.GetDataBuf(), bt.GetLeadDim(), 
+					c.GetDataBuf(), c.GetLeadDim(), 
+					true );
+
+	return c;
+}
+
+
+
+// Float operands, double accumulators, float result.
+// It can be used as follows: c = MultMatrix_Mixed( a, b );
+EMatrixFor< float >		MultMatrix_Mixed( const EMatrixFor< float > & a, const EMatrixFor< float > & b )
+{
+	assert( a.GetCols() == b.GetRows() );			// Dimensions must be the same
+
+	EMatrix	c( a.GetRows(), b.GetCols(), 0.0 );	// Sums are kept in double
+
+	Gemm_Blocked(	a.GetRows(), b.GetCols(), a.GetCols(), 
+					a.GetDataBuf(), a.GetLeadDim(), 
+					b.GetDataBuf(), b.GetLeadDim(), 
+					c.GetDataBuf(), c.GetLeadDim() );
+
+	return EMatrixFor< float >( c );		// only the final values are rounded to float
+}
+
+
+
@@ -0,0 +1,107 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+
+
+#include <algorithm>
+#include <omp.h>		// Header for OpenMP
+
+
+#include "EMGemv.h"
+#include "EMSimd.h"
+
+
+
+
+// The partial vectors of Gemv_Trans are summed in chunks of that many elements
+constexpr Dim	kGemv_SumChunk { 1024 };
+
+
+
+void		Gemv( const EMatrix & a, const DataType * x, DataType * y )
+{
+	const Dim	rows = a.GetRows(), cols = a.GetCols(), ld = a.GetLeadDim();
+	const DataType *	A = a.GetDataBuf();
+
+	const auto dot = GetKernels().Dot;
+
+	#pragma omp parallel for \
+				shared( rows, cols, ld, A, x, y, dot ) \
+				default( none ) \
+				schedule( static )
+	for( Dim r = 0; r < rows; ++ r )
+		y[ r ] = dot( cols, A + r * ld, x );
+}
+
+
+void		Gemv_Trans( const EMatrix & a, const DataType * x, DataType * y )
+{
+	const Dim	rows = a.GetRows(), cols = a.GetCols(), ld = a.GetLeadDim();
+	const DataType *	A = a.GetDataBuf();
+
+	const auto axpy = GetKernels().Axpy;
+
+	// A row of partial sums for each thread, all zeros
+	const int	threads = omp_get_max_threads();
+	EMatrix		partial( threads, cols );
+
+	DataType *	P = partial.GetDataBuf();
+	const Dim	p_ld = partial.GetLeadDim();
+
+	const Dim	chunks = ( cols + kGemv_SumChunk - 1 ) / kGemv_SumChunk;
+
+	#pragma omp parallel num_threads( threads ) shared( rows, cols, ld, A, x, y, axpy, threads, P, p_ld, chunks )
+	{
+		DataType * my_y = P + omp_get_thread_num() * p_ld;
+
+		#pragma omp for schedule( static )
+		for( Dim r = 0; r < rows; ++ r )
+			axpy( cols, x[ r ], A + r * ld, my_y );
+		// Here is the barrier - all partial sums are ready
+
+		#pragma omp for schedule( static )
+		for( Dim ch = 0; ch < chunks; ++ ch )
+		{
+			const Dim c0 = ch * kGemv_SumChunk;
+			const Dim cn = std::min( kGemv_SumChunk, cols - c0 );
+
+			std::copy_n( P + c0, cn, y + c0 );
+			for( int t = 1; t < threads; ++ t )
+				axpy( cn, 1.0, P + t * p_ld + c0, y + c0 );
+		}
+	}
+}
+
+
+RealVec		MultMatrixVector( const EMatrix & a, const RealVec & x )
+{
+	assert( x.size() == a.GetCols() );
+
+	RealVec	y( a.GetRows() );
+	Gemv( a, x.data(), y.data() );
+	return y;
+}
+
+
+RealVec		MultMatrixVector_Trans( const EMatrix & a, const RealVec & x )
+{
+	assert( x.size() == a.GetRows() );
+
+	RealVec	y( a.GetCols() );
+	Gemv_Trans( a, x.data(), y.data() );
+	return y;
+}
+
+
+
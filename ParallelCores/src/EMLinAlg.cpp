@@ -0,0 +1,454 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+
+
+#include <algorithm>
+#include <cmath>
+#include <omp.h>		// Header for OpenMP
+
+
+#include "EMLinAlg.h"
+#include "EMGemm.h"
+
+
+
+
+namespace
+{
+
+	// Columns of the right-hand sides are solved in chunks of this width in parallel
+	constexpr Dim	kSolve_Chunk { 64 };
+
+
+	// y[ 0, n ) -= alpha * x[ 0, n )
+	inline void SubScaled( Dim n, DataType alpha, const DataType * x, DataType * y )
+	{
+		for( Dim i = 0; i < n; ++ i )
+			y[ i ] -= alpha * x[ i ];
+	}
+
+
+	// -----------------------------------------------
+	// LU
+
+	// Unblocked LU of the panel of columns [ k0, k0 + kb ) and rows [ k0, n ).
+	// Rows are swapped only inside the panel, the other columns are done later.
+	// Returns false if a zero pivot was found.
+	bool LU_Panel( Dim n, Dim k0, Dim kb, DataType * A, Dim ld, Dim * piv )
+	{
+		bool nonsingular { true };
+
+		for( Dim c = k0; c < k0 + kb; ++ c )
+		{
+			// Partial pivoting - the largest element in column c
+			Dim			p = c;
+			DataType	max_val = std::fabs( A[ c * ld + c ] );
+			for( Dim r = c + 1; r < n; ++ r )
+				if( std::fabs( A[ r * ld + c ] ) > max_val )
+				{
+					max_val = std::fabs( A[ r * ld + c ] );
+					p = r;
+				}
+
+			piv[ c ] = p;
+
+			if( max_val == 0.0 )
+			{
+				nonsingular = false;	// nothing to eliminate in this column
+				continue;
+			}
+
+			if( p != c )
+				std::swap_ranges( A + c * ld + k0, A + c * ld + k0 + kb, A + p * ld + k0 );
+
+			const DataType			inv_pivot = 1.0 / A[ c * ld + c ];
+			const DataType *		c_row = A + c * ld;
+			const Dim				rest = k0 + kb - c - 1;		// columns to the right of c in the panel
+
+			for( Dim r = c + 1; r < n; ++ r )
+			{
+				DataType * r_row = A + r * ld;
+				r_row[ c ] *= inv_pivot;
+				SubScaled( rest, r_row[ c ], c_row + c + 1, r_row + c + 1 );
+			}
+		}
+
+		return nonsingular;
+	}
+
+	// Updates the column block [ j0, j0 + jb ) after the panel k:
+	// the row swaps, U_kj = L_kk^-1 * A_kj, and A_ij -= L_ik * U_kj below.
+	void LU_UpdateBlock( Dim n, Dim k0, Dim kb, Dim j0, Dim jb, DataType * A, Dim ld, const Dim * piv )
+	{
+		for( Dim i = k0; i < k0 + kb; ++ i )
+			if( piv[ i ] != i )
+				std::swap_ranges( A + i * ld + j0, A + i * ld + j0 + jb, A + piv[ i ] * ld + j0 );
+
+		// The forward substitution with the unit lower triangle of the panel
+		for( Dim i = k0 + 1; i < k0 + kb; ++ i )
+			for( Dim p = k0; p < i; ++ p )
+				SubScaled( jb, A[ i * ld + p ], A + p * ld + j0, A + i * ld + j0 );
+
+		const Dim below = k0 + kb;
+		if( below == n )
+			return;
+
+		// Gemm_Blocked adds, so it gets - U_kj
+		auto neg_u_buf = EMatrix::AllocDataBuf( kb * jb );
+		DataType * neg_u = neg_u_buf.get();
+		for( Dim i = 0; i < kb; ++ i )
+			for( Dim c = 0; c < jb; ++ c )
+				neg_u[ i * jb + c ] = - A[ ( k0 + i ) * ld + j0 + c ];
+
+		Gemm_Blocked(	n - below, jb, kb, 
+						A + below * ld + k0, ld, 
+						neg_u, jb, 
+						A + below * ld + j0, ld );
+	}
+
+
+	// -----------------------------------------------
+	// Cholesky
+
+	// Unblocked Cholesky of the panel of columns [ k0, k0 + kb ) and rows [ k0, n ).
+	// Column c of L is computed from its columns [ k0, c ), which are already done.
+	// Returns false if the matrix is not positive definite.
+	bool Chol_Panel( Dim n, Dim k0, Dim kb, DataType * A, Dim ld )
+	{
+		for( Dim c = k0; c < k0 + kb; ++ c )
+		{
+			const DataType * c_row = A + c * ld;
+
+			DataType d = c_row[ c ];
+			for( Dim p = k0; p < c; ++ p )
+				d -= c_row[ p ] * c_row[ p ];
+
+			if( ! ( d > 0.0 ) )
+				return false;
+
+			const DataType l_cc = std::sqrt( d );
+			A[ c * ld + c ] = l_cc;
+
+			for( Dim r = c + 1; r < n; ++ r )
+			{
+				DataType * r_row = A + r * ld;
+
+				DataType s = r_row[ c ];
+				for( Dim p = k0; p < c; ++ p )
+					s -= r_row[ p ] * c_row[ p ];
+
+				r_row[ c ] = s / l_cc;
+			}
+		}
+
+		return true;
+	}
+
+	// A_ij -= L_ik * L_jk^T for the column block [ j0, j0 + jb ), rows from j0 down.
+	// The transposed GEMM reads L_jk row-by-row.
+	void Chol_UpdateBlock( Dim n, Dim k0, Dim kb, Dim j0, Dim jb, DataType * A, Dim ld )
+	{
+		auto neg_l_buf = EMatrix::AllocDataBuf( jb * kb );
+		DataType * neg_l = neg_l_buf.get();
+		for( Dim i = 0; i < jb; ++ i )
+			for( Dim c = 0; c < kb; ++ c )
+				neg_l[ i * kb + c ] = - A[ ( j0 + i ) * ld + k0 + c ];
+
+		Gemm_Blocked(	n - j0, jb, kb, 
+						A + j0 * ld + k0, ld, 
+						neg_l, kb, 
+						A + j0 * ld + j0, ld, 
+						true );
+	}
+
+
+	// Runs panel( k0, kb ) and then update( k0, kb, j0, jb ) for all column blocks j > k
+	// as OpenMP tasks. An update waits only for its panel and the previous update of its block.
+	// Returns false if any of the panels returned false.
+	template < typename Panel, typename Update >
+	bool RightLookingTasks( Dim n, Panel panel, Update update )
+	{
+		const Dim nt = ( n + kLinAlg_Block - 1 ) / kLinAlg_Block;
+
+		std::vector< char >		panel_ok( nt, 1 );
+		std::vector< char >		col_blocks( nt );		// only their addresses are used
+		char *					dep = col_blocks.data();
+
+		#pragma omp parallel shared( n, nt, panel, update, panel_ok, dep )
+		#pragma omp single
+		for( Dim k = 0; k < nt; ++ k )
+		{
+			const Dim k0 = k * kLinAlg_Block;
+			const Dim kb = std::min( kLinAlg_Block, n - k0 );
+
+			#pragma omp task depend( inout: dep[ k ] )
+			panel_ok[ k ] = panel( k0, kb );
+
+			for( Dim j = k + 1; j < nt; ++ j )
+			{
+				const Dim j0 = j * kLinAlg_Block;
+				const Dim jb = std::min( kLinAlg_Block, n - j0 );
+
+				#pragma omp task depend( in: dep[ k ] ) depend( inout: dep[ j ] )
+				update( k0, kb, j0, jb );
+			}
+		}
+		// All tasks are done at the barrier
+
+		return std::all_of( panel_ok.begin(), panel_ok.end(), [] ( char ok ) { return ok != 0; } );
+	}
+
+
+	// -----------------------------------------------
+	// Triangular solves on the columns [ c0, c1 ) of x.
+	// x is the buffer of a matrix with the leading dimension ldx - it is taken 
+	// once before the parallel loop, so a copy-on-write x is made unique only once.
+
+	// L * y = x, L is lower triangular, the solution overwrites x
+	void ForwardSubst( const EMatrix & L, bool unit_diag, DataType * x, Dim ldx, Dim c0, Dim c1 )
+	{
+		for( Dim i = 0; i < L.GetRows(); ++ i )
+		{
+			DataType *			x_i = x + i * ldx;
+			const DataType *	L_i = L.GetDataBuf() + i * L.GetLeadDim();
+
+			for( Dim k = 0; k < i; ++ k )
+				SubScaled( c1 - c0, L_i[ k ], x + k * ldx + c0, x_i + c0 );
+
+			if( ! unit_diag )
+				for( Dim c = c0; c < c1; ++ c )
+					x_i[ c ] /= L_i[ i ];
+		}
+	}
+
+	// U * y = x, U is upper triangular, the solution overwrites x
+	void BackSubst( const EMatrix & U, DataType * x, Dim ldx, Dim c0, Dim c1 )
+	{
+		for( Dim i = U.GetRows(); i -- > 0; )
+		{
+			DataType *			x_i = x + i * ldx;
+			const DataType *	U_i = U.GetDataBuf() + i * U.GetLeadDim();
+
+			for( Dim k = i + 1; k < U.GetRows(); ++ k )
+				SubScaled( c1 - c0, U_i[ k ], x + k * ldx + c0, x_i + c0 );
+
+			for( Dim c = c0; c < c1; ++ c )
+				x_i[ c ] /= U_i[ i ];
+		}
+	}
+
+	// L^T * y = x, L is lower triangular. Row i of L is column i of L^T,
+	// so once x_i is known it is subtracted from all the rows above.
+	void BackSubst_Trans( const EMatrix & L, DataType * x, Dim ldx, Dim c0, Dim c1 )
+	{
+		for( Dim i = L.GetRows(); i -- > 0; )
+		{
+			DataType *			x_i = x + i * ldx;
+			const DataType *	L_i = L.GetDataBuf() + i * L.GetLeadDim();
+
+			for( Dim c = c0; c < c1; ++ c )
+				x_i[ c ] /= L_i[ i ];
+
+			for( Dim k = 0; k < i; ++ k )
+				SubScaled( c1 - c0, L_i[ k ], x_i + c0, x + k * ldx + c0 );
+		}
+	}
+
+	// Calls solve( c0, c1 ) for chunks of columns of x in parallel
+	template < typename Solver >
+	void SolveColumnChunks( Dim cols, Solver solve )
+	{
+		const Dim chunks = ( cols + kSolve_Chunk - 1 ) / kSolve_Chunk;
+
+		#pragma omp parallel for schedule( dynamic ) if( chunks > 1 )
+		for( Dim ch = 0; ch < chunks; ++ ch )
+			solve( ch * kSolve_Chunk, std::min( cols, ( ch + 1 ) * kSolve_Chunk ) );
+	}
+
+	EMatrix Identity( Dim n )
+	{
+		EMatrix	e( n, n, 0.0 );
+		for( Dim i = 0; i < n; ++ i )
+			e[ i ][ i ] = 1.0;
+		return e;
+	}
+
+}
+
+
+
+// ------------------------------------------------------------------------
+// EMLU
+
+
+
+EMLU::EMLU( const EMatrix & a )
+	: fLU( a ), fPivots( a.GetRows() )
+{
+	assert( a.GetRows() == a.GetCols() );		// only square matrices
+
+	const Dim	n = fLU.GetRows();
+	const Dim	ld = fLU.GetLeadDim();
+	DataType *	A = fLU.GetDataBuf();
+	Dim *		piv = fPivots.data();
+
+	fSingular = ! RightLookingTasks( n, 
+					[ = ] ( Dim k0, Dim kb ) { return LU_Panel( n, k0, kb, A, ld, piv ); }, 
+					[ = ] ( Dim k0, Dim kb, Dim j0, Dim jb ) { LU_UpdateBlock( n, k0, kb, j0, jb, A, ld, piv ); } );
+
+	// The columns of L to the left of each panel still need
+	// the row swaps of all the later panels (in their order)
+	const Dim nt = ( n + kLinAlg_Block - 1 ) / kLinAlg_Block;
+
+	#pragma omp parallel for schedule( dynamic )
+	for( Dim j = 0; j < nt; ++ j )
+	{
+		const Dim j0 = j * kLinAlg_Block;
+		const Dim jb = std::min( kLinAlg_Block, n - j0 );
+
+		for( Dim i = j0 + jb; i < n; ++ i )
+			if( piv[ i ] != i )
+				std::swap_ranges( A + i * ld + j0, A + i * ld + j0 + jb, A + piv[ i ] * ld + j0 );
+	}
+
+	for( Dim i = 0; i < n; ++ i )
+		if( fPivots[ i ] != i )
+			fPermSign = - fPermSign;
+}
+
+
+EMatrix		EMLU::Solve( const EMatrix & b ) const
+{
+	assert( b.GetRows() == fLU.GetRows() );
+	assert( ! fSingular );
+
+	// x = P * b
+	EMatrix	x( b );
+	x.MakeUnique();		// x may share the buffer of a copy-on-write b
+	DataType * const	x_data = x.GetDataBuf();
+	const Dim			ldx = x.GetLeadDim();
+
+	for( Dim i = 0; i < fPivots.size(); ++ i )
+		if( fPivots[ i ] != i )
+			std::swap_ranges( x[ i ].begin(), x[ i ].end(), x[ fPivots[ i ] ].begin() );
+
+	SolveColumnChunks( x.GetCols(), [ & ] ( Dim c0, Dim c1 )
+	{
+		ForwardSubst( fLU, true, x_data, ldx, c0, c1 );
+		BackSubst( fLU, x_data, ldx, c0, c1 );
+	} );
+
+	return x;
+}
+
+
+DataType	EMLU::Determinant( void ) const
+{
+	DataType det = fPermSign;
+	for( Dim i = 0; i < fLU.GetRows(); ++ i )
+		det *= fLU[ i ][ i ];
+	return det;
+}
+
+
+EMatrix		EMLU::Inverse( void ) const
+{
+	return Solve( Identity( fLU.GetRows() ) );
+}
+
+
+
+// ------------------------------------------------------------------------
+// EMCholesky
+
+
+
+EMCholesky::EMCholesky( const EMatrix & a )
+	: fL( a )
+{
+	assert( a.GetRows() == a.GetCols() );		// only square matrices
+
+	const Dim	n = fL.GetRows();
+	const Dim	ld = fL.GetLeadDim();
+	DataType *	A = fL.GetDataBuf();
+
+	fPosDef = RightLookingTasks( n, 
+					[ = ] ( Dim k0, Dim kb ) { return Chol_Panel( n, k0, kb, A, ld ); }, 
+					[ = ] ( Dim k0, Dim kb, Dim j0, Dim jb ) { Chol_UpdateBlock( n, k0, kb, j0, jb, A, ld ); } );
+
+	// The upper triangle was only used as a workspace
+	for( Dim r = 0; r < n; ++ r )
+		std::fill( A + r * ld + r + 1, A + r * ld + n, 0.0 );
+}
+
+
+EMatrix		EMCholesky::Solve( const EMatrix & b ) const
+{
+	assert( b.GetRows() == fL.GetRows() );
+	assert( fPosDef );
+
+	EMatrix	x( b );
+
+	x.MakeUnique();		// x may share the buffer of a copy-on-write b
+	DataType * const	x_data = x.GetDataBuf();
+	const Dim			ldx = x.GetLeadDim();
+
+	SolveColumnChunks( x.GetCols(), [ & ] ( Dim c0, Dim c1 )
+	{
+		ForwardSubst( fL, false, x_data, ldx, c0, c1 );
+		BackSubst_Trans( fL, x_data, ldx, c0, c1 );
+	} );
+
+	return x;
+}
+
+
+DataType	EMCholesky::Determinant( void ) const
+{
+	DataType det = 1.0;
+	for( Dim i = 0; i < fL.GetRows(); ++ i )
+		det *= fL[ i ][ i ];
+	return det * det;
+}
+
+
+EMatrix		EMCholesky::Inverse( void ) const
+{
+	return Solve( Identity( fL.GetRows() ) );
+}
+
+
+
+// ------------------------------------------------------------------------
+
+
+
+EMatrix		Solve( const EMatrix & a, const EMatrix & b )
+{
+	return EMLU( a ).Solve( b );
+}
+
+DataType	Determinant( const EMatrix & a )
+{
+	return EMLU( a ).Determinant();
+}
+
+EMatrix		Inverse( const EMatrix & a )
+{
+	return EMLU( a ).Inverse();
+}
+
+
+
@@ -0,0 +1,436 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <future>
+#include <omp.h>		// Header for OpenMP
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+
+#include "EMOutOfCore.h"
+#include "EMGemm.h"
+#include "EMThreadPool.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// EMTiledFile
+
+
+bool	EMTiledFile::Create( const std::string & file_name, Dim rows, Dim cols, Dim tile )
+{
+	Close();
+
+	assert( tile > 0 );
+
+	fHeader = EMTiledHeader();
+	std::memcpy( fHeader.fMagic, EMTiledHeader::kMagic, sizeof( fHeader.fMagic ) );
+	fHeader.fVersion	= EMTiledHeader::kVersion;
+	fHeader.fHeaderSize	= sizeof( EMTiledHeader );
+	fHeader.fRows		= rows;
+	fHeader.fCols		= cols;
+	fHeader.fTile		= tile;
+
+	const std::uint64_t	file_size = GetTileOffset( GetTileRows(), 0 );		// just after the last tile
+
+	// The tiles are all zeros until written
+#ifdef _WIN32
+	HANDLE file = CreateFileA( file_name.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if( file == INVALID_HANDLE_VALUE )
+		return false;
+	fFileHandle = file;
+
+	LARGE_INTEGER	size {};
+	size.QuadPart = static_cast< LONGLONG >( file_size );
+	bool ok = SetFilePointerEx( file, size, nullptr, FILE_BEGIN ) && SetEndOfFile( file );
+#else
+	fFile = open( file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+	if( fFile < 0 )
+		return false;
+
+	bool ok = ftruncate( fFile, static_cast< off_t >( file_size ) ) == 0;
+#endif
+
+	ok = ok && WriteAt( & fHeader, sizeof( fHeader ), 0 );
+
+	if( ! ok )
+		Close();
+
+	return ok;
+}
+
+
+bool	EMTiledFile::Open( const std::string & file_name, bool writable )
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA( file_name.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if( file == INVALID_HANDLE_VALUE )
+		return false;
+	fFileHandle = file;
+#else
+	fFile = open( file_name.c_str(), writable ? O_RDWR : O_RDONLY );
+	if( fFile < 0 )
+		return false;
+#endif
+
+	const bool ok =	ReadAt( & fHeader, sizeof( fHeader ), 0 )
+					&& std::memcmp( fHeader.fMagic, EMTiledHeader::kMagic, sizeof( fHeader.fMagic ) ) == 0
+					&& fHeader.fVersion == EMTiledHeader::kVersion
+					&& fHeader.fHeaderSize >= sizeof( EMTiledHeader )
+					&& fHeader.fTile > 0;
+
+	if( ! ok )
+		Close();
+
+	return ok;
+}
+
+
+void	EMTiledFile::Close( void )
+{
+#ifdef _WIN32
+	if( fFileHandle != nullptr )
+		CloseHandle( fFileHandle );
+	fFileHandle = nullptr;
+#else
+	if( fFile >= 0 )
+		close( fFile );
+	fFile = -1;
+#endif
+
+	fHeader = EMTiledHeader();
+}
+
+
+bool	EMTiledFile::IsOpen( void ) const
+{
+#ifdef _WIN32
+	return fFileHandle != nullptr;
+#else
+	return fFile >= 0;
+#endif
+}
+
+
+// The system calls can transfer less than asked, so they are repeated
+bool	EMTiledFile::ReadAt( void * buf, std::size_t bytes, std::uint64_t offset ) const
+{
+	char * p = static_cast< char * >( buf );
+
+	while( bytes > 0 )
+	{
+#ifdef _WIN32
+		OVERLAPPED	ov {};
+		ov.Offset		= static_cast< DWORD >( offset );
+		ov.OffsetHigh	= static_cast< DWORD >( offset >> 32 );
+
+		DWORD done {};
+		if( ! ReadFile( fFileHandle, p, static_cast< DWORD >( std::min< std::size_t >( bytes, 1 << 30 ) ), & done, & ov ) || done == 0 )
+			return false;
+#else
+		const ssize_t done = pread( fFile, p, bytes, static_cast< off_t >( offset ) );
+		if( done <= 0 )
+			return false;
+#endif
+
+		p		+= done;
+		bytes	-= static_cast< std::size_t >( done );
+		offset	+= static_cast< std::uint64_t >( done );
+	}
+
+	return true;
+}
+
+
+bool	EMTiledFile::WriteAt( const void * buf, std::size_t bytes, std::uint64_t offset )
+{
+	const char * p = static_cast< const char * >( buf );
+
+	while( bytes > 0 )
+	{
+#ifdef _WIN32
+		OVERLAPPED	ov {};
+		ov.Offset		= static_cast< DWORD >( offset );
+		ov.OffsetHigh	= static_cast< DWORD >( offset >> 32 );
+
+		DWORD done {};
+		if( ! WriteFile( fFileHandle, p, static_cast< DWORD >( std::min< std::size_t >( bytes, 1 << 30 ) ), & done, & ov ) || done == 0 )
+			return false;
+#else
+		const ssize_t done = pwrite( fFile, p, bytes, static_cast< off_t >( offset ) );
+		if( done <= 0 )
+			return false;
+#endif
+
+		p		+= done;
+		bytes	-= static_cast< std::size_t >( done );
+		offset	+= static_cast< std::uint64_t >( done );
+	}
+
+	return true;
+}
+
+
+bool	EMTiledFile::ReadTile( Dim ti, Dim tj, DataType * buf ) const
+{
+	assert( IsOpen() && ti < GetTileRows() && tj < GetTileCols() );
+	return ReadAt( buf, GetTileBytes(), GetTileOffset( ti, tj ) );
+}
+
+
+bool	EMTiledFile::WriteTile( Dim ti, Dim tj, const DataType * buf )
+{
+	assert( IsOpen() && ti < GetTileRows() && tj < GetTileCols() );
+	return WriteAt( buf, GetTileBytes(), GetTileOffset( ti, tj ) );
+}
+
+
+
+// ------------------------------------------------------------------------
+// Whole matrices
+
+
+bool	WriteTiled( const EMatrix & m, const std::string & file_name, Dim tile )
+{
+	EMTiledFile		file;
+	if( ! file.Create( file_name, m.GetRows(), m.GetCols(), tile ) )
+		return false;
+
+	RealVec		buf( tile * tile );
+
+	for( Dim ti = 0; ti < file.GetTileRows(); ++ ti )
+	{
+		for( Dim tj = 0; tj < file.GetTileCols(); ++ tj )
+		{
+			const Dim r0 = ti * tile, c0 = tj * tile;
+			const Dim rows = std::min( tile, m.GetRows() - r0 ), cols = std::min( tile, m.GetCols() - c0 );
+
+			std::fill( buf.begin(), buf.end(), 0.0 );		// the padding
+			for( Dim r = 0; r < rows; ++ r )
+				std::copy_n( m.GetDataBuf() + ( r0 + r ) * m.GetLeadDim() + c0, cols, buf.data() + r * tile );
+
+			if( ! file.WriteTile( ti, tj, buf.data() ) )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+
+bool	ReadTiled( EMatrix & m, const std::string & file_name )
+{
+	EMTiledFile		file;
+	if( ! file.Open( file_name ) )
+		return false;
+
+	const Dim	tile = file.GetTile();
+	EMatrix		tmp( file.GetRows(), file.GetCols() );
+	RealVec		buf( tile * tile );
+
+	for( Dim ti = 0; ti < file.GetTileRows(); ++ ti )
+	{
+		for( Dim tj = 0; tj < file.GetTileCols(); ++ tj )
+		{
+			if( ! file.ReadTile( ti, tj, buf.data() ) )
+				return false;
+
+			const Dim r0 = ti * tile, c0 = tj * tile;
+			const Dim rows = std::min( tile, tmp.GetRows() - r0 ), cols = std::min( tile, tmp.GetCols() - c0 );
+
+			for( Dim r = 0; r < rows; ++ r )
+				std::copy_n( buf.data() + r * tile, cols, tmp.GetDataBuf() + ( r0 + r ) * tmp.GetLeadDim() + c0 );
+		}
+	}
+
+	m = std::move( tmp );
+	return true;
+}
+
+
+
+// ------------------------------------------------------------------------
+// The out-of-core product
+
+
+namespace
+{
+
+	// The panel of p x q tiles of C needs p * q tiles, the two buffers of A and B 
+	// 2 * ( p + q ) tiles, and one tile is for writing C. Of all p, q that fit into 
+	// budget_tiles, returns those that read the least of A and B from the disk.
+	// A is read once for each column of panels, B once for each row of panels.
+	std::pair< Dim, Dim >	ChoosePanel( Dim budget_tiles, Dim m_tiles, Dim n_tiles, Dim k_tiles )
+	{
+		std::pair< Dim, Dim >	best { 0, 0 };
+		double					best_reads {};
+
+		// With q == 1 there are p + 2 * ( p + 1 ) + 1 tiles
+		for( Dim p = 1; p <= m_tiles && 3 * p + 3 <= budget_tiles; ++ p )
+		{
+			const Dim q = std::min( n_tiles, ( budget_tiles - 1 - 2 * p ) / ( p + 2 ) );
+
+			const double reads =	double( m_tiles ) * k_tiles * ( ( n_tiles + q - 1 ) / q ) 
+								+	double( n_tiles ) * k_tiles * ( ( m_tiles + p - 1 ) / p );
+
+			if( best.first == 0 || reads < best_reads )
+			{
+				best = { p, q };
+				best_reads = reads;
+			}
+		}
+
+		return best;
+	}
+
+}
+
+
+
+bool	MultMatrix_OutOfCore(	const std::string & a_file, const std::string & b_file, const std::string & c_file, 
+								std::size_t memory_budget, EMOutOfCoreStats * stats )
+{
+	const auto start_time = omp_get_wtime();
+
+	EMTiledFile		A, B, C;
+	if( ! A.Open( a_file ) || ! B.Open( b_file ) )
+		return false;
+
+	if( A.GetCols() != B.GetRows() || A.GetTile() != B.GetTile() )
+		return false;
+
+	const Dim	t = A.GetTile();
+	const Dim	tile_elems = t * t;
+	const Dim	m_tiles = A.GetTileRows(), n_tiles = B.GetTileCols(), k_tiles = A.GetTileCols();
+
+	// The GEMM of a step packs a kc x nc panel of B, and each thread
+	// a kGemm_MC x kc block of A (see EMGemm.cpp). The budget must hold them too.
+	const Dim			kc = std::min( kGemm_KC, t ), nc = std::min( kGemm_NC, ( t + kGemm_NR - 1 ) / kGemm_NR * kGemm_NR );
+	const std::size_t	pack_bytes = ( kc * nc + kGemm_MC * kc * Dim( omp_get_max_threads() ) ) * sizeof( DataType );
+	if( memory_budget <= pack_bytes )
+		return false;
+
+	// Plain names, since lambdas cannot capture structured bindings in C++17
+	const auto	panel_size = ChoosePanel( ( memory_budget - pack_bytes ) / A.GetTileBytes(), m_tiles, n_tiles, k_tiles );
+	const Dim	p = panel_size.first, q = panel_size.second;
+	if( p == 0 )
+		return false;		// not even 6 tiles fit
+
+	if( ! C.Create( c_file, A.GetRows(), B.GetCols(), t ) )
+		return false;
+
+	EMOutOfCoreStats	st;
+	st.fPanelTileRows = p;
+	st.fPanelTileCols = q;
+
+	// The panel of C is a ( p * t ) x ( q * t ) matrix. 
+	// A column of p tiles of A, one below the other, is a ( p * t ) x t matrix.
+	// The q tiles of B are kept one after the other, each is t x t.
+	EMatrix		c_panel( p * t, q * t );
+	RealVec		a_buf[ 2 ] { RealVec( p * tile_elems ), RealVec( p * tile_elems ) };
+	RealVec		b_buf[ 2 ] { RealVec( q * tile_elems ), RealVec( q * tile_elems ) };
+	RealVec		c_tile( tile_elems );
+
+	// All steps ( panel, k ), in the order of computation
+	const Dim	panel_rows = ( m_tiles + p - 1 ) / p, panel_cols = ( n_tiles + q - 1 ) / q;
+	const Dim	num_of_steps = panel_rows * panel_cols * k_tiles;
+
+	// The tiles of A and B for step s go to the buffers s % 2
+	auto load_step = [ & ] ( Dim s ) 
+	{
+		const Dim	k = s % k_tiles, panel = s / k_tiles;
+		const Dim	ti0 = panel / panel_cols * p, tj0 = panel % panel_cols * q;
+		const Dim	pp = std::min( p, m_tiles - ti0 ), qq = std::min( q, n_tiles - tj0 );
+
+		bool ok { true };
+		for( Dim i = 0; i < pp && ok; ++ i )
+			ok = A.ReadTile( ti0 + i, k, a_buf[ s % 2 ].data() + i * tile_elems );
+		for( Dim j = 0; j < qq && ok; ++ j )
+			ok = B.ReadTile( k, tj0 + j, b_buf[ s % 2 ].data() + j * tile_elems );
+		return ok;
+	};
+
+	EMThreadPool &		pool = EMThreadPool::GetDefault();
+	std::future< bool >	next_load = pool.Submit( [ & ] { return load_step( 0 ); } );
+
+	bool ok { true };
+
+	for( Dim s = 0; s < num_of_steps && ok; ++ s )
+	{
+		const Dim	k = s % k_tiles, panel = s / k_tiles;
+		const Dim	ti0 = panel / panel_cols * p, tj0 = panel % panel_cols * q;
+		const Dim	pp = std::min( p, m_tiles - ti0 ), qq = std::min( q, n_tiles - tj0 );
+
+		const auto wait_time = omp_get_wtime();
+		ok = next_load.get();
+		st.fLoadWaitSeconds += omp_get_wtime() - wait_time;
+		if( ! ok )
+			break;
+
+		st.fBytesRead += ( pp + qq ) * A.GetTileBytes();
+
+		// The other buffers are free now - start reading the next tiles
+		if( s + 1 < num_of_steps )
+			next_load = pool.Submit( [ & load_step, s ] { return load_step( s + 1 ); } );
+
+		if( k == 0 )
+			for( Dim r = 0; r < c_panel.GetRows(); ++ r )
+				std::fill( c_panel[ r ].begin(), c_panel[ r ].end(), 0.0 );
+
+		// C_panel( :, j ) += A_column * B_tile( j ), with all cores
+		for( Dim j = 0; j < qq; ++ j )
+			Gemm_Blocked(	pp * t, t, t, 
+							a_buf[ s % 2 ].data(), t, 
+							b_buf[ s % 2 ].data() + j * tile_elems, t, 
+							c_panel.GetDataBuf() + j * t, c_panel.GetLeadDim() );
+
+		// The panel is ready after the last k
+		if( k + 1 == k_tiles )
+		{
+			for( Dim i = 0; i < pp && ok; ++ i )
+			{
+				for( Dim j = 0; j < qq && ok; ++ j )
+				{
+					for( Dim r = 0; r < t; ++ r )
+						std::copy_n( c_panel.GetDataBuf() + ( i * t + r ) * c_panel.GetLeadDim() + j * t, t, c_tile.data() + r * t );
+
+					ok = C.WriteTile( ti0 + i, tj0 + j, c_tile.data() );
+					st.fBytesWritten += C.GetTileBytes();
+				}
+			}
+		}
+	}
+
+	// The buffers must not be released while a read is still running
+	if( next_load.valid() )
+		next_load.wait();
+
+	st.fSeconds = omp_get_wtime() - start_time;
+	if( stats != nullptr )
+		* stats = st;
+
+	return ok;
+}
+
+
@@ -0,0 +1,265 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#include <iomanip>
+#include <omp.h>		// Header for OpenMP
+
+#if defined( __linux__ )
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+	#include <cstring>
+	#include <filesystem>
+#endif
+
+
+#include "EMPerf.h"
+#include "EMThreadPool.h"
+
+
+
+
+const std::array< const char *, kPerfEvents >	kPerfEventNames { "cycles", "instr", "L1D-miss", "LLC-miss", "br-miss" };
+
+
+
+namespace
+{
+
+	// The file descriptors of the counters of one thread, -1 if not open
+	using PerfFds = std::array< int, kPerfEvents >;
+
+	constexpr PerfFds	kNoFds { -1, -1, -1, -1, -1 };
+
+
+#if defined( __linux__ )
+
+	// Opens a disabled counter of the thread tid (0 is the calling thread) on any CPU, 
+	// only for the user space
+	int OpenCounter( EPerfEvent e, pid_t tid )
+	{
+		perf_event_attr		attr;
+		std::memset( & attr, 0, sizeof( attr ) );
+		attr.size			= sizeof( attr );
+		attr.disabled		= 1;
+		attr.exclude_kernel	= 1;
+		attr.exclude_hv		= 1;
+
+		// With more events than hardware counters the kernel multiplexes them,
+		// so we need the times to scale the counts
+		attr.read_format	= PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		switch( e )
+		{
+			case EPerfEvent::kCycles:		attr.type = PERF_TYPE_HARDWARE;	attr.config = PERF_COUNT_HW_CPU_CYCLES;			break;
+			case EPerfEvent::kInstructions:	attr.type = PERF_TYPE_HARDWARE;	attr.config = PERF_COUNT_HW_INSTRUCTIONS;		break;
+			case EPerfEvent::kLLCMisses:	attr.type = PERF_TYPE_HARDWARE;	attr.config = PERF_COUNT_HW_CACHE_MISSES;		break;
+			case EPerfEvent::kBranchMisses:	attr.type = PERF_TYPE_HARDWARE;	attr.config = PERF_COUNT_HW_BRANCH_MISSES;		break;
+			case EPerfEvent::kL1DMisses:	
+				attr.type	= PERF_TYPE_HW_CACHE;	
+				attr.config	= PERF_COUNT_HW_CACHE_L1D | ( PERF_COUNT_HW_CACHE_OP_READ << 8 ) | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 );	
+				break;
+		}
+
+		return static_cast< int >( syscall( __NR_perf_event_open, & attr, tid, -1, -1, 0 ) );
+	}
+
+	PerfFds	OpenCounters( pid_t tid = 0 )
+	{
+		PerfFds fds {};
+		for( std::size_t e = 0; e < kPerfEvents; ++ e )
+			fds[ e ] = OpenCounter( static_cast< EPerfEvent >( e ), tid );
+		return fds;
+	}
+
+	// The counters of all threads of this process - each thread is in /proc/self/task
+	std::vector< PerfFds >	OpenAllCounters( void )
+	{
+		std::vector< PerfFds >	fds;
+		std::error_code			ec;
+		for( const auto & entry : std::filesystem::directory_iterator( "/proc/self/task", ec ) )
+			fds.push_back( OpenCounters( static_cast< pid_t >( std::stol( entry.path().filename().string() ) ) ) );
+		return fds;
+	}
+
+	void	EnableCounters( const PerfFds & fds )
+	{
+		for( const auto fd : fds )
+			if( fd >= 0 )
+			{
+				ioctl( fd, PERF_EVENT_IOC_RESET, 0 );
+				ioctl( fd, PERF_EVENT_IOC_ENABLE, 0 );
+			}
+	}
+
+	// Stops, reads and closes the counters
+	EMPerfSample	CloseCounters( const PerfFds & fds )
+	{
+		EMPerfSample	s;
+
+		for( std::size_t e = 0; e < kPerfEvents; ++ e )
+		{
+			if( fds[ e ] < 0 )
+				continue;
+
+			ioctl( fds[ e ], PERF_EVENT_IOC_DISABLE, 0 );
+
+			// If the thread was counted only part of the time, the count is scaled.
+			// Not counted at all while it ran - the count is unknown.
+			std::uint64_t	buf[ 3 ] {};		// value, time enabled, time running
+			if( read( fds[ e ], buf, sizeof( buf ) ) == sizeof( buf ) && ( buf[ 2 ] > 0 || buf[ 1 ] == 0 ) )
+			{
+				s.fCounts[ e ]	= buf[ 2 ] > 0 ? static_cast< std::uint64_t >( double( buf[ 0 ] ) * double( buf[ 1 ] ) / double( buf[ 2 ] ) ) : 0;
+				s.fValid[ e ]	= true;
+			}
+
+			close( fds[ e ] );
+		}
+
+		return s;
+	}
+
+#else
+
+	// No counters on other systems - only the time is measured
+	PerfFds			OpenCounters( void ) { return kNoFds; }
+	std::vector< PerfFds >	OpenAllCounters( void ) { return std::vector< PerfFds >( omp_get_max_threads(), kNoFds ); }
+	void			EnableCounters( const PerfFds & ) {}
+	EMPerfSample	CloseCounters( const PerfFds & ) { return EMPerfSample(); }
+
+#endif
+
+
+	// Prints the valid counts, n/a for the others
+	void	PrintSample( std::ostream & o, const EMPerfSample & s )
+	{
+		for( std::size_t e = 0; e < kPerfEvents; ++ e )
+		{
+			o << "  " << kPerfEventNames[ e ] << " ";
+			if( s.fValid[ e ] )
+				o << std::setw( 10 ) << double( s.fCounts[ e ] );
+			else
+				o << std::setw( 10 ) << "n/a";
+		}
+	}
+
+}
+
+
+
+double		EMPerfSample::GetIPC( void ) const
+{
+	return IsValid( EPerfEvent::kCycles ) && IsValid( EPerfEvent::kInstructions ) && Get( EPerfEvent::kCycles ) > 0
+			? double( Get( EPerfEvent::kInstructions ) ) / double( Get( EPerfEvent::kCycles ) ) : 0.0;
+}
+
+
+EMPerfSample &	EMPerfSample::operator += ( const EMPerfSample & s )
+{
+	for( std::size_t e = 0; e < kPerfEvents; ++ e )
+	{
+		fCounts[ e ] += s.fCounts[ e ];
+		fValid[ e ] = fValid[ e ] && s.fValid[ e ];
+	}
+	return * this;
+}
+
+
+EMPerfSample	EMPerfReport::GetTotal( void ) const
+{
+	if( fThreads.empty() )
+		return EMPerfSample();
+
+	EMPerfSample	total { fThreads.front() };
+	for( std::size_t t = 1; t < fThreads.size(); ++ t )
+		total += fThreads[ t ];
+	return total;
+}
+
+
+
+bool			IsPerfAvailable( void )
+{
+	static const bool kAvailable = [] 
+	{
+		const PerfFds	fds = OpenCounters();
+		const bool		ok = fds[ static_cast< std::size_t >( EPerfEvent::kCycles ) ] >= 0;
+		CloseCounters( fds );
+		return ok;
+	} ();
+
+	return kAvailable;
+}
+
+
+EMPerfReport	MeasurePerf( const std::string & name, const std::function< void( void ) > & f )
+{
+	EMPerfReport	report;
+	report.fName = name;
+
+	// The work can go to the OpenMP team or to the workers of the pool, 
+	// so both are started before the threads are listed
+	#pragma omp parallel
+	{
+		// nothing - the team stays for the next regions
+	}
+	EMThreadPool::GetDefault();
+
+	// A counter counts only one thread, so each thread of the process gets its own
+	std::vector< PerfFds >	fds = IsPerfAvailable() ? OpenAllCounters() : std::vector< PerfFds >( omp_get_max_threads(), kNoFds );
+
+	// A counter can be switched on and off from any thread
+	for( const auto & thread_fds : fds )
+		EnableCounters( thread_fds );
+
+	const auto start_time = omp_get_wtime();
+	f();
+	report.fSeconds = omp_get_wtime() - start_time;
+
+	for( const auto & thread_fds : fds )
+		report.fThreads.push_back( CloseCounters( thread_fds ) );
+
+	return report;
+}
+
+
+
+std::ostream &	operator << ( std::ostream & o, const EMPerfReport & r )
+{
+	const auto	flags = o.flags();
+	const auto	prec = o.precision( 3 );
+
+	o << r.fName << ": " << std::fixed << r.fSeconds << " s" << std::scientific << std::endl;
+
+	const EMPerfSample	total = r.GetTotal();
+	o << "  total    ";
+	PrintSample( o, total );
+	o << std::fixed << "  IPC " << total.GetIPC() << std::scientific << std::endl;
+
+	for( std::size_t t = 0; t < r.fThreads.size(); ++ t )
+	{
+		const auto & s = r.fThreads[ t ];
+		o << "  thread " << std::setw( 2 ) << t;
+		PrintSample( o, s );
+		o << std::fixed << "  IPC " << s.GetIPC();
+		if( s.IsValid( EPerfEvent::kCycles ) && r.fSeconds > 0.0 )
+			o << "  GHz " << double( s.Get( EPerfEvent::kCycles ) ) / r.fSeconds * 1e-9;		// if busy all the time
+		o << std::scientific << std::endl;
+	}
+
+	o.flags( flags );
+	o.precision( prec );
+	return o;
+}
+
+
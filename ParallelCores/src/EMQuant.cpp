@@ -0,0 +1,175 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+
+#include "EMQuant.h"
+#include "EMSimd.h"
+
+
+
+
+namespace
+{
+
+	// Columns of c are computed in blocks of that many, so the columns 
+	// of b for one block stay in the cache for all rows of a
+	constexpr Dim	kQuant_BlockCols { 256 };
+
+
+	// Rounds x to the nearest integer in [ -kQuantMax, kQuantMax ]
+	template < typename Q >
+	Q	RoundToQ( DataType x )
+	{
+		const DataType r = std::round( x );
+		return static_cast< Q >( std::clamp< DataType >( r, - DataType( kQuantMax< Q > ), DataType( kQuantMax< Q > ) ) );
+	}
+
+
+	template < typename Q >
+	auto	GetDotKernel( void )
+	{
+		if constexpr( std::is_same_v< Q, std::int8_t > )
+			return GetKernels().DotI8;
+		else
+			return GetKernels().DotI16;
+	}
+
+}
+
+
+
+template < typename Q >
+EMQuantMatrix< Q >		Quantize( const EMatrix & m, EQuantAxis axis )
+{
+	const Dim	rows = m.GetRows(), cols = m.GetCols();
+
+	EMQuantMatrix< Q >	qm { EMatrixFor< Q >( rows, cols ), RealVec( axis == EQuantAxis::kPerRow ? rows : cols ), axis };
+	RealVec &			s = qm.fScales;
+
+	// The max magnitudes
+	if( axis == EQuantAxis::kPerRow )
+	{
+		#pragma omp parallel for schedule( static )
+		for( Dim r = 0; r < rows; ++ r )
+			for( const auto x : m[ r ] )
+				s[ r ] = std::max( s[ r ], std::fabs( x ) );
+	}
+	else
+	{
+		// Each thread takes a block of columns and goes through all rows
+		#pragma omp parallel for schedule( static )
+		for( Dim c0 = 0; c0 < cols; c0 += kQuant_BlockCols )
+			for( Dim r = 0; r < rows; ++ r )
+				for( Dim c = c0; c < std::min( c0 + kQuant_BlockCols, cols ); ++ c )
+					s[ c ] = std::max( s[ c ], std::fabs( m[ r ][ c ] ) );
+	}
+
+	// An all-zero row (column) gets scale 0 and stays all zeros
+	RealVec		inv_s( s.size() );
+	for( Dim i = 0; i < s.size(); ++ i )
+	{
+		s[ i ] /= kQuantMax< Q >;
+		inv_s[ i ] = s[ i ] > 0.0 ? 1.0 / s[ i ] : 0.0;
+	}
+
+	#pragma omp parallel for schedule( static )
+	for( Dim r = 0; r < rows; ++ r )
+	{
+		const DataType *	m_r = m.GetDataBuf() + r * m.GetLeadDim();
+		Q *					q_r = qm.fValues.GetDataBuf() + r * qm.fValues.GetLeadDim();
+
+		if( axis == EQuantAxis::kPerRow )
+			for( Dim c = 0; c < cols; ++ c )
+				q_r[ c ] = RoundToQ< Q >( m_r[ c ] * inv_s[ r ] );
+		else
+			for( Dim c = 0; c < cols; ++ c )
+				q_r[ c ] = RoundToQ< Q >( m_r[ c ] * inv_s[ c ] );
+	}
+
+	return qm;
+}
+
+
+template < typename Q >
+EMatrix			Dequantize( const EMQuantMatrix< Q > & qm )
+{
+	EMatrix		m( qm.GetRows(), qm.GetCols() );
+
+	#pragma omp parallel for schedule( static )
+	for( Dim r = 0; r < qm.GetRows(); ++ r )
+		for( Dim c = 0; c < qm.GetCols(); ++ c )
+			m[ r ][ c ] = qm.GetScale( r, c ) * qm.fValues[ r ][ c ];
+
+	return m;
+}
+
+
+template < typename Q >
+EMatrix			MultMatrix_Quant( const EMQuantMatrix< Q > & a, const EMQuantMatrix< Q > & b )
+{
+	assert( a.GetCols() == b.GetRows() );
+	assert( a.fAxis == EQuantAxis::kPerRow && b.fAxis == EQuantAxis::kPerCol );
+	assert( sizeof( Q ) > 1 || a.GetCols() <= kQuant_MaxInner8 );
+
+	const Dim	m = a.GetRows(), n = b.GetCols(), k = a.GetCols();
+
+	// The columns of b become the rows of bt, so each element of c is
+	// a dot product of two contiguous rows
+	EMatrixFor< Q >		bt( n, k );
+
+	#pragma omp parallel for schedule( static )
+	for( Dim j = 0; j < n; ++ j )
+		for( Dim p = 0; p < k; ++ p )
+			bt[ j ][ p ] = b.fValues[ p ][ j ];
+
+	EMatrix			c( m, n );
+
+	const auto		dot = GetDotKernel< Q >();
+
+	const Q *		A = a.fValues.GetDataBuf();
+	const Q *		Bt = bt.GetDataBuf();
+	DataType *		C = c.GetDataBuf();
+	const Dim		lda = a.fValues.GetLeadDim(), ldb = bt.GetLeadDim(), ldc = c.GetLeadDim();
+
+	#pragma omp parallel
+	for( Dim j0 = 0; j0 < n; j0 += kQuant_BlockCols )
+	{
+		const Dim j1 = std::min( j0 + kQuant_BlockCols, n );
+
+		// The same rows go to the same threads in each block, so nothing waits
+		#pragma omp for schedule( static ) nowait
+		for( Dim i = 0; i < m; ++ i )
+			for( Dim j = j0; j < j1; ++ j )
+				C[ i * ldc + j ] = a.fScales[ i ] * b.fScales[ j ] * DataType( dot( k, A + i * lda, Bt + j * ldb ) );
+	}
+
+	return c;
+}
+
+
+
+// The int8 and int16 versions
+
+template EMQuant8		Quantize< std::int8_t >( const EMatrix & m, EQuantAxis axis );
+template EMQuant16		Quantize< std::int16_t >( const EMatrix & m, EQuantAxis axis );
+
+template EMatrix		Dequantize< std::int8_t >( const EMQuant8 & qm );
+template EMatrix		Dequantize< std::int16_t >( const EMQuant16 & qm );
+
+template EMatrix		MultMatrix_Quant< std::int8_t >( const EMQuant8 & a, const EMQuant8 & b );
+template EMatrix		MultMatrix_Quant< std::int16_t >( const EMQuant16 & a, const EMQuant16 & b );
+
+
@@ -0,0 +1,189 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+
+#include "EMRandom.h"
+#include "EMSimd.h"
+
+
+
+namespace
+{
+
+	// So many values are generated at once on the stack
+	constexpr Dim	kGenChunk { 512 };
+
+	// So many values are filled by one thread at a time (it must be even)
+	constexpr Dim	kFillChunk { 8192 };
+
+
+	// Takes 53 bits from two words and returns a value in [ 0, 1 )
+	inline DataType	ToUnit( std::uint32_t hi, std::uint32_t lo )
+	{
+		const std::uint64_t bits = ( ( std::uint64_t( hi ) << 32 ) | lo ) >> 11;
+		return static_cast< DataType >( bits ) * ( 1.0 / 9007199254740992.0 );		// 2^-53
+	}
+
+
+	// Splits [ 0, n ) into chunks, each filled by gen( first, count ) in parallel
+	template < typename Gen >
+	void	ParallelChunks( Dim n, Gen gen )
+	{
+		const Dim chunks = ( n + kFillChunk - 1 ) / kFillChunk;
+
+		#pragma omp parallel for schedule( static ) if( chunks > 1 )
+		for( Dim ch = 0; ch < chunks; ++ ch )
+		{
+			const Dim first = ch * kFillChunk;
+			gen( first, std::min( kFillChunk, n - first ) );
+		}
+	}
+
+}
+
+
+
+void	PhiloxRandom::GenerateBits( std::uint64_t seed, std::uint64_t first_word, Dim n, std::uint32_t * out )
+{
+	const auto		philox = GetKernels().PhiloxBlocks;
+
+	std::uint64_t	block = first_word / kPhilox_BlockWords;
+	Dim				offset = first_word % kPhilox_BlockWords;
+
+	std::uint32_t	tmp[ kPhilox_BlockWords ];
+
+	// The beginning of a block which was partly used
+	if( offset != 0 && n > 0 )
+	{
+		philox( seed, block ++, 1, tmp );
+
+		const Dim m = std::min( n, kPhilox_BlockWords - offset );
+		std::copy_n( tmp + offset, m, out );
+		out += m;
+		n -= m;
+	}
+
+	// Full blocks go straight to the output
+	const Dim full_blocks = n / kPhilox_BlockWords;
+	philox( seed, block, full_blocks, out );
+	block += full_blocks;
+	out += full_blocks * kPhilox_BlockWords;
+	n -= full_blocks * kPhilox_BlockWords;
+
+	// The rest of the last block
+	if( n > 0 )
+	{
+		philox( seed, block, 1, tmp );
+		std::copy_n( tmp, n, out );
+	}
+}
+
+
+void	PhiloxRandom::GenerateUniform( std::uint64_t seed, std::uint64_t first_word, Dim n, DataType * out, DataType a, DataType b )
+{
+	assert( a <= b );
+
+	// a + ( b - a ) * u can round up to b, so it is cut to the largest number below b
+	const DataType	below_b = std::nextafter( b, a );
+
+	std::uint32_t	bits[ 2 * kGenChunk ];
+
+	for( Dim i = 0; i < n; i += kGenChunk )
+	{
+		const Dim m = std::min( kGenChunk, n - i );
+		GenerateBits( seed, first_word + 2 * i, 2 * m, bits );
+
+		for( Dim k = 0; k < m; ++ k )
+			out[ i + k ] = std::min( a + ( b - a ) * ToUnit( bits[ 2 * k ], bits[ 2 * k + 1 ] ), below_b );
+	}
+}
+
+
+// Each word is scaled to the range with a multiplication instead of the modulo.
+// The bias is below range / 2^32, i.e. negligible for small ranges.
+void	PhiloxRandom::GenerateUniformInt( std::uint64_t seed, std::uint64_t first_word, Dim n, int * out, int a, int b )
+{
+	assert( a <= b );
+	const std::uint64_t range = static_cast< std::uint64_t >( std::int64_t( b ) - a + 1 );
+
+	std::uint32_t	bits[ kGenChunk ];
+
+	for( Dim i = 0; i < n; i += kGenChunk )
+	{
+		const Dim m = std::min( kGenChunk, n - i );
+		GenerateBits( seed, first_word + i, m, bits );
+
+		for( Dim k = 0; k < m; ++ k )
+			out[ i + k ] = static_cast< int >( a + static_cast< std::int64_t >( ( bits[ k ] * range ) >> 32 ) );
+	}
+}
+
+
+void	PhiloxRandom::GenerateNormal( std::uint64_t seed, std::uint64_t first_word, Dim n, DataType * out, DataType mean, DataType stddev )
+{
+	const DataType kTwoPi { 6.283185307179586476925 };
+
+	std::uint32_t	bits[ 2 * kGenChunk ];		// kGenChunk is even, so are the pairs
+
+	for( Dim i = 0; i < n; i += kGenChunk )
+	{
+		const Dim m = std::min( kGenChunk, n - i );
+		const Dim pairs = ( m + 1 ) / 2;
+		GenerateBits( seed, first_word + 2 * i, 4 * pairs, bits );
+
+		for( Dim p = 0; p < pairs; ++ p )
+		{
+			const DataType u1 = 1.0 - ToUnit( bits[ 4 * p ], bits[ 4 * p + 1 ] );		// in ( 0, 1 ], so log is finite
+			const DataType u2 = ToUnit( bits[ 4 * p + 2 ], bits[ 4 * p + 3 ] );
+
+			const DataType r = stddev * std::sqrt( - 2.0 * std::log( u1 ) );
+
+			out[ i + 2 * p ] = mean + r * std::cos( kTwoPi * u2 );
+			if( 2 * p + 1 < m )
+				out[ i + 2 * p + 1 ] = mean + r * std::sin( kTwoPi * u2 );
+		}
+	}
+}
+
+
+
+void	PhiloxRandom::FillUniform( DataType * out, Dim n, DataType a, DataType b )
+{
+	const auto seed = fSeed, pos = fPosition;
+	ParallelChunks( n, [ = ] ( Dim first, Dim m ) { GenerateUniform( seed, pos + 2 * first, m, out + first, a, b ); } );
+	fPosition += 2 * n;
+}
+
+
+void	PhiloxRandom::FillUniformInt( int * out, Dim n, int a, int b )
+{
+	const auto seed = fSeed, pos = fPosition;
+	ParallelChunks( n, [ = ] ( Dim first, Dim m ) { GenerateUniformInt( seed, pos + first, m, out + first, a, b ); } );
+	fPosition += n;
+}
+
+
+void	PhiloxRandom::FillNormal( DataType * out, Dim n, DataType mean, DataType stddev )
+{
+	const auto seed = fSeed, pos = fPosition;
+	ParallelChunks( n, [ = ] ( Dim first, Dim m ) { GenerateNormal( seed, pos + 2 * first, m, out + first, mean, stddev ); } );
+	fPosition += 4 * ( ( n + 1 ) / 2 );
+}
+
+
+
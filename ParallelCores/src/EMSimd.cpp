@@ -0,0 +1,763 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+#include <algorithm>
+#include <atomic>
+
+#if defined( _M_X64 ) || defined( __x86_64__ )
+	#define EM_X86_64	1
+	#include <immintrin.h>
+	#if defined( _MSC_VER )
+		#include <intrin.h>
+	#endif
+#endif
+
+// GCC and Clang need to be told which instructions they can use in a function.
+// MSVC accepts the intrinsics anywhere.
+#if defined( __GNUC__ )
+	#define EM_TARGET_AVX2		__attribute__(( target( "avx2,fma" ) ))
+	#define EM_TARGET_AVX512	__attribute__(( target( "avx512f,avx2,fma" ) ))
+#else
+	#define EM_TARGET_AVX2
+	#define EM_TARGET_AVX512
+#endif
+
+
+#include "EMSimd.h"
+#include "EMGemm.h"
+#include "EMRandom.h"
+#include "EMBatch.h"
+#include "EMQuant.h"
+#include "EMDot.h"
+
+
+
+// The compensated dot products for the tables below. They are in EMDotKernels.cpp,
+// which is compiled without contracting a * b + s into FMA (see CMakeLists.txt).
+template < EDotAlg Alg >	EMDotSum	CompensatedDot_Scalar( Dim n, const DataType * x, const DataType * y );
+
+#if EM_X86_64
+template < EDotAlg Alg >	EM_TARGET_AVX2 EMDotSum		CompensatedDot_AVX2( Dim n, const DataType * x, const DataType * y );
+template < EDotAlg Alg >	EM_TARGET_AVX512 EMDotSum	CompensatedDot_AVX512( Dim n, const DataType * x, const DataType * y );
+#endif
+
+
+
+namespace
+{
+
+	// -----------------------------------------------
+	// Scalar versions - they run everywhere
+
+	void Add_Scalar( Dim n, const DataType * x, const DataType * y, DataType * z )
+	{
+		for( Dim i = 0; i < n; ++ i )
+			z[ i ] = x[ i ] + y[ i ];
+	}
+
+	void Scale_Scalar( Dim n, DataType alpha, const DataType * x, DataType * y )
+	{
+		for( Dim i = 0; i < n; ++ i )
+			y[ i ] = alpha * x[ i ];
+	}
+
+	void Axpy_Scalar( Dim n, DataType alpha, const DataType * x, DataType * y )
+	{
+		for( Dim i = 0; i < n; ++ i )
+			y[ i ] += alpha * x[ i ];
+	}
+
+	// Four partial sums break the dependency chain of the additions
+	DataType Dot_Scalar( Dim n, const DataType * x, const DataType * y )
+	{
+		DataType s0 {}, s1 {}, s2 {}, s3 {};
+		Dim i {};
+		for( ; i + 4 <= n; i += 4 )
+		{
+			s0 += x[ i ] * y[ i ];
+			s1 += x[ i + 1 ] * y[ i + 1 ];
+			s2 += x[ i + 2 ] * y[ i + 2 ];
+			s3 += x[ i + 3 ] * y[ i + 3 ];
+		}
+		for( ; i < n; ++ i )
+			s0 += x[ i ] * y[ i ];
+		return ( s0 + s1 ) + ( s2 + s3 );
+	}
+
+	// Adds the mr x nr part of a local kGemm_MR x kGemm_NR block to C
+	void AddTileToC( const DataType acc[ kGemm_MR ][ kGemm_NR ], DataType * C, Dim ldc, Dim mr, Dim nr )
+	{
+		for( Dim i = 0; i < mr; ++ i )
+			for( Dim j = 0; j < nr; ++ j )
+				C[ i * ldc + j ] += acc[ i ][ j ];
+	}
+
+	// Computes a kGemm_MR x kGemm_NR block of products in local accumulators
+	// (the compiler keeps them in registers), then adds its mr x nr part to C.
+	void MicroKernel_Scalar( Dim kc, const DataType * a, const DataType * b, DataType * C, Dim ldc, Dim mr, Dim nr )
+	{
+		DataType acc[ kGemm_MR ][ kGemm_NR ] {};
+
+		for( Dim p = 0; p < kc; ++ p, a += kGemm_MR, b += kGemm_NR )
+			for( Dim i = 0; i < kGemm_MR; ++ i )
+				for( Dim j = 0; j < kGemm_NR; ++ j )
+					acc[ i ][ j ] += a[ i ] * b[ j ];
+
+		AddTileToC( acc, C, ldc, mr, nr );
+	}
+
+	// The 32 x 32 -> 64 bit product split into the high and the low words
+	inline void MulHiLo( std::uint32_t a, std::uint32_t b, std::uint32_t & hi, std::uint32_t & lo )
+	{
+		const std::uint64_t p = std::uint64_t( a ) * b;
+		hi = static_cast< std::uint32_t >( p >> 32 );
+		lo = static_cast< std::uint32_t >( p );
+	}
+
+	void PhiloxBlocks_Scalar( std::uint64_t key, std::uint64_t first_block, Dim blocks, std::uint32_t * out )
+	{
+		for( Dim b = 0; b < blocks; ++ b, out += kPhilox_BlockWords )
+			for( Dim i = 0; i < kPhilox_Lanes; ++ i )
+			{
+				const std::uint64_t n = ( first_block + b ) * kPhilox_Lanes + i;
+
+				std::uint32_t c[ 4 ] { static_cast< std::uint32_t >( n ), static_cast< std::uint32_t >( n >> 32 ), 0, 0 };
+				std::uint32_t k0 = static_cast< std::uint32_t >( key ), k1 = static_cast< std::uint32_t >( key >> 32 );
+
+				for( Dim r = 0; r < kPhilox_Rounds; ++ r, k0 += kPhilox_W0, k1 += kPhilox_W1 )
+				{
+					std::uint32_t hi0, lo0, hi1, lo1;
+					MulHiLo( kPhilox_M0, c[ 0 ], hi0, lo0 );
+					MulHiLo( kPhilox_M1, c[ 2 ], hi1, lo1 );
+
+					c[ 0 ] = hi1 ^ c[ 1 ] ^ k0;
+					c[ 1 ] = lo1;
+					c[ 2 ] = hi0 ^ c[ 3 ] ^ k1;
+					c[ 3 ] = lo0;
+				}
+
+				for( Dim j = 0; j < 4; ++ j )
+					out[ j * kPhilox_Lanes + i ] = c[ j ];
+			}
+	}
+
+	// Groups of kBatch_Lanes matrices interleaved as in EMBatch.h: c = a * b
+	void BatchMult_Scalar( Dim groups, Dim m, Dim n, Dim k, const DataType * a, const DataType * b, DataType * c )
+	{
+		for( Dim g = 0; g < groups; ++ g, a += m * k * kBatch_Lanes, b += k * n * kBatch_Lanes, c += m * n * kBatch_Lanes )
+			for( Dim i = 0; i < m; ++ i )
+				for( Dim j = 0; j < n; ++ j )
+				{
+					DataType acc[ kBatch_Lanes ] {};
+					for( Dim p = 0; p < k; ++ p )
+						for( Dim l = 0; l < kBatch_Lanes; ++ l )
+							acc[ l ] += a[ ( i * k + p ) * kBatch_Lanes + l ] * b[ ( p * n + j ) * kBatch_Lanes + l ];
+
+					std::copy( acc, acc + kBatch_Lanes, c + ( i * n + j ) * kBatch_Lanes );
+				}
+	}
+
+	// Integer dot products - exact, with no rounding
+	std::int64_t DotI8_Scalar( Dim n, const std::int8_t * x, const std::int8_t * y )
+	{
+		std::int32_t sum {};		// n * 127^2 fits for n up to kQuant_MaxInner8
+		for( Dim i = 0; i < n; ++ i )
+			sum += std::int32_t( x[ i ] ) * y[ i ];
+		return sum;
+	}
+
+	std::int64_t DotI16_Scalar( Dim n, const std::int16_t * x, const std::int16_t * y )
+	{
+		std::int64_t sum {};
+		for( Dim i = 0; i < n; ++ i )
+			sum += std::int32_t( x[ i ] ) * y[ i ];
+		return sum;
+	}
+
+
+#if EM_X86_64
+
+	// -----------------------------------------------
+	// AVX2 + FMA - 4 doubles per register
+
+	EM_TARGET_AVX2 void Add_AVX2( Dim n, const DataType * x, const DataType * y, DataType * z )
+	{
+		Dim i {};
+		for( ; i + 4 <= n; i += 4 )
+			_mm256_storeu_pd( z + i, _mm256_add_pd( _mm256_loadu_pd( x + i ), _mm256_loadu_pd( y + i ) ) );
+		for( ; i < n; ++ i )
+			z[ i ] = x[ i ] + y[ i ];
+	}
+
+	EM_TARGET_AVX2 void Scale_AVX2( Dim n, DataType alpha, const DataType * x, DataType * y )
+	{
+		const __m256d va = _mm256_set1_pd( alpha );
+		Dim i {};
+		for( ; i + 4 <= n; i += 4 )
+			_mm256_storeu_pd( y + i, _mm256_mul_pd( va, _mm256_loadu_pd( x + i ) ) );
+		for( ; i < n; ++ i )
+			y[ i ] = alpha * x[ i ];
+	}
+
+	EM_TARGET_AVX2 void Axpy_AVX2( Dim n, DataType alpha, const DataType * x, DataType * y )
+	{
+		const __m256d va = _mm256_set1_pd( alpha );
+		Dim i {};
+		for( ; i + 4 <= n; i += 4 )
+			_mm256_storeu_pd( y + i, _mm256_fmadd_pd( va, _mm256_loadu_pd( x + i ), _mm256_loadu_pd( y + i ) ) );
+		for( ; i < n; ++ i )
+			y[ i ] += alpha * x[ i ];
+	}
+
+	// Four independent accumulators hide the latency of FMA
+	EM_TARGET_AVX2 DataType Dot_AVX2( Dim n, const DataType * x, const DataType * y )
+	{
+		__m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd(), acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+		Dim i {};
+		for( ; i + 16 <= n; i += 16 )
+		{
+			acc0 = _mm256_fmadd_pd( _mm256_loadu_pd( x + i ),		_mm256_loadu_pd( y + i ),		acc0 );
+			acc1 = _mm256_fmadd_pd( _mm256_loadu_pd( x + i + 4 ),	_mm256_loadu_pd( y + i + 4 ),	acc1 );
+			acc2 = _mm256_fmadd_pd( _mm256_loadu_pd( x + i + 8 ),	_mm256_loadu_pd( y + i + 8 ),	acc2 );
+			acc3 = _mm256_fmadd_pd( _mm256_loadu_pd( x + i + 12 ),	_mm256_loadu_pd( y + i + 12 ),	acc3 );
+		}
+		for( ; i + 4 <= n; i += 4 )
+			acc0 = _mm256_fmadd_pd( _mm256_loadu_pd( x + i ), _mm256_loadu_pd( y + i ), acc0 );
+
+		alignas( 32 ) DataType lanes[ 4 ];
+		_mm256_store_pd( lanes, _mm256_add_pd( _mm256_add_pd( acc0, acc1 ), _mm256_add_pd( acc2, acc3 ) ) );
+
+		DataType sum = ( lanes[ 0 ] + lanes[ 1 ] ) + ( lanes[ 2 ] + lanes[ 3 ] );
+		for( ; i < n; ++ i )
+			sum += x[ i ] * y[ i ];
+		return sum;
+	}
+
+	// A row of kGemm_NR == 8 doubles takes two registers, so the 6 x 8 block
+	// needs 12 accumulators - together with 2 loads of b and 1 broadcast of a
+	// it fits into the 16 ymm registers.
+	EM_TARGET_AVX2 void MicroKernel_AVX2( Dim kc, const DataType * a, const DataType * b, DataType * C, Dim ldc, Dim mr, Dim nr )
+	{
+		static_assert( kGemm_NR == 8, "The AVX2 micro-kernel assumes kGemm_NR == 8" );
+
+		__m256d acc[ kGemm_MR ][ 2 ];
+		for( Dim i = 0; i < kGemm_MR; ++ i )
+			acc[ i ][ 0 ] = acc[ i ][ 1 ] = _mm256_setzero_pd();
+
+		for( Dim p = 0; p < kc; ++ p, a += kGemm_MR, b += kGemm_NR )
+		{
+			const __m256d b0 = _mm256_load_pd( b );
+			const __m256d b1 = _mm256_load_pd( b + 4 );
+
+			for( Dim i = 0; i < kGemm_MR; ++ i )
+			{
+				const __m256d ai = _mm256_broadcast_sd( a + i );
+				acc[ i ][ 0 ] = _mm256_fmadd_pd( ai, b0, acc[ i ][ 0 ] );
+				acc[ i ][ 1 ] = _mm256_fmadd_pd( ai, b1, acc[ i ][ 1 ] );
+			}
+		}
+
+		if( mr == kGemm_MR && nr == kGemm_NR )
+		{
+			for( Dim i = 0; i < kGemm_MR; ++ i )
+			{
+				DataType * c_row = C + i * ldc;
+				_mm256_storeu_pd( c_row,		_mm256_add_pd( _mm256_loadu_pd( c_row ),		acc[ i ][ 0 ] ) );
+				_mm256_storeu_pd( c_row + 4,	_mm256_add_pd( _mm256_loadu_pd( c_row + 4 ),	acc[ i ][ 1 ] ) );
+			}
+		}
+		else
+		{
+			// A border tile - go through a local block
+			DataType tile[ kGemm_MR ][ kGemm_NR ];
+			for( Dim i = 0; i < kGemm_MR; ++ i )
+			{
+				_mm256_storeu_pd( & tile[ i ][ 0 ], acc[ i ][ 0 ] );
+				_mm256_storeu_pd( & tile[ i ][ 4 ], acc[ i ][ 1 ] );
+			}
+			AddTileToC( tile, C, ldc, mr, nr );
+		}
+	}
+
+
+	// A group of kBatch_Lanes == 8 matrices takes two registers per element,
+	// so they are done in two halves. For the sizes known at compile time
+	// all the loops are unrolled and a row of c stays in registers.
+	template < Dim M, Dim N, Dim K >
+	EM_TARGET_AVX2 void BatchMultFixed_AVX2( Dim groups, const DataType * a, const DataType * b, DataType * c )
+	{
+		static_assert( kBatch_Lanes == 8, "The AVX2 batch kernel assumes kBatch_Lanes == 8" );
+
+		for( Dim g = 0; g < groups; ++ g, a += M * K * kBatch_Lanes, b += K * N * kBatch_Lanes, c += M * N * kBatch_Lanes )
+			for( Dim h = 0; h < kBatch_Lanes; h += 4 )
+				for( Dim i = 0; i < M; ++ i )
+				{
+					__m256d acc[ N ];
+					for( Dim j = 0; j < N; ++ j )
+						acc[ j ] = _mm256_setzero_pd();
+
+					for( Dim p = 0; p < K; ++ p )
+					{
+						const __m256d a_ip = _mm256_load_pd( a + ( i * K + p ) * kBatch_Lanes + h );
+						for( Dim j = 0; j < N; ++ j )
+							acc[ j ] = _mm256_fmadd_pd( a_ip, _mm256_load_pd( b + ( p * N + j ) * kBatch_Lanes + h ), acc[ j ] );
+					}
+
+					for( Dim j = 0; j < N; ++ j )
+						_mm256_store_pd( c + ( i * N + j ) * kBatch_Lanes + h, acc[ j ] );
+				}
+	}
+
+	EM_TARGET_AVX2 void BatchMult_AVX2( Dim groups, Dim m, Dim n, Dim k, const DataType * a, const DataType * b, DataType * c )
+	{
+		if( m == n && n == k )
+			switch( m )
+			{
+				case 3:		BatchMultFixed_AVX2< 3, 3, 3 >( groups, a, b, c ); return;
+				case 4:		BatchMultFixed_AVX2< 4, 4, 4 >( groups, a, b, c ); return;
+				case 8:		BatchMultFixed_AVX2< 8, 8, 8 >( groups, a, b, c ); return;
+				default:	break;
+			}
+
+		// Any other sizes - one element of c at a time
+		for( Dim g = 0; g < groups; ++ g, a += m * k * kBatch_Lanes, b += k * n * kBatch_Lanes, c += m * n * kBatch_Lanes )
+			for( Dim i = 0; i < m; ++ i )
+				for( Dim j = 0; j < n; ++ j )
+				{
+					__m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+					for( Dim p = 0; p < k; ++ p )
+					{
+						const DataType * a_ip = a + ( i * k + p ) * kBatch_Lanes;
+						const DataType * b_pj = b + ( p * n + j ) * kBatch_Lanes;
+						acc0 = _mm256_fmadd_pd( _mm256_load_pd( a_ip ),		_mm256_load_pd( b_pj ),		acc0 );
+						acc1 = _mm256_fmadd_pd( _mm256_load_pd( a_ip + 4 ),	_mm256_load_pd( b_pj + 4 ),	acc1 );
+					}
+					_mm256_store_pd( c + ( i * n + j ) * kBatch_Lanes,		acc0 );
+					_mm256_store_pd( c + ( i * n + j ) * kBatch_Lanes + 4,	acc1 );
+				}
+	}
+
+	// The sum of the 8 int32 lanes
+	EM_TARGET_AVX2 std::int64_t HorizontalSum_AVX2( __m256i v )
+	{
+		alignas( 32 ) std::int32_t lanes[ 8 ];
+		_mm256_store_si256( reinterpret_cast< __m256i * >( lanes ), v );
+		std::int64_t sum {};
+		for( auto l : lanes )
+			sum += l;
+		return sum;
+	}
+
+	// 16 int8 are extended to int16, then vpmaddwd multiplies them in pairs and adds 
+	// the pairs to 8 int32 lanes. A lane grows by at most 2 * 127^2 per step, so 
+	// the int32 accumulators do not overflow for n up to kQuant_MaxInner8.
+	EM_TARGET_AVX2 std::int64_t DotI8_AVX2( Dim n, const std::int8_t * x, const std::int8_t * y )
+	{
+		__m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+		Dim i {};
+		for( ; i + 32 <= n; i += 32 )
+		{
+			const __m256i x0 = _mm256_cvtepi8_epi16( _mm_loadu_si128( reinterpret_cast< const __m128i * >( x + i ) ) );
+			const __m256i y0 = _mm256_cvtepi8_epi16( _mm_loadu_si128( reinterpret_cast< const __m128i * >( y + i ) ) );
+			const __m256i x1 = _mm256_cvtepi8_epi16( _mm_loadu_si128( reinterpret_cast< const __m128i * >( x + i + 16 ) ) );
+			const __m256i y1 = _mm256_cvtepi8_epi16( _mm_loadu_si128( reinterpret_cast< const __m128i * >( y + i + 16 ) ) );
+			acc0 = _mm256_add_epi32( acc0, _mm256_madd_epi16( x0, y0 ) );
+			acc1 = _mm256_add_epi32( acc1, _mm256_madd_epi16( x1, y1 ) );
+		}
+
+		std::int64_t sum = HorizontalSum_AVX2( _mm256_add_epi32( acc0, acc1 ) );
+		for( ; i < n; ++ i )
+			sum += std::int32_t( x[ i ] ) * y[ i ];
+		return sum;
+	}
+
+	// Here a pair of products can reach 2 * 32767^2, which just fits into int32,
+	// so the pairs from vpmaddwd are widened and summed in 4 int64 lanes.
+	EM_TARGET_AVX2 std::int64_t DotI16_AVX2( Dim n, const std::int16_t * x, const std::int16_t * y )
+	{
+		__m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+		Dim i {};
+		for( ; i + 16 <= n; i += 16 )
+		{
+			const __m256i p = _mm256_madd_epi16(	_mm256_loadu_si256( reinterpret_cast< const __m256i * >( x + i ) ), 
+													_mm256_loadu_si256( reinterpret_cast< const __m256i * >( y + i ) ) );
+			acc0 = _mm256_add_epi64( acc0, _mm256_cvtepi32_epi64( _mm256_castsi256_si128( p ) ) );
+			acc1 = _mm256_add_epi64( acc1, _mm256_cvtepi32_epi64( _mm256_extracti128_si256( p, 1 ) ) );
+		}
+
+		alignas( 32 ) std::int64_t lanes[ 4 ];
+		_mm256_store_si256( reinterpret_cast< __m256i * >( lanes ), _mm256_add_epi64( acc0, acc1 ) );
+
+		std::int64_t sum = ( lanes[ 0 ] + lanes[ 1 ] ) + ( lanes[ 2 ] + lanes[ 3 ] );
+		for( ; i < n; ++ i )
+			sum += std::int32_t( x[ i ] ) * y[ i ];
+		return sum;
+	}
+
+
+	// -----------------------------------------------
+	// AVX-512 - 8 doubles per register; the tails are handled with masks
+
+	// Products of 8 lanes of a with m, split into the high and the low words.
+	// mul_epu32 multiplies only the even lanes, so the odd ones are shifted down.
+	EM_TARGET_AVX2 void MulHiLo_AVX2( __m256i a, __m256i m, __m256i & hi, __m256i & lo )
+	{
+		const __m256i even	= _mm256_mul_epu32( a, m );
+		const __m256i odd	= _mm256_mul_epu32( _mm256_srli_epi64( a, 32 ), m );
+
+		lo = _mm256_blend_epi32( even, _mm256_slli_epi64( odd, 32 ), 0xAA );
+		hi = _mm256_blend_epi32( _mm256_srli_epi64( even, 32 ), odd, 0xAA );
+	}
+
+	// Each block is done in two halves of 8 counters
+	EM_TARGET_AVX2 void PhiloxBlocks_AVX2( std::uint64_t key, std::uint64_t first_block, Dim blocks, std::uint32_t * out )
+	{
+		const __m256i m0 = _mm256_set1_epi32( static_cast< int >( kPhilox_M0 ) );
+		const __m256i m1 = _mm256_set1_epi32( static_cast< int >( kPhilox_M1 ) );
+		const __m256i w0 = _mm256_set1_epi32( static_cast< int >( kPhilox_W0 ) );
+		const __m256i w1 = _mm256_set1_epi32( static_cast< int >( kPhilox_W1 ) );
+
+		const __m256i lane = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+
+		for( Dim b = 0; b < blocks; ++ b, out += kPhilox_BlockWords )
+			for( Dim h = 0; h < kPhilox_Lanes; h += 8 )
+			{
+				// n is a multiple of 8, so adding the lane cannot overflow to the high word
+				const std::uint64_t n = ( first_block + b ) * kPhilox_Lanes + h;
+
+				__m256i c0 = _mm256_add_epi32( _mm256_set1_epi32( static_cast< int >( n ) ), lane );
+				__m256i c1 = _mm256_set1_epi32( static_cast< int >( n >> 32 ) );
+				__m256i c2 = _mm256_setzero_si256();
+				__m256i c3 = _mm256_setzero_si256();
+
+				__m256i k0 = _mm256_set1_epi32( static_cast< int >( key ) );
+				__m256i k1 = _mm256_set1_epi32( static_cast< int >( key >> 32 ) );
+
+				for( Dim r = 0; r < kPhilox_Rounds; ++ r )
+				{
+					__m256i hi0, lo0, hi1, lo1;
+					MulHiLo_AVX2( c0, m0, hi0, lo0 );
+					MulHiLo_AVX2( c2, m1, hi1, lo1 );
+
+					c0 = _mm256_xor_si256( _mm256_xor_si256( hi1, c1 ), k0 );
+					c1 = lo1;
+					c2 = _mm256_xor_si256( _mm256_xor_si256( hi0, c3 ), k1 );
+					c3 = lo0;
+
+					k0 = _mm256_add_epi32( k0, w0 );
+					k1 = _mm256_add_epi32( k1, w1 );
+				}
+
+				_mm256_storeu_si256( reinterpret_cast< __m256i * >( out + 0 * kPhilox_Lanes + h ), c0 );
+				_mm256_storeu_si256( reinterpret_cast< __m256i * >( out + 1 * kPhilox_Lanes + h ), c1 );
+				_mm256_storeu_si256( reinterpret_cast< __m256i * >( out + 2 * kPhilox_Lanes + h ), c2 );
+				_mm256_storeu_si256( reinterpret_cast< __m256i * >( out + 3 * kPhilox_Lanes + h ), c3 );
+			}
+	}
+
+
+	EM_TARGET_AVX512 __mmask8 TailMask( Dim n )
+	{
+		return static_cast< __mmask8 >( ( 1u << n ) - 1u );
+	}
+
+	EM_TARGET_AVX512 void Add_AVX512( Dim n, const DataType * x, const DataType * y, DataType * z )
+	{
+		Dim i {};
+		for( ; i + 8 <= n; i += 8 )
+			_mm512_storeu_pd( z + i, _mm512_add_pd( _mm512_loadu_pd( x + i ), _mm512_loadu_pd( y + i ) ) );
+		if( i < n )
+		{
+			const __mmask8 m = TailMask( n - i );
+			_mm512_mask_storeu_pd( z + i, m, _mm512_add_pd( _mm512_maskz_loadu_pd( m, x + i ), _mm512_maskz_loadu_pd( m, y + i ) ) );
+		}
+	}
+
+	EM_TARGET_AVX512 void Scale_AVX512( Dim n, DataType alpha, const DataType * x, DataType * y )
+	{
+		const __m512d va = _mm512_set1_pd( alpha );
+		Dim i {};
+		for( ; i + 8 <= n; i += 8 )
+			_mm512_storeu_pd( y + i, _mm512_mul_pd( va, _mm512_loadu_pd( x + i ) ) );
+		if( i < n )
+		{
+			const __mmask8 m = TailMask( n - i );
+			_mm512_mask_storeu_pd( y + i, m, _mm512_mul_pd( va, _mm512_maskz_loadu_pd( m, x + i ) ) );
+		}
+	}
+
+	EM_TARGET_AVX512 void Axpy_AVX512( Dim n, DataType alpha, const DataType * x, DataType * y )
+	{
+		const __m512d va = _mm512_set1_pd( alpha );
+		Dim i {};
+		for( ; i + 8 <= n; i += 8 )
+			_mm512_storeu_pd( y + i, _mm512_fmadd_pd( va, _mm512_loadu_pd( x + i ), _mm512_loadu_pd( y + i ) ) );
+		if( i < n )
+		{
+			const __mmask8 m = TailMask( n - i );
+			_mm512_mask_storeu_pd( y + i, m, _mm512_fmadd_pd( va, _mm512_maskz_loadu_pd( m, x + i ), _mm512_maskz_loadu_pd( m, y + i ) ) );
+		}
+	}
+
+	EM_TARGET_AVX512 DataType Dot_AVX512( Dim n, const DataType * x, const DataType * y )
+	{
+		__m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd(), acc2 = _mm512_setzero_pd(), acc3 = _mm512_setzero_pd();
+		Dim i {};
+		for( ; i + 32 <= n; i += 32 )
+		{
+			acc0 = _mm512_fmadd_pd( _mm512_loadu_pd( x + i ),		_mm512_loadu_pd( y + i ),		acc0 );
+			acc1 = _mm512_fmadd_pd( _mm512_loadu_pd( x + i + 8 ),	_mm512_loadu_pd( y + i + 8 ),	acc1 );
+			acc2 = _mm512_fmadd_pd( _mm512_loadu_pd( x + i + 16 ),	_mm512_loadu_pd( y + i + 16 ),	acc2 );
+			acc3 = _mm512_fmadd_pd( _mm512_loadu_pd( x + i + 24 ),	_mm512_loadu_pd( y + i + 24 ),	acc3 );
+		}
+		for( ; i + 8 <= n; i += 8 )
+			acc0 = _mm512_fmadd_pd( _mm512_loadu_pd( x + i ), _mm512_loadu_pd( y + i ), acc0 );
+		if( i < n )
+		{
+			const __mmask8 m = TailMask( n - i );
+			acc1 = _mm512_fmadd_pd( _mm512_maskz_loadu_pd( m, x + i ), _mm512_maskz_loadu_pd( m, y + i ), acc1 );
+		}
+
+		// The two halves are added and summed as in Dot_AVX2. They are taken with 
+		// the zero-masking extract (all lanes set) - _mm512_reduce_add_pd and the plain 
+		// extract pass an undefined register, on which GCC warns with -Wuninitialized.
+		const __m512d acc = _mm512_add_pd( _mm512_add_pd( acc0, acc1 ), _mm512_add_pd( acc2, acc3 ) );
+
+		alignas( 32 ) DataType lanes[ 4 ];
+		_mm256_store_pd( lanes, _mm256_add_pd( _mm512_maskz_extractf64x4_pd( 0xFF, acc, 0 ), _mm512_maskz_extractf64x4_pd( 0xFF, acc, 1 ) ) );
+
+		return ( lanes[ 0 ] + lanes[ 1 ] ) + ( lanes[ 2 ] + lanes[ 3 ] );
+	}
+
+	// A row of kGemm_NR == 8 doubles is exactly one zmm register.
+	// Border tiles are written with masked loads and stores.
+	EM_TARGET_AVX512 void MicroKernel_AVX512( Dim kc, const DataType * a, const DataType * b, DataType * C, Dim ldc, Dim mr, Dim nr )
+	{
+		static_assert( kGemm_NR == 8, "The AVX-512 micro-kernel assumes kGemm_NR == 8" );
+
+		__m512d acc[ kGemm_MR ];
+		for( Dim i = 0; i < kGemm_MR; ++ i )
+			acc[ i ] = _mm512_setzero_pd();
+
+		for( Dim p = 0; p < kc; ++ p, a += kGemm_MR, b += kGemm_NR )
+		{
+			const __m512d b0 = _mm512_load_pd( b );
+
+			for( Dim i = 0; i < kGemm_MR; ++ i )
+				acc[ i ] = _mm512_fmadd_pd( _mm512_set1_pd( a[ i ] ), b0, acc[ i ] );
+		}
+
+		const __mmask8 m = TailMask( nr );
+		for( Dim i = 0; i < mr; ++ i )
+		{
+			DataType * c_row = C + i * ldc;
+			_mm512_mask_storeu_pd( c_row, m, _mm512_add_pd( _mm512_maskz_loadu_pd( m, c_row ), acc[ i ] ) );
+		}
+	}
+
+	EM_TARGET_AVX512 void MulHiLo_AVX512( __m512i a, __m512i m, __m512i & hi, __m512i & lo )
+	{
+		// The zero-masking forms with all lanes set - as in Dot_AVX512, 
+		// the plain ones pass an undefined register, on which GCC warns
+		const __mmask8 all { 0xFF };
+		const __m512i even	= _mm512_maskz_mul_epu32( all, a, m );
+		const __m512i odd	= _mm512_maskz_mul_epu32( all, _mm512_maskz_srli_epi64( all, a, 32 ), m );
+
+		lo = _mm512_mask_blend_epi32( 0xAAAA, even, _mm512_maskz_slli_epi64( all, odd, 32 ) );
+		hi = _mm512_mask_blend_epi32( 0xAAAA, _mm512_maskz_srli_epi64( all, even, 32 ), odd );
+	}
+
+	// All 16 counters of a block in one register
+	EM_TARGET_AVX512 void PhiloxBlocks_AVX512( std::uint64_t key, std::uint64_t first_block, Dim blocks, std::uint32_t * out )
+	{
+		const __m512i m0 = _mm512_set1_epi32( static_cast< int >( kPhilox_M0 ) );
+		const __m512i m1 = _mm512_set1_epi32( static_cast< int >( kPhilox_M1 ) );
+		const __m512i w0 = _mm512_set1_epi32( static_cast< int >( kPhilox_W0 ) );
+		const __m512i w1 = _mm512_set1_epi32( static_cast< int >( kPhilox_W1 ) );
+
+		const __m512i lane = _mm512_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+
+		for( Dim b = 0; b < blocks; ++ b, out += kPhilox_BlockWords )
+		{
+			const std::uint64_t n = ( first_block + b ) * kPhilox_Lanes;
+
+			__m512i c0 = _mm512_add_epi32( _mm512_set1_epi32( static_cast< int >( n ) ), lane );
+			__m512i c1 = _mm512_set1_epi32( static_cast< int >( n >> 32 ) );
+			__m512i c2 = _mm512_setzero_si512();
+			__m512i c3 = _mm512_setzero_si512();
+
+			__m512i k0 = _mm512_set1_epi32( static_cast< int >( key ) );
+			__m512i k1 = _mm512_set1_epi32( static_cast< int >( key >> 32 ) );
+
+			for( Dim r = 0; r < kPhilox_Rounds; ++ r )
+			{
+				__m512i hi0, lo0, hi1, lo1;
+				MulHiLo_AVX512( c0, m0, hi0, lo0 );
+				MulHiLo_AVX512( c2, m1, hi1, lo1 );
+
+				c0 = _mm512_xor_si512( _mm512_xor_si512( hi1, c1 ), k0 );
+				c1 = lo1;
+				c2 = _mm512_xor_si512( _mm512_xor_si512( hi0, c3 ), k1 );
+				c3 = lo0;
+
+				k0 = _mm512_add_epi32( k0, w0 );
+				k1 = _mm512_add_epi32( k1, w1 );
+			}
+
+			_mm512_storeu_si512( out + 0 * kPhilox_Lanes, c0 );
+			_mm512_storeu_si512( out + 1 * kPhilox_Lanes, c1 );
+			_mm512_storeu_si512( out + 2 * kPhilox_Lanes, c2 );
+			_mm512_storeu_si512( out + 3 * kPhilox_Lanes, c3 );
+		}
+	}
+
+	// One register holds one element of the whole group of matrices
+	template < Dim M, Dim N, Dim K >
+	EM_TARGET_AVX512 void BatchMultFixed_AVX512( Dim groups, const DataType * a, const DataType * b, DataType * c )
+	{
+		static_assert( kBatch_Lanes == 8, "The AVX-512 batch kernel assumes kBatch_Lanes == 8" );
+
+		for( Dim g = 0; g < groups; ++ g, a += M * K * kBatch_Lanes, b += K * N * kBatch_Lanes, c += M * N * kBatch_Lanes )
+			for( Dim i = 0; i < M; ++ i )
+			{
+				__m512d acc[ N ];
+				for( Dim j = 0; j < N; ++ j )
+					acc[ j ] = _mm512_setzero_pd();
+
+				for( Dim p = 0; p < K; ++ p )
+				{
+					const __m512d a_ip = _mm512_load_pd( a + ( i * K + p ) * kBatch_Lanes );
+					for( Dim j = 0; j < N; ++ j )
+						acc[ j ] = _mm512_fmadd_pd( a_ip, _mm512_load_pd( b + ( p * N + j ) * kBatch_Lanes ), acc[ j ] );
+				}
+
+				for( Dim j = 0; j < N; ++ j )
+					_mm512_store_pd( c + ( i * N + j ) * kBatch_Lanes, acc[ j ] );
+			}
+	}
+
+	EM_TARGET_AVX512 void BatchMult_AVX512( Dim groups, Dim m, Dim n, Dim k, const DataType * a, const DataType * b, DataType * c )
+	{
+		if( m == n && n == k )
+			switch( m )
+			{
+				case 3:		BatchMultFixed_AVX512< 3, 3, 3 >( groups, a, b, c ); return;
+				case 4:		BatchMultFixed_AVX512< 4, 4, 4 >( groups, a, b, c ); return;
+				case 8:		BatchMultFixed_AVX512< 8, 8, 8 >( groups, a, b, c ); return;
+				default:	break;
+			}
+
+		for( Dim g = 0; g < groups; ++ g, a += m * k * kBatch_Lanes, b += k * n * kBatch_Lanes, c += m * n * kBatch_Lanes )
+			for( Dim i = 0; i < m; ++ i )
+				for( Dim j = 0; j < n; ++ j )
+				{
+					__m512d acc = _mm512_setzero_pd();
+					for( Dim p = 0; p < k; ++ p )
+						acc = _mm512_fmadd_pd( _mm512_load_pd( a + ( i * k + p ) * kBatch_Lanes ), _mm512_load_pd( b + ( p * n + j ) * kBatch_Lanes ), acc );
+					_mm512_store_pd( c + ( i * n + j ) * kBatch_Lanes, acc );
+				}
+	}
+
+#endif // EM_X86_64
+
+
+
+	const EMKernels	kScalarKernels { Add_Scalar, Scale_Scalar, Axpy_Scalar, Dot_Scalar, MicroKernel_Scalar, PhiloxBlocks_Scalar, BatchMult_Scalar, DotI8_Scalar, DotI16_Scalar, 
+									CompensatedDot_Scalar< EDotAlg::kKahan >, CompensatedDot_Scalar< EDotAlg::kNeumaier >, CompensatedDot_Scalar< EDotAlg::kDot2 >, ESimdLevel::kScalar, "Scalar" };
+
+#if EM_X86_64
+	const EMKernels	kAVX2Kernels { Add_AVX2, Scale_AVX2, Axpy_AVX2, Dot_AVX2, MicroKernel_AVX2, PhiloxBlocks_AVX2, BatchMult_AVX2, DotI8_AVX2, DotI16_AVX2, 
+									CompensatedDot_AVX2< EDotAlg::kKahan >, CompensatedDot_AVX2< EDotAlg::kNeumaier >, CompensatedDot_AVX2< EDotAlg::kDot2 >, ESimdLevel::kAVX2, "AVX2+FMA" };
+	const EMKernels	kAVX512Kernels { Add_AVX512, Scale_AVX512, Axpy_AVX512, Dot_AVX512, MicroKernel_AVX512, PhiloxBlocks_AVX512, BatchMult_AVX512, DotI8_AVX2, DotI16_AVX2, 
+									CompensatedDot_AVX512< EDotAlg::kKahan >, CompensatedDot_AVX512< EDotAlg::kNeumaier >, CompensatedDot_AVX512< EDotAlg::kDot2 >, ESimdLevel::kAVX512, "AVX-512" };
+#endif
+
+
+	const EMKernels & SelectKernels( ESimdLevel level )
+	{
+	#if EM_X86_64
+		switch( std::min( level, GetCpuSimdLevel() ) )
+		{
+			case ESimdLevel::kAVX512:	return kAVX512Kernels;
+			case ESimdLevel::kAVX2:		return kAVX2Kernels;
+			default:					break;
+		}
+	#endif
+		return kScalarKernels;
+	}
+
+
+	// Constant-initialized, so it is valid even for the other static initializers.
+	// nullptr means not chosen yet - the best kernels are taken on the first use.
+	std::atomic< const EMKernels * >	gCurrentKernels { nullptr };
+
+}
+
+
+
+ESimdLevel		GetCpuSimdLevel( void )
+{
+#if EM_X86_64
+	#if defined( _MSC_VER )
+
+		int regs[ 4 ] {};
+		__cpuid( regs, 1 );
+		const bool fma		= ( regs[ 2 ] & ( 1 << 12 ) ) != 0;
+		const bool osxsave	= ( regs[ 2 ] & ( 1 << 27 ) ) != 0;
+		if( ! fma || ! osxsave )
+			return ESimdLevel::kScalar;
+
+		// The OS must save the ymm (and zmm) registers on context switches
+		const auto xcr0 = _xgetbv( 0 );
+		__cpuidex( regs, 7, 0 );
+		const bool avx2		= ( regs[ 1 ] & ( 1 << 5 ) ) != 0 && ( xcr0 & 0x06 ) == 0x06;
+		const bool avx512f	= ( regs[ 1 ] & ( 1 << 16 ) ) != 0 && ( xcr0 & 0xE6 ) == 0xE6;
+
+	#else
+
+		// These also check that the OS enabled the registers
+		__builtin_cpu_init();
+		const bool avx2		= __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" );
+		const bool avx512f	= __builtin_cpu_supports( "avx512f" );
+
+	#endif
+
+	if( avx512f && avx2 )
+		return ESimdLevel::kAVX512;
+	if( avx2 )
+		return ESimdLevel::kAVX2;
+#endif
+
+	return ESimdLevel::kScalar;
+}
+
+
+const EMKernels &	GetKernels( void )
+{
+	const EMKernels *	kernels = gCurrentKernels.load( std::memory_order_acquire );
+	if( kernels == nullptr )
+	{
+		// Threads that come here at the same time choose the same kernels.
+		// If SetSimdLevel was faster, its choice stays.
+		const EMKernels *	best = & SelectKernels( GetCpuSimdLevel() );
+		kernels = gCurrentKernels.compare_exchange_strong( kernels, best, std::memory_order_acq_rel ) ? best : kernels;
+	}
+	return * kernels;
+}
+
+
+void				SetSimdLevel( ESimdLevel level )
+{
+	gCurrentKernels.store( & SelectKernels( level ), std::memory_order_release );
+}
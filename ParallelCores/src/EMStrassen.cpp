@@ -0,0 +1,231 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+#include <algorithm>
+#include <omp.h>		// Header for OpenMP
+
+
+#include "EMGemm.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// Strassen-Winograd multiplication
+//
+// With A, B and C split into 2 x 2 blocks of size h = n / 2:
+//
+//	S1 = A21 + A22		T1 = B12 - B11		P1 = A11 * B11		P5 = S1 * T1
+//	S2 = S1 - A11		T2 = B22 - T1		P2 = A12 * B21		P6 = S2 * T2
+//	S3 = A11 - A21		T3 = B22 - B12		P3 = S4 * B22		P7 = S3 * T3
+//	S4 = A12 - S2		T4 = T2 - B21		P4 = A22 * T4
+//
+//	U2 = P1 + P6,	U3 = U2 + P7,	U4 = U2 + P5
+//
+//	C11 = P1 + P2,	C12 = U4 + P3,	C21 = U3 - P4,	C22 = U3 + P5
+//
+// All the temporaries come from one scratch buffer (the arena), allocated 
+// once before the recursion. Each level takes 15 h x h blocks from it 
+// and passes the rest to the lower levels.
+
+
+namespace
+{
+
+	// A square block inside a larger row-major buffer
+	struct Block
+	{
+		DataType *	fData;
+		Dim			fLD;	// leading dimension
+
+		DataType *	Row( Dim r ) const { return fData + r * fLD; }
+
+		// One of the four quadrants of size h: 
+		// ( 0, 0 ) = 11, ( 0, 1 ) = 12, ( 1, 0 ) = 21, ( 1, 1 ) = 22
+		Block		Quad( Dim h, Dim qr, Dim qc ) const { return { fData + qr * h * fLD + qc * h, fLD }; }
+	};
+
+
+	// z = x + y
+	void AddBlocks( Dim n, const Block & x, const Block & y, const Block & z )
+	{
+		for( Dim r = 0; r < n; ++ r )
+		{
+			const DataType * x_row = x.Row( r ), * y_row = y.Row( r );
+			DataType * z_row = z.Row( r );
+			for( Dim c = 0; c < n; ++ c )
+				z_row[ c ] = x_row[ c ] + y_row[ c ];
+		}
+	}
+
+	// z = x - y
+	void SubBlocks( Dim n, const Block & x, const Block & y, const Block & z )
+	{
+		for( Dim r = 0; r < n; ++ r )
+		{
+			const DataType * x_row = x.Row( r ), * y_row = y.Row( r );
+			DataType * z_row = z.Row( r );
+			for( Dim c = 0; c < n; ++ c )
+				z_row[ c ] = x_row[ c ] - y_row[ c ];
+		}
+	}
+
+
+	// The number of scratch elements needed for a product of size n.
+	// At the parallel levels each of the 7 products needs its own scratch.
+	Dim ScratchSize( Dim n, Dim cutoff, int par_levels )
+	{
+		if( n <= cutoff )
+			return 0;
+
+		const Dim h = n / 2;
+		const Dim child = ScratchSize( h, cutoff, par_levels - 1 );
+
+		return 15 * h * h + ( par_levels > 0 ? 7 : 1 ) * child;
+	}
+
+
+	// C = A * B, all of size n. n is cutoff * 2^levels.
+	void Strassen( Dim n, const Block & A, const Block & B, const Block & C, DataType * arena, Dim cutoff, int par_levels )
+	{
+		if( n <= cutoff )
+		{
+			for( Dim r = 0; r < n; ++ r )
+				std::fill_n( C.Row( r ), n, 0.0 );
+
+			Gemm_Blocked( n, n, n, A.fData, A.fLD, B.fData, B.fLD, C.fData, C.fLD );
+			return;
+		}
+
+		const Dim h = n / 2;
+
+		// Take 15 blocks h x h from the arena
+		Block tmp[ 15 ];
+		for( Dim i = 0; i < 15; ++ i )
+			tmp[ i ] = { arena + i * h * h, h };
+
+		DataType * child_arena = arena + 15 * h * h;
+		const Dim child_size = ScratchSize( h, cutoff, par_levels - 1 );
+
+		const Block & S1 = tmp[ 0 ], & S2 = tmp[ 1 ], & S3 = tmp[ 2 ], & S4 = tmp[ 3 ];
+		const Block & T1 = tmp[ 4 ], & T2 = tmp[ 5 ], & T3 = tmp[ 6 ], & T4 = tmp[ 7 ];
+		const Block * P = & tmp[ 8 ];	// P[ 0 ] .. P[ 6 ] are P1 .. P7
+
+		const Block A11 = A.Quad( h, 0, 0 ), A12 = A.Quad( h, 0, 1 ), A21 = A.Quad( h, 1, 0 ), A22 = A.Quad( h, 1, 1 );
+		const Block B11 = B.Quad( h, 0, 0 ), B12 = B.Quad( h, 0, 1 ), B21 = B.Quad( h, 1, 0 ), B22 = B.Quad( h, 1, 1 );
+		const Block C11 = C.Quad( h, 0, 0 ), C12 = C.Quad( h, 0, 1 ), C21 = C.Quad( h, 1, 0 ), C22 = C.Quad( h, 1, 1 );
+
+		AddBlocks( h, A21, A22, S1 );
+		SubBlocks( h, S1, A11, S2 );
+		SubBlocks( h, A11, A21, S3 );
+		SubBlocks( h, A12, S2, S4 );
+
+		SubBlocks( h, B12, B11, T1 );
+		SubBlocks( h, B22, T1, T2 );
+		SubBlocks( h, B22, B12, T3 );
+		SubBlocks( h, T2, B21, T4 );
+
+		// The 7 products and their operands
+		const Block left[ 7 ]	{ A11, A12, S4, A22, S1, S2, S3 };
+		const Block right[ 7 ]	{ B11, B21, B22, T4, T1, T2, T3 };
+
+		if( par_levels > 0 )
+		{
+			// Each task has its own part of the arena
+			for( int i = 0; i < 7; ++ i )
+			{
+				#pragma omp task firstprivate( i ) shared( left, right, P )
+				Strassen( h, left[ i ], right[ i ], P[ i ], child_arena + i * child_size, cutoff, par_levels - 1 );
+			}
+			#pragma omp taskwait
+		}
+		else
+		{
+			// One after another - all can reuse the same part of the arena
+			for( int i = 0; i < 7; ++ i )
+				Strassen( h, left[ i ], right[ i ], P[ i ], child_arena, cutoff, par_levels - 1 );
+		}
+
+		// Combine the products. U2, U3 and U4 are kept in P1, P6 and P7.
+		AddBlocks( h, P[ 0 ], P[ 1 ], C11 );		// C11 = P1 + P2
+		AddBlocks( h, P[ 0 ], P[ 5 ], P[ 5 ] );		// U2 = P1 + P6
+		AddBlocks( h, P[ 5 ], P[ 6 ], P[ 6 ] );		// U3 = U2 + P7
+		AddBlocks( h, P[ 5 ], P[ 4 ], P[ 5 ] );		// U4 = U2 + P5
+		AddBlocks( h, P[ 5 ], P[ 2 ], C12 );		// C12 = U4 + P3
+		SubBlocks( h, P[ 6 ], P[ 3 ], C21 );		// C21 = U3 - P4
+		AddBlocks( h, P[ 6 ], P[ 4 ], C22 );		// C22 = U3 + P5
+	}
+
+}
+
+
+
+EMatrix		MultMatrix_Strassen( const EMatrix & a, const EMatrix & b, Dim cutoff )
+{
+	const Dim n = a.GetRows();
+
+	assert( a.GetCols() == n && b.GetRows() == n && b.GetCols() == n );	// only square matrices
+	assert( cutoff > 0 );
+
+	if( n <= cutoff )
+		return MultMatrix_Blocked( a, b );
+
+	// Find the number of levels and the padded size m = leaf * 2^levels
+	int levels {};
+	Dim leaf = n;
+	while( leaf > cutoff )
+	{
+		leaf = ( leaf + 1 ) / 2;
+		++ levels;
+	}
+	const Dim m = leaf << levels;
+
+	// 7 tasks per level - use as many levels as needed to keep all threads busy
+	int par_levels {};
+	for( int tasks = 1; tasks < omp_get_max_threads() && par_levels < levels; tasks *= 7 )
+		++ par_levels;
+
+	// Zero padded copies of a and b
+	EMatrix a_pad( m, m, 0.0 ), b_pad( m, m, 0.0 ), c_pad( m, m );
+	for( Dim r = 0; r < n; ++ r )
+	{
+		std::copy_n( a.GetDataBuf() + r * a.GetLeadDim(), n, a_pad.GetDataBuf() + r * a_pad.GetLeadDim() );
+		std::copy_n( b.GetDataBuf() + r * b.GetLeadDim(), n, b_pad.GetDataBuf() + r * b_pad.GetLeadDim() );
+	}
+
+	// The arena for all levels
+	auto arena = EMatrix::AllocDataBuf( ScratchSize( m, cutoff, par_levels ) );
+
+	const Block A { a_pad.GetDataBuf(), a_pad.GetLeadDim() };
+	const Block B { b_pad.GetDataBuf(), b_pad.GetLeadDim() };
+	const Block C { c_pad.GetDataBuf(), c_pad.GetLeadDim() };
+
+	if( par_levels > 0 )
+	{
+		#pragma omp parallel
+		#pragma omp single
+		Strassen( m, A, B, C, arena.get(), cutoff, par_levels );
+	}
+	else
+	{
+		Strassen( m, A, B, C, arena.get(), cutoff, par_levels );
+	}
+
+	// Cut out the n x n result
+	EMatrix c( n, n );
+	for( Dim r = 0; r < n; ++ r )
+		std::copy_n( c_pad.GetDataBuf() + r * c_pad.GetLeadDim(), n, c.GetDataBuf() + r * c.GetLeadDim() );
+
+	return c;
+}
@@ -0,0 +1,243 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <mutex>
+
+
+#include "EMTaskGraph.h"
+#include "EMGemm.h"
+#include "EMSimd.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// EMTaskGraph
+
+
+struct EMTaskGraph::RunState
+{
+	EMTaskGraph &				fGraph;
+	EMThreadPool &				fPool;
+
+	std::atomic< std::size_t >	fLeft;				// tasks not finished yet
+	std::atomic< bool >			fFailed { false };
+
+	std::mutex					fErrorMutex;
+	std::exception_ptr			fError;
+
+	RunState( EMTaskGraph & graph, EMThreadPool & pool ) : fGraph( graph ), fPool( pool ), fLeft( graph.fNodes.size() ) {}
+};
+
+
+EMTaskGraph::TaskId		EMTaskGraph::AddTask( std::function< void( void ) > work, std::vector< TaskId > deps )
+{
+	const TaskId id = fNodes.size();
+
+	// The same predecessor could be given many times
+	std::sort( deps.begin(), deps.end() );
+	deps.erase( std::unique( deps.begin(), deps.end() ), deps.end() );
+
+	fNodes.emplace_back();
+	Node & node = fNodes.back();
+	node.fWork		= std::move( work );
+	node.fNumOfDeps	= deps.size();
+
+	for( const auto d : deps )
+	{
+		assert( d < id );		// only earlier tasks, so there are no cycles
+		fNodes[ d ].fSuccessors.push_back( id );
+	}
+
+	return id;
+}
+
+
+void	EMTaskGraph::RunTask( const std::shared_ptr< RunState > & state, TaskId id )
+{
+	Node & node = state->fGraph.fNodes[ id ];
+
+	if( ! state->fFailed.load( std::memory_order_acquire ) )
+	{
+		try
+		{
+			node.fWork();
+		}
+		catch( ... )
+		{
+			std::lock_guard< std::mutex >	lock( state->fErrorMutex );
+			if( ! state->fError )
+				state->fError = std::current_exception();
+			state->fFailed = true;
+		}
+	}
+
+	// The last finished predecessor starts the successor
+	for( const auto s : node.fSuccessors )
+		if( state->fGraph.fNodes[ s ].fDepsLeft.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+			state->fPool.Push( [ state, s ] { RunTask( state, s ); } );
+
+	state->fLeft.fetch_sub( 1, std::memory_order_release );
+}
+
+
+void	EMTaskGraph::Run( EMThreadPool & pool )
+{
+	if( fNodes.empty() )
+		return;
+
+	for( auto & node : fNodes )
+		node.fDepsLeft.store( node.fNumOfDeps, std::memory_order_relaxed );
+
+	// The tasks own the state, so it lives until the last of them is destroyed
+	auto state = std::make_shared< RunState >( * this, pool );
+
+	for( TaskId id = 0; id < fNodes.size(); ++ id )
+		if( fNodes[ id ].fNumOfDeps == 0 )
+			pool.Push( [ state, id ] { RunTask( state, id ); } );
+
+	pool.HelpUntil( state->fLeft );
+
+	if( state->fError )
+		std::rethrow_exception( state->fError );
+}
+
+
+
+// ------------------------------------------------------------------------
+// EMTilePipeline
+
+
+void	EMTilePipeline::AddTileTask( std::function< void( void ) > work, const std::vector< TileKey > & reads, const std::vector< TileKey > & writes )
+{
+	std::vector< TaskId >	deps;
+
+	// Read after write
+	for( const auto & key : reads )
+		if( auto & acc = fAccess[ key ]; acc.fHasWriter )
+			deps.push_back( acc.fWriter );
+
+	// Write after write and write after read
+	for( const auto & key : writes )
+	{
+		auto & acc = fAccess[ key ];
+		if( acc.fHasWriter )
+			deps.push_back( acc.fWriter );
+		deps.insert( deps.end(), acc.fReaders.begin(), acc.fReaders.end() );
+	}
+
+	const TaskId id = fGraph.AddTask( std::move( work ), std::move( deps ) );
+
+	for( const auto & key : reads )
+		fAccess[ key ].fReaders.push_back( id );
+
+	for( const auto & key : writes )
+	{
+		auto & acc = fAccess[ key ];
+		acc.fHasWriter	= true;
+		acc.fWriter		= id;
+		acc.fReaders.clear();
+	}
+}
+
+
+void	EMTilePipeline::Run( EMThreadPool & pool )
+{
+	// The tasks write the outputs from many threads, so their buffers cannot 
+	// be shared then - a copy-on-write matrix gets its own buffer here, in one thread.
+	// In the tasks GetDataBuf of an output is then only a check, it never copies.
+	for( auto * m : fOutputs )
+		m->MakeUnique();
+
+	fGraph.Run( pool );
+}
+
+
+void	EMTilePipeline::Mult( const EMatrix & a, const EMatrix & b, EMatrix & c )
+{
+	assert( a.GetCols() == b.GetRows() );
+	assert( c.GetRows() == a.GetRows() && c.GetCols() == b.GetCols() );
+	assert( & c != & a && & c != & b );
+
+	fOutputs.push_back( & c );
+
+	const Dim	K = a.GetCols();
+	const Dim	tk = GetTileCols( a );
+
+	for( Dim ti = 0; ti < GetTileRows( c ); ++ ti )
+	{
+		for( Dim tj = 0; tj < GetTileCols( c ); ++ tj )
+		{
+			// The tile of c needs a row of tiles of a and a column of tiles of b
+			std::vector< TileKey >	reads;
+			for( Dim k = 0; k < tk; ++ k )
+			{
+				reads.push_back( GetKey( a, ti, k ) );
+				reads.push_back( GetKey( b, k, tj ) );
+			}
+
+			const Dim r0 = ti * fTile, c0 = tj * fTile;
+			const Dim rows = std::min( fTile, c.GetRows() - r0 ), cols = std::min( fTile, c.GetCols() - c0 );
+
+			// The matrices are captured by pointers, so they must live until Run ends
+			auto work = [ pa = & a, pb = & b, pc = & c, r0, c0, rows, cols, K ] ()
+			{
+				DataType *	C = pc->GetDataBuf() + r0 * pc->GetLeadDim() + c0;
+				for( Dim r = 0; r < rows; ++ r )
+					std::fill( C + r * pc->GetLeadDim(), C + r * pc->GetLeadDim() + cols, 0.0 );
+
+				// One thread per tile - the other threads compute the other tiles
+				Gemm_Tile(	rows, cols, K, 
+							pa->GetDataBuf() + r0 * pa->GetLeadDim(), pa->GetLeadDim(), 
+							pb->GetDataBuf() + c0, pb->GetLeadDim(), 
+							C, pc->GetLeadDim() );
+			};
+
+			AddTileTask( work, reads, { GetKey( c, ti, tj ) } );
+		}
+	}
+}
+
+
+void	EMTilePipeline::Add( const EMatrix & a, const EMatrix & b, EMatrix & c )
+{
+	assert( a.GetRows() == b.GetRows() && a.GetCols() == b.GetCols() );
+	assert( c.GetRows() == a.GetRows() && c.GetCols() == a.GetCols() );
+
+	fOutputs.push_back( & c );
+
+	for( Dim ti = 0; ti < GetTileRows( c ); ++ ti )
+	{
+		for( Dim tj = 0; tj < GetTileCols( c ); ++ tj )
+		{
+			const Dim r0 = ti * fTile, c0 = tj * fTile;
+			const Dim rows = std::min( fTile, c.GetRows() - r0 ), cols = std::min( fTile, c.GetCols() - c0 );
+
+			auto work = [ pa = & a, pb = & b, pc = & c, r0, c0, rows, cols ] ()
+			{
+				const auto add = GetKernels().Add;
+				for( Dim r = r0; r < r0 + rows; ++ r )
+					add(	cols, 
+							pa->GetDataBuf() + r * pa->GetLeadDim() + c0, 
+							pb->GetDataBuf() + r * pb->GetLeadDim() + c0, 
+							pc->GetDataBuf() + r * pc->GetLeadDim() + c0 );
+			};
+
+			AddTileTask( work, { GetKey( a, ti, tj ), GetKey( b, ti, tj ) }, { GetKey( c, ti, tj ) } );
+		}
+	}
+}
+
+
@@ -0,0 +1,171 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#include <cassert>
+
+
+#include "EMThreadPool.h"
+
+
+
+
+namespace
+{
+
+	// Tells a worker its pool and its deque
+	thread_local EMThreadPool *		gWorkerPool { nullptr };
+	thread_local std::size_t		gWorkerIndex { 0 };
+
+}
+
+
+
+EMThreadPool::EMThreadPool( std::size_t num_of_threads )
+{
+	num_of_threads = std::max< std::size_t >( num_of_threads, 1 );
+
+	// All deques must exist before any worker starts to steal
+	for( std::size_t i = 0; i < num_of_threads; ++ i )
+		fQueues.push_back( std::make_unique< WorkQueue >() );
+
+	for( std::size_t i = 0; i < num_of_threads; ++ i )
+		fThreads.emplace_back( & EMThreadPool::WorkerLoop, this, i );
+}
+
+
+EMThreadPool::~EMThreadPool()
+{
+	{
+		std::lock_guard< std::mutex >	lock( fSleepMutex );
+		fStop = true;
+	}
+	fWakeUp.notify_all();
+
+	for( auto & t : fThreads )
+		t.join();
+}
+
+
+EMThreadPool &	EMThreadPool::GetDefault( void )
+{
+	static EMThreadPool		pool;		// thread safe initialization since C++11
+	return pool;
+}
+
+
+std::size_t		EMThreadPool::GetChunk( std::size_t elems, std::size_t chunk ) const
+{
+	if( chunk == 0 )
+		chunk = elems / ( kChunksPerThread * GetThreads() );
+	return std::max< std::size_t >( chunk, 1 );
+}
+
+
+void	EMThreadPool::Push( Task task )
+{
+	// A worker puts new tasks to its own deque (the others will steal them),
+	// tasks from outside go to the deques in turn
+	const std::size_t	index = gWorkerPool == this ? gWorkerIndex : fNextQueue.fetch_add( 1, std::memory_order_relaxed ) % fQueues.size();
+
+	{
+		// Counted before it is visible, so a thief never makes fPending negative.
+		// Under the lock, so a worker cannot miss it between checking fPending and going to sleep.
+		std::lock_guard< std::mutex >	lock( fSleepMutex );
+		++ fPending;
+	}
+
+	{
+		std::lock_guard< std::mutex >	lock( fQueues[ index ]->fMutex );
+		fQueues[ index ]->fTasks.push_back( std::move( task ) );
+	}
+	fWakeUp.notify_one();
+}
+
+
+bool	EMThreadPool::TryGetTask( Task & task )
+{
+	const std::size_t	kQueues = fQueues.size();
+	const bool			is_worker = gWorkerPool == this;
+
+	if( is_worker )
+	{
+		auto & own = * fQueues[ gWorkerIndex ];
+		std::lock_guard< std::mutex >	lock( own.fMutex );
+		if( ! own.fTasks.empty() )
+		{
+			task = std::move( own.fTasks.back() );
+			own.fTasks.pop_back();
+			-- fPending;
+			return true;
+		}
+	}
+
+	// Steal the oldest task of another deque, starting from the next one
+	const std::size_t	start = is_worker ? gWorkerIndex + 1 : fNextQueue.load( std::memory_order_relaxed );
+	for( std::size_t k = 0; k < kQueues; ++ k )
+	{
+		auto & victim = * fQueues[ ( start + k ) % kQueues ];
+		std::lock_guard< std::mutex >	lock( victim.fMutex );
+		if( ! victim.fTasks.empty() )
+		{
+			task = std::move( victim.fTasks.front() );
+			victim.fTasks.pop_front();
+			-- fPending;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void	EMThreadPool::HelpUntil( const std::atomic< std::size_t > & left )
+{
+	Task	task;
+	while( left.load( std::memory_order_acquire ) > 0 )
+	{
+		if( TryGetTask( task ) )
+		{
+			task();
+			task = nullptr;
+		}
+		else
+		{
+			std::this_thread::yield();		// the last chunks are running in other threads
+		}
+	}
+}
+
+
+void	EMThreadPool::WorkerLoop( std::size_t index )
+{
+	gWorkerPool		= this;
+	gWorkerIndex	= index;
+
+	Task	task;
+	for( ;; )
+	{
+		if( TryGetTask( task ) )
+		{
+			task();
+			task = nullptr;		// frees the captured objects now
+			continue;
+		}
+
+		std::unique_lock< std::mutex >	lock( fSleepMutex );
+		fWakeUp.wait( lock, [ this ] { return fStop || fPending > 0; } );
+		if( fStop && fPending == 0 )
+			return;
+	}
+}
+
+
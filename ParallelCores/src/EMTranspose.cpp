@@ -0,0 +1,126 @@
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+
+
+
+#include <algorithm>
+#include <omp.h>		// Header for OpenMP
+
+
+#include "EMTranspose.h"
+
+
+
+
+namespace
+{
+
+	void TransposeRec( Dim rows, Dim cols, const DataType * A, Dim lda, DataType * B, Dim ldb )
+	{
+		if( rows <= kTranspose_Leaf && cols <= kTranspose_Leaf )
+		{
+			// A small block - both A and B are in the cache
+			for( Dim r = 0; r < rows; ++ r )
+				for( Dim c = 0; c < cols; ++ c )
+					B[ c * ldb + r ] = A[ r * lda + c ];
+
+			return;
+		}
+
+		const bool big = rows * cols > kTranspose_TaskElems;
+
+		// Split the larger dimension - top rows of A go to the left columns of B, etc.
+		if( rows >= cols )
+		{
+			const Dim h = rows / 2;
+
+			#pragma omp task if( big )
+			TransposeRec( h, cols, A, lda, B, ldb );
+
+			TransposeRec( rows - h, cols, A + h * lda, lda, B + h, ldb );
+		}
+		else
+		{
+			const Dim h = cols / 2;
+
+			#pragma omp task if( big )
+			TransposeRec( rows, h, A, lda, B, ldb );
+
+			TransposeRec( rows, cols - h, A + h, lda, B + h * ldb, ldb );
+		}
+
+		#pragma omp taskwait
+	}
+
+}
+
+
+
+void		Transpose_Raw( Dim rows, Dim cols, const DataType * A, Dim lda, DataType * B, Dim ldb )
+{
+	if( rows * cols <= kTranspose_TaskElems )
+	{
+		TransposeRec( rows, cols, A, lda, B, ldb );
+		return;
+	}
+
+	// One thread starts the recursion, the others pick up the tasks
+	#pragma omp parallel shared( rows, cols, A, lda, B, ldb )
+	#pragma omp single
+	TransposeRec( rows, cols, A, lda, B, ldb );
+}
+
+
+
+EMatrix		Transpose( const EMatrix & a )
+{
+	EMatrix	b( a.GetCols(), a.GetRows() );
+
+	Transpose_Raw( a.GetRows(), a.GetCols(), a.GetDataBuf(), a.GetLeadDim(), b.GetDataBuf(), b.GetLeadDim() );
+
+	return b;
+}
+
+
+
+void		TransposeInPlace( EMatrix & a )
+{
+	assert( a.GetRows() == a.GetCols() );		// only square matrices
+
+	const auto n = a.GetRows();
+	const auto ld = a.GetLeadDim();
+	DataType * data = a.GetDataBuf();
+
+	const Dim tiles = ( n + kTranspose_Tile - 1 ) / kTranspose_Tile;
+
+	// Tile (ti,tj) above the diagonal is swapped with the tile (tj,ti) below.
+	// Rows of tiles get shorter, hence the dynamic schedule.
+	#pragma omp parallel for \
+			shared( n, ld, data, tiles ) \
+			schedule( dynamic )
+	for( Dim ti = 0; ti < tiles; ++ ti )
+		for( Dim tj = ti; tj < tiles; ++ tj )
+		{
+			const Dim r0 = ti * kTranspose_Tile, r1 = std::min( n, r0 + kTranspose_Tile );
+			const Dim c0 = tj * kTranspose_Tile, c1 = std::min( n, c0 + kTranspose_Tile );
+
+			// In the diagonal tiles only the elements above the diagonal are swapped
+			for( Dim r = r0; r < r1; ++ r )
+				for( Dim c = std::max( c0, r + 1 ); c < c1; ++ c )
+					std::swap( data[ r * ld + c ], data[ c * ld + r ] );
+		}
+}
+
+
+
@@ -1,319 +1,1433 @@
-// ==========================================================================
-//
-// Software written by Boguslaw Cyganek (C) to be used with the book:
-// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
-// Published by Wiley, 2020
-//
-// The software is supplied as is and for educational purposes
-// without any guarantees nor responsibility of its use in any application. 
-//
-// ==========================================================================
-
-
-
-#include <iostream>
-#include <iomanip>
-#include <sstream>
-#include <omp.h>		// Header for OpenMP
-
-
-
-#include "EMUtility.h"
-#include "MarsXorShift.h"
-
-
-
-
-// ------------------------------------------------------------------------
-// Parallel versions
-
-
-
-
-
-
-void OpenMP_Test( void )
-{
-	// This is a shared objects - the same for all threads.
-	// A problem might happen if many threads want to 
-	// write it SIMULTANEOUSLY.
-	std::ostringstream outStream;
-
-	// We start with a serial code executed by one thread line-after-line
-	outStream << "Beginning with " << omp_get_num_threads() << " thread(s).\n";
-	outStream << "Let's enter the omp parallel ...\n";
-
-	// Before the parallel section can set a number 
-	// of threads in a thread-team (do not confuse with cores)
-	//omp_set_num_threads( 36 );	
-
-	// ------------------------
-	// --- This is PARALLEL ---
-	// Let's see the TEAM of threads in action
-	// However, declaring an object as shared
-	// does NOT automatically makes its access
-	// thread safe.
-	#pragma omp parallel shared( outStream )
-	{
-		// This is a local variable; each thread has 
-		// its own copy of it.
-		auto thisThreadNo = omp_get_thread_num();
-
-		// This is also a local object.
-		const auto kNumOfThreads = omp_get_num_threads();
-
-		// Let's use 'critical' to allow execution of
-		// only one thread at a time - otherwise there
-		// will be a mess on the screen.
-		// Do NOT forget the 'omp' keyword here
-		#pragma omp critical ( critical_0 )
-		{
-			outStream << "I'm thread no. " << thisThreadNo << " / " << kNumOfThreads << "\n";
-		}
-
-	}
-	// Here is the SYNCHRONIZATION BARRIER - after that, all threads have finished
-	// only the master executes
-	// --- End of PARALLEL ---
-	// ------------------------
-
-	// One (master) thread again, no synchronization necessary.
-	outStream << "After crossing the parallel BARRIER we run " << omp_get_num_threads() << " thread(s).\n";
-
-	// Let see what we gathered
-	std::cout << outStream.str() << std::endl;
-
-}
-
-
-
-// Computes pi with arctan(1) series summation.
-// N - the number of terms in the series.
-double Compute_Pi( int N )
-{
-	const double dx = 1.0 / static_cast< double >( N );
-
-	// This is a SHARED variable
-	double sum {};
-
-	// -------------------------------------
-	#pragma omp parallel for reduction( + : sum )	if( N > 1000000 )
-	for( auto i = 0; i < N; ++ i )
-	{
-		auto c_i = dx * ( static_cast< double >( i ) + 0.5 );	// This is a local variable
-		
-		// sum is shared, but unique access is guaranteed by the reduction
-		sum += 1.0 / ( 1.0 + c_i * c_i );	
-	}
-	// -------------------------------------
-
-	return 4.0 * dx * sum;
-}
-
-
-
-void OpenMP_Pi_Test( void )
-{
-
-	auto N_list = { 100, 1000, 10000, 100000000 };
-
-	for( const auto N : N_list )
-	{
-		// Returns the number of seconds since the OS start-up.
-		auto start_time = omp_get_wtime();	// Get start point
-			auto pi = Compute_Pi( N );		// Do computations
-		auto exec_time = omp_get_wtime() - start_time;	// End time
-
-		std::cout	<< "pi(" << N << ")=" << std::setprecision( 12 ) 
-					<< pi << " in " << exec_time << std::endl;
-	}
-
-}
-
-
-
-
-
-
-// Overloaded operators 
-
-// It can be used as follows: c = a + b;
-EMatrix		operator + ( const EMatrix & a, const EMatrix & b )
-{
-	const auto a_cols = a.GetCols();
-	const auto a_rows = a.GetRows();
-
-	const auto b_cols = b.GetCols();
-	const auto b_rows = b.GetRows();	
-
-	assert( a_rows == b_rows );	// dim must be the same
-	assert( a_cols == b_cols );
-
-	EMatrix	c { a };	// Make c the same as a
-
-						// Split the outermost for loop and run each chunk in a separate thread
-#pragma omp parallel for \
-		shared( b, c, b_rows, b_cols ) \
-		default( none ) \
-		schedule( static )
-
-	for( Dim row = 0; row < b_rows; ++ row )
-		for( Dim col = 0; col < b_cols; ++ col )
-			c[ row ][ col ] += b[ row ][ col ];
-
-	return c;
-}
-
-// It can be used as follows: c = a * b;
-EMatrix		operator * ( const EMatrix & a, const EMatrix & b )
-{
-	const auto a_cols = a.GetCols();
-	const auto a_rows = a.GetRows();
-
-	const auto b_cols = b.GetCols();
-	const auto b_rows = b.GetRows();	
-
-	assert( a_cols == b_rows );			// Dimensions must be the same
-
-	EMatrix	c( a_rows, b_cols, 0.0 );	// Output matrix has these dimensions
-
-	// Split the outer-most for loop and run each chunk in a separate thread
-	#pragma omp parallel for \
-			shared( a, b, c, a_rows, b_cols, a_cols ) \
-			default( none ) \
-			schedule( static )
-	// Only the outermost loop will be made parallel 
-	for( Dim ar = 0; ar < a_rows; ++ ar )	// Traverse rows of a
-		for( Dim bc = 0; bc < b_cols; ++ bc )	// Traverse cols of b
-			for( Dim ac = 0; ac < a_cols; ++ ac ) // Traverse cols of a == rows of b
-				c[ ar ][ bc ] += a[ ar ][ ac ] * b[ ac ][ bc ];
-
-
-	return c;
-}
-
-
-
-
-// Does random initialization of a matrix m
-void RandInit( EMatrix & m )
-{
-	MarsXorShift	randMachine;
-	for( auto & row : m )			// go row-by-row
-		for( auto & data : row )	// go through data in a single row
-			data = randMachine.GetNext() & 0xFFFF;	// cast, type promotion
-}
-
-
-
-
-void OpenMP_MultMatrix_Test( void )
-{
-	const auto kCols { 1024 }, kRows { 1024 };
-	EMatrix		a( kCols, kRows ), b( kRows, kCols );
-
-	RandInit( a );
-	RandInit( b );
-
-	auto start_time = omp_get_wtime();	// Get time start point
-
-	EMatrix		c( a * b );				
-
-	auto exec_time = omp_get_wtime() - start_time;	// End time
-
-
-	std::cout << "Middle elem val: " << c[ kCols / 2 ][ kCols / 2 ] << std::endl;
-	std::cout << "Computation time: " << exec_time << std::endl;
-}
-
-
-void OpenMP_MultMatrix_Test_1( void )
-{
-	const auto kCols { 1024 }, kRows { 1024 };
-
-	const auto N = { 1024, 2048, 4096 };
-
-	std::cout << "Matrix multiplication test ..." << std::endl;
-
-	for( const auto dim : N )
-	{
-
-
-		EMatrix		a( dim, dim ), b( dim, dim );
-
-		RandInit( a );
-		RandInit( b );
-
-		auto start_time = omp_get_wtime();	// Get time start point
-
-		EMatrix		c( a * b );				
-
-		auto exec_time = omp_get_wtime() - start_time;	// End time measurement
-
-
-		std::cout << "Elems: " << dim << std::endl;
-		std::cout << "Middle elem val: " << c[ kCols / 2 ][ kCols / 2 ] << std::endl;
-		std::cout << "Computation time: " << exec_time << std::endl << std::endl;
-
-	}
-
-}
-
-
-
-// ------------------------------------
-// An example of hazards due to 
-// an unprotected shared object
-
-int x;		// A global shared variable
-
-void Task_0( void )
-{
-	auto loc { x };	// Local object
-	
-	// Non-protected access to shared
-	x += 5;
-	
-	std::cout << loc << ", " << x << "\n";
-}
-
-void Task_1( void )
-{
-	#pragma omp critical ( section )
-	{
-		auto loc { x };	// Copy whatever value of x
-
-		x += 5;	// ok
-
-		std::cout << loc << ", " << x << "\n";
-	}
-}
-
-void Parallel_Tasks_Test( void )
-{
-	// There is nothing wrong with Task_0 
-	// when executed sequentially.
-	for( auto i : { 1, 2, 3, 4, 5 } )
-		Task_0();
-
-	std::cout << "\n\n";
-
-	// Run unprotected
-	#pragma omp parallel num_threads( 5 )
-	{		
-		Task_0();
-	}
-
-	// Run with critical section
-	#pragma omp parallel num_threads( 5 )
-	{
-		Task_1();
-	}
-
-}
-
-
-
-
-
-
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <numeric>
+#include <limits>
+#include <future>
+#include <tuple>
+#include <cstdio>
+#include <omp.h>		// Header for OpenMP
+
+
+
+#include "EMUtility.h"
+#include "EMGemm.h"
+#include "EMSimd.h"
+#include "MarsXorShift.h"
+#include "EMRandom.h"
+#include "EMLinAlg.h"
+#include "EMBatch.h"
+#include "TMatrixFor.h"
+#include "FxFor.h"
+#include "EMGemv.h"
+#include "EMArena.h"
+#include "EMThreadPool.h"
+#include "EMTaskGraph.h"
+#include "EMOutOfCore.h"
+#include "EMQuant.h"
+#include "EMPerf.h"
+#include "EMDot.h"
+
+
+
+
+// ------------------------------------------------------------------------
+// Parallel versions
+
+
+
+
+
+
+void OpenMP_Test( void )
+{
+	// This is a shared objects - the same for all threads.
+	// A problem might happen if many threads want to 
+	// write it SIMULTANEOUSLY.
+	std::ostringstream outStream;
+
+	// We start with a serial code executed by one thread line-after-line
+	outStream << "Beginning with " << omp_get_num_threads() << " thread(s).\n";
+	outStream << "Let's enter the omp parallel ...\n";
+
+	// Before the parallel section can set a number 
+	// of threads in a thread-team (do not confuse with cores)
+	//omp_set_num_threads( 36 );	
+
+	// ------------------------
+	// --- This is PARALLEL ---
+	// Let's see the TEAM of threads in action
+	// However, declaring an object as shared
+	// does NOT automatically makes its access
+	// thread safe.
+	#pragma omp parallel shared( outStream )
+	{
+		// This is a local variable; each thread has 
+		// its own copy of it.
+		auto thisThreadNo = omp_get_thread_num();
+
+		// This is also a local object.
+		const auto kNumOfThreads = omp_get_num_threads();
+
+		// Let's use 'critical' to allow execution of
+		// only one thread at a time - otherwise there
+		// will be a mess on the screen.
+		// Do NOT forget the 'omp' keyword here
+		#pragma omp critical ( critical_0 )
+		{
+			outStream << "I'm thread no. " << thisThreadNo << " / " << kNumOfThreads << "\n";
+		}
+
+	}
+	// Here is the SYNCHRONIZATION BARRIER - after that, all threads have finished
+	// only the master executes
+	// --- End of PARALLEL ---
+	// ------------------------
+
+	// One (master) thread again, no synchronization necessary.
+	outStream << "After crossing the parallel BARRIER we run " << omp_get_num_threads() << " thread(s).\n";
+
+	// Let see what we gathered
+	std::cout << outStream.str() << std::endl;
+
+}
+
+
+
+// Computes pi with arctan(1) series summation.
+// N - the number of terms in the series.
+double Compute_Pi( int N )
+{
+	const double dx = 1.0 / static_cast< double >( N );
+
+	// This is a SHARED variable
+	double sum {};
+
+	// -------------------------------------
+	#pragma omp parallel for reduction( + : sum )	if( N > 1000000 )
+	for( auto i = 0; i < N; ++ i )
+	{
+		auto c_i = dx * ( static_cast< double >( i ) + 0.5 );	// This is a local variable
+		
+		// sum is shared, but unique access is guaranteed by the reduction
+		sum += 1.0 / ( 1.0 + c_i * c_i );	
+	}
+	// -------------------------------------
+
+	return 4.0 * dx * sum;
+}
+
+
+
+void OpenMP_Pi_Test( void )
+{
+
+	auto N_list = { 100, 1000, 10000, 100000000 };
+
+	for( const auto N : N_list )
+	{
+		// Returns the number of seconds since the OS start-up.
+		auto start_time = omp_get_wtime();	// Get start point
+			auto pi = Compute_Pi( N );		// Do computations
+		auto exec_time = omp_get_wtime() - start_time;	// End time
+
+		std::cout	<< "pi(" << N << ")=" << std::setprecision( 12 ) 
+					<< pi << " in " << exec_time << std::endl;
+	}
+
+}
+
+
+
+
+
+
+// Overloaded operators are lazy - see EMExpr.h
+
+
+
+// The textbook version of the matrix multiplication.
+// It can be used as follows: c = MultMatrix_Naive( a, b );
+EMatrix		MultMatrix_Naive( const EMatrix & a, const EMatrix & b )
+{
+	const auto a_cols = a.GetCols();
+	const auto a_rows = a.GetRows();
+
+	const auto b_cols = b.GetCols();
+	const auto b_rows = b.GetRows();	
+
+	assert( a_cols == b_rows );			// Dimensions must be the same
+
+	EMatrix	c( a_rows, b_cols, 0.0 );	// Output matrix has these dimensions
+
+	const DataType *	a_data = a.GetDataBuf();
+	const DataType *	b_data = b.GetDataBuf();
+	DataType *			c_data = c.GetDataBuf();
+
+	const auto a_ld = a.GetLeadDim();
+	const auto b_ld = b.GetLeadDim();
+	const auto c_ld = c.GetLeadDim();
+
+	// Split the outer-most for loop and run each chunk in a separate thread
+	#pragma omp parallel for \
+			shared( a_data, b_data, c_data, a_rows, b_cols, a_cols, a_ld, b_ld, c_ld ) \
+			default( none ) \
+			schedule( static )
+	// Only the outermost loop will be made parallel 
+	for( Dim ar = 0; ar < a_rows; ++ ar )	// Traverse rows of a
+		for( Dim ac = 0; ac < a_cols; ++ ac ) // Traverse cols of a == rows of b
+		{
+			const auto a_val = a_data[ ar * a_ld + ac ];
+			// The innermost loop goes along rows of b and c, i.e. with a unit stride
+			for( Dim bc = 0; bc < b_cols; ++ bc )	// Traverse cols of b
+				c_data[ ar * c_ld + bc ] += a_val * b_data[ ac * b_ld + bc ];
+		}
+
+
+	return c;
+}
+
+// Accumulates a scaled matrix: y += alpha * x;
+void		Axpy( DataType alpha, const EMatrix & x, EMatrix & y )
+{
+	y += alpha * x;		// goes to the SIMD axpy kernel
+}
+
+
+
+
+// Does random initialization of a matrix m.
+// Each element depends only on the seed and its position, so the rows
+// are filled in parallel and the result is the same for any number of threads.
+void RandInit( EMatrix & m, std::uint64_t seed )
+{
+	const auto rows = m.GetRows();
+	const auto cols = m.GetCols();
+	const auto ld = m.GetLeadDim();
+
+	DataType *	data = m.GetDataBuf();
+
+	#pragma omp parallel \
+			shared( data, rows, cols, ld, seed ) \
+			default( none )
+	{
+		std::vector< int >	row_buf( cols );		// one for each thread
+
+		#pragma omp for schedule( static )
+		for( Dim r = 0; r < rows; ++ r )
+		{
+			// Row r takes cols values from the position r * cols
+			PhiloxRandom::GenerateUniformInt( seed, r * cols, cols, row_buf.data(), 0, 0xFFFF );
+			std::copy( row_buf.begin(), row_buf.end(), data + r * ld );
+		}
+	}
+}
+
+// Does random initialization of a matrix m - each call gives different values
+void RandInit( EMatrix & m )
+{
+	RandInit( m, MarsXorShift::InitSeed() );
+}
+
+
+
+
+void OpenMP_MultMatrix_Test( void )
+{
+	const auto kCols { 1024 }, kRows { 1024 };
+	EMatrix		a( kCols, kRows ), b( kRows, kCols );
+
+	RandInit( a );
+	RandInit( b );
+
+	auto start_time = omp_get_wtime();	// Get time start point
+
+	EMatrix		c( a * b );				
+
+	auto exec_time = omp_get_wtime() - start_time;	// End time
+
+
+	std::cout << "Middle elem val: " << c[ kCols / 2 ][ kCols / 2 ] << std::endl;
+	std::cout << "Computation time: " << exec_time << std::endl;
+}
+
+
+void OpenMP_MultMatrix_Test_1( void )
+{
+	const auto kCols { 1024 }, kRows { 1024 };
+
+	const auto N = { 1024, 2048, 4096 };
+
+	std::cout << "Matrix multiplication test ..." << std::endl;
+
+	for( const auto dim : N )
+	{
+
+
+		EMatrix		a( dim, dim ), b( dim, dim );
+
+		RandInit( a );
+		RandInit( b );
+
+		auto start_time = omp_get_wtime();	// Get time start point
+
+		EMatrix		c( a * b );				
+
+		auto exec_time = omp_get_wtime() - start_time;	// End time measurement
+
+
+		std::cout << "Elems: " << dim << std::endl;
+		std::cout << "Middle elem val: " << c[ kCols / 2 ][ kCols / 2 ] << std::endl;
+		std::cout << "Computation time: " << exec_time << std::endl << std::endl;
+
+	}
+
+}
+
+
+
+// Compares the naive and the blocked multiplications
+// in terms of the computation time and GFLOP/s
+void OpenMP_MultMatrix_Blocked_Test( void )
+{
+	const auto N = { 512, 1024, 2048 };
+
+	std::cout << "Naive vs. blocked matrix multiplication test ..." << std::endl;
+
+	for( const auto dim : N )
+	{
+		EMatrix		a( dim, dim ), b( dim, dim );
+
+		RandInit( a );
+		RandInit( b );
+
+		// One multiply-add is 2 floating-point operations
+		const auto kFlops = 2.0 * dim * dim * dim;
+
+		auto start_time = omp_get_wtime();
+		EMatrix		c_naive( MultMatrix_Naive( a, b ) );
+		auto exec_time_naive = omp_get_wtime() - start_time;
+
+		start_time = omp_get_wtime();
+		EMatrix		c_blocked( MultMatrix_Blocked( a, b ) );
+		auto exec_time_blocked = omp_get_wtime() - start_time;
+
+		// Both should give the same results up to the rounding errors
+		DataType max_diff {};
+		for( Dim r = 0; r < c_naive.GetRows(); ++ r )
+			for( Dim c = 0; c < c_naive.GetCols(); ++ c )
+				max_diff = std::max( max_diff, std::fabs( c_naive[ r ][ c ] - c_blocked[ r ][ c ] ) );
+
+		std::cout << "Elems: " << dim << " x " << dim << std::endl;
+		std::cout << "Naive:   " << exec_time_naive << " s, " << kFlops / exec_time_naive * 1e-9 << " GFLOP/s" << std::endl;
+		std::cout << "Blocked: " << exec_time_blocked << " s, " << kFlops / exec_time_blocked * 1e-9 << " GFLOP/s" << std::endl;
+		std::cout << "Max difference: " << max_diff << std::endl << std::endl;
+	}
+
+}
+
+
+
+// Runs the same multiplication with each of the SIMD kernels
+// available on this CPU, starting from the scalar one
+void SIMD_MultMatrix_Test( void )
+{
+	const auto dim { 1024 };
+
+	EMatrix		a( dim, dim ), b( dim, dim );
+
+	RandInit( a );
+	RandInit( b );
+
+	const auto kFlops = 2.0 * dim * dim * dim;
+
+	for( auto level : { ESimdLevel::kScalar, ESimdLevel::kAVX2, ESimdLevel::kAVX512 } )
+	{
+		if( level > GetCpuSimdLevel() )
+			break;
+
+		SetSimdLevel( level );
+
+		auto start_time = omp_get_wtime();
+		EMatrix		c( a * b );
+		auto exec_time = omp_get_wtime() - start_time;
+
+		std::cout	<< GetKernels().fName << ": " << exec_time << " s, " 
+					<< kFlops / exec_time * 1e-9 << " GFLOP/s, middle elem val: " << c[ dim / 2 ][ dim / 2 ] << std::endl;
+	}
+
+	// Go back to the best one
+	SetSimdLevel( GetCpuSimdLevel() );
+}
+
+
+
+// Compares the Strassen-Winograd and the blocked multiplications
+// for large square matrices and a few cutoff sizes
+void Strassen_MultMatrix_Test( void )
+{
+	const auto dim { 4096 };
+
+	EMatrix		a( dim, dim ), b( dim, dim );
+
+	RandInit( a );
+	RandInit( b );
+
+	auto start_time = omp_get_wtime();
+	EMatrix		c_blocked( MultMatrix_Blocked( a, b ) );
+	auto exec_time = omp_get_wtime() - start_time;
+
+	std::cout << "Blocked: " << exec_time << " s" << std::endl;
+
+	for( const Dim cutoff : { 512, 1024, 2048 } )
+	{
+		start_time = omp_get_wtime();
+		EMatrix		c_strassen( MultMatrix_Strassen( a, b, cutoff ) );
+		exec_time = omp_get_wtime() - start_time;
+
+		// Strassen has somewhat larger rounding errors
+		DataType max_rel_diff {};
+		for( Dim r = 0; r < dim; ++ r )
+			for( Dim c = 0; c < dim; ++ c )
+				max_rel_diff = std::max( max_rel_diff, std::fabs( c_blocked[ r ][ c ] - c_strassen[ r ][ c ] ) / std::fabs( c_blocked[ r ][ c ] ) );
+
+		std::cout << "Strassen, cutoff " << cutoff << ": " << exec_time << " s, max relative difference: " << max_rel_diff << std::endl;
+	}
+}
+
+
+
+// Shows that chained expressions are evaluated in one pass
+void ExprTemplates_Test( void )
+{
+	const auto dim { 512 };
+
+	EMatrix		a( dim, dim ), b( dim, dim ), c( dim, dim ), d( dim, dim );
+
+	RandInit( a, 1 );
+	RandInit( b, 2 );
+	RandInit( c, 3 );
+	RandInit( d, 4 );
+
+	// The references are computed element by element and with the naive product
+	const EMatrix	ab( MultMatrix_Naive( a, b ) );
+
+	auto reference = [ dim ] ( auto f )
+	{
+		EMatrix	m( dim, dim );
+		for( Dim r = 0; r < dim; ++ r )
+			for( Dim k = 0; k < dim; ++ k )
+				m[ r ][ k ] = f( r, k );
+		return m;
+	};
+
+	// The largest difference, relative to the largest element of the reference
+	auto check = [ dim ] ( const std::string & name, const EMatrix & x, const EMatrix & ref )
+	{
+		DataType max_diff {}, max_ref {};
+		for( Dim r = 0; r < dim; ++ r )
+			for( Dim k = 0; k < dim; ++ k )
+			{
+				max_diff = std::max( max_diff, std::fabs( x[ r ][ k ] - ref[ r ][ k ] ) );
+				max_ref = std::max( max_ref, std::fabs( ref[ r ][ k ] ) );
+			}
+
+		const bool ok = max_diff <= 1e-12 * std::max( max_ref, 1.0 );
+		std::cout << std::setw( 24 ) << std::left << name << ( ok ? "OK" : "ERROR" ) << std::right << std::endl;
+		assert( ok );
+	};
+
+	auto start_time = omp_get_wtime();
+	EMatrix		e( a + b + c + 2.0 * a );		// one fused pass, no temporaries
+	auto exec_time = omp_get_wtime() - start_time;
+
+	std::cout << "e = a + b + c + 2a: " << exec_time << " s" << std::endl;
+	check( "a + b + c + 2a", e, reference( [ & ] ( Dim r, Dim k ) { return 3.0 * a[ r ][ k ] + b[ r ][ k ] + c[ r ][ k ]; } ) );
+
+	start_time = omp_get_wtime();
+	EMatrix		f( a * b + c );					// c copied to f, then one GEMM accumulating into f
+	exec_time = omp_get_wtime() - start_time;
+
+	std::cout << "f = a * b + c: " << exec_time << " s" << std::endl;
+	check( "a * b + c", f, reference( [ & ] ( Dim r, Dim k ) { return ab[ r ][ k ] + c[ r ][ k ]; } ) );
+
+	f += a * b;									// another GEMM into f, no temporary
+	f = f - c;
+	check( "f += a * b; f = f - c", f, reference( [ & ] ( Dim r, Dim k ) { return 2.0 * ab[ r ][ k ]; } ) );
+
+	// The destination is also an operand of the sum with a product
+	EMatrix		g( c );
+	g = a * b + g + d;
+	check( "g = a * b + g + d", g, reference( [ & ] ( Dim r, Dim k ) { return ab[ r ][ k ] + c[ r ][ k ] + d[ r ][ k ]; } ) );
+
+	EMatrix		h( c );
+	h += a * b + h;
+	check( "h += a * b + h", h, reference( [ & ] ( Dim r, Dim k ) { return ab[ r ][ k ] + 2.0 * c[ r ][ k ]; } ) );
+
+	// ... and of the product
+	EMatrix		p( a );
+	p = p * b + d;
+	check( "p = p * b + d", p, reference( [ & ] ( Dim r, Dim k ) { return ab[ r ][ k ] + d[ r ][ k ]; } ) );
+}
+
+
+
+// ------------------------------------
+// Shows that RandInit with a seed gives the same matrix
+// for any number of threads, and measures its speed
+void RandInit_Test( void )
+{
+	const auto kCols { 4096 }, kRows { 4096 };
+	const std::uint64_t kSeed { 2020 };
+
+	EMatrix		a( kRows, kCols ), b( kRows, kCols );
+
+	const auto max_threads = omp_get_max_threads();
+
+	omp_set_num_threads( 1 );
+	RandInit( a, kSeed );
+
+	omp_set_num_threads( max_threads );
+	auto start_time = omp_get_wtime();
+	RandInit( b, kSeed );
+	auto exec_time = omp_get_wtime() - start_time;
+
+	bool same { true };
+	for( Dim r = 0; r < kRows; ++ r )
+		same = same && std::equal( a[ r ].begin(), a[ r ].end(), b[ r ].begin() );
+
+	std::cout << "1 and " << max_threads << " threads give " << ( same ? "the same" : "different" ) << " matrices" << std::endl;
+	std::cout << "RandInit: " << exec_time << " s, " << kRows * kCols * sizeof( DataType ) / exec_time * 1e-9 << " GB/s" << std::endl;
+}
+
+
+
+// Compares the Mersenne twister with the Philox generator
+// which fills whole buffers in parallel
+void Random_Test( void )
+{
+	const Dim kElems { 1 << 25 };
+	const std::uint64_t kSeed { 2020 };
+
+	std::vector< double >	u( kElems ), v( kElems );
+
+	std::mt19937	rand_gen{ kSeed };
+	std::uniform_real_distribution dist( -1.0, 1.0 );
+
+	auto start_time = omp_get_wtime();
+	std::generate( u.begin(), u.end(), [ & ](){ return dist( rand_gen ); } );
+	auto exec_time = omp_get_wtime() - start_time;
+
+	std::cout << "mt19937:\t" << exec_time << " s, " << kElems * sizeof( double ) / exec_time * 1e-9 << " GB/s" << std::endl;
+
+	// The known answer of Philox4x32-10 for the zero key and the zero counter,
+	// from the test vectors of Random123 (the reference implementation)
+	const std::uint32_t		kZeroKeyAnswer[ 4 ] { 0x6627E8D5, 0xE169C58D, 0xBC57AC4C, 0x9B00DBD8 };
+	std::vector< std::uint32_t >	block( kPhilox_BlockWords );
+
+	// The same sequence is generated with each of the instruction sets
+	const auto current_level = GetKernels().fLevel;
+	for( const auto level : { ESimdLevel::kScalar, ESimdLevel::kAVX2, ESimdLevel::kAVX512 } )
+	{
+		SetSimdLevel( level );
+
+		// The first counter is lane 0 of block 0, its j-th word is at j * kPhilox_Lanes
+		GetKernels().PhiloxBlocks( 0, 0, 1, block.data() );
+		bool known_answer { true };
+		for( Dim j = 0; j < 4; ++ j )
+			known_answer = known_answer && block[ j * kPhilox_Lanes ] == kZeroKeyAnswer[ j ];
+
+		std::cout << "Philox " << GetKernels().fName << " known answer ... " << ( known_answer ? "OK" : "ERROR" ) << std::endl;
+		assert( known_answer );
+
+		PhiloxRandom	philox( kSeed );
+
+		start_time = omp_get_wtime();
+		philox.FillUniform( v.data(), kElems, -1.0, 1.0 );
+		exec_time = omp_get_wtime() - start_time;
+
+		if( level == ESimdLevel::kScalar )
+			u = v;
+
+		std::cout << "Philox " << GetKernels().fName << ":\t" << exec_time << " s, " << kElems * sizeof( double ) / exec_time * 1e-9 << " GB/s, " 
+					<< ( u == v ? "the same values" : "different values!" ) << std::endl;
+	}
+
+	SetSimdLevel( current_level );
+
+	// The range is [ a, b ) - in a range one ulp wide about half of a + ( b - a ) * u round up to b
+	const DataType	kOneUlpUp = std::nextafter( 1.0, 2.0 );
+	PhiloxRandom( kSeed ).FillUniform( v.data(), kElems, 1.0, kOneUlpUp );
+	const bool below_b = std::all_of( v.begin(), v.end(), [] ( DataType x ) { return x == 1.0; } );
+	std::cout << "Philox uniform below b ... " << ( below_b ? "OK" : "ERROR" ) << std::endl;
+	assert( below_b );
+
+	PhiloxRandom	philox( kSeed );
+	philox.FillNormal( v.data(), kElems, 1.0, 2.0 );
+
+	const auto mean = std::accumulate( v.begin(), v.end(), 0.0 ) / kElems;
+	const auto var = std::inner_product( v.begin(), v.end(), v.begin(), 0.0 ) / kElems - mean * mean;
+	std::cout << "Normal( 1, 2 ): mean " << mean << ", std. dev. " << std::sqrt( var ) << std::endl;
+}
+
+
+
+// Compares the naive and the cache-oblivious transpositions,
+// and the multiplication with a pre-transposed b
+void Transpose_Test( void )
+{
+	const auto kCols { 4096 }, kRows { 4096 };
+
+	EMatrix		a( kRows, kCols ), at_naive( kCols, kRows );
+	RandInit( a );
+
+	// The naive loop - each write goes to a different row of at_naive
+	auto start_time = omp_get_wtime();
+	for( Dim r = 0; r < kRows; ++ r )
+		for( Dim c = 0; c < kCols; ++ c )
+			at_naive[ c ][ r ] = a[ r ][ c ];
+	auto exec_time = omp_get_wtime() - start_time;
+
+	std::cout << "Naive transpose:\t" << exec_time << " s" << std::endl;
+
+	start_time = omp_get_wtime();
+	EMatrix		at( Transpose( a ) );
+	exec_time = omp_get_wtime() - start_time;
+
+	std::cout << "Cache-oblivious:\t" << exec_time << " s, " << 2.0 * kRows * kCols * sizeof( DataType ) / exec_time * 1e-9 << " GB/s" << std::endl;
+
+	start_time = omp_get_wtime();
+	TransposeInPlace( a );
+	exec_time = omp_get_wtime() - start_time;
+
+	std::cout << "In place:\t\t" << exec_time << " s" << std::endl;
+
+	bool same { true };
+	for( Dim r = 0; r < kCols; ++ r )
+		same = same && std::equal( at[ r ].begin(), at[ r ].end(), at_naive[ r ].begin() ) 
+					&& std::equal( a[ r ].begin(), a[ r ].end(), at_naive[ r ].begin() );
+
+	std::cout << "Transpositions are " << ( same ? "the same" : "different!" ) << std::endl;
+
+
+	// Now a is a^T, so at^T is the original a
+	const auto kMultDim { 1024 };
+	EMatrix		b( kMultDim, kMultDim ), c( kMultDim, kMultDim );
+	RandInit( b );
+	RandInit( c );
+
+	const EMatrix	ct( Transpose( c ) );
+
+	start_time = omp_get_wtime();
+	EMatrix		bc( MultMatrix_Blocked( b, c ) );
+	exec_time = omp_get_wtime() - start_time;
+
+	std::cout << "b * c:\t\t\t" << exec_time << " s" << std::endl;
+
+	start_time = omp_get_wtime();
+	EMatrix		bc_t( MultMatrix_TransB( b, ct ) );
+	exec_time = omp_get_wtime() - start_time;
+
+	same = true;
+	for( Dim r = 0; r < kMultDim; ++ r )
+		same = same && std::equal( bc[ r ].begin(), bc[ r ].end(), bc_t[ r ].begin() );
+
+	std::cout << "b * ( c^T )^T:\t\t" << exec_time << " s, " << ( same ? "the same" : "different!" ) << std::endl;
+}
+
+
+
+// Solves a random system with the LU decomposition
+// and a symmetric positive definite one with Cholesky
+void LinAlg_Test( void )
+{
+	const auto kDim { 2000 }, kRhs { 16 };
+
+	EMatrix		a( kDim, kDim ), b( kDim, kRhs );
+	RandInit( a, 1 );
+	RandInit( b, 2 );
+
+	// The largest | ( m * x - b )_ij |, relative to the largest | b_ij | - it should be close to 0
+	auto max_residual = [ & ] ( const EMatrix & m, const EMatrix & x )
+	{
+		EMatrix		r( MultMatrix_Blocked( m, x ) );
+		DataType	max_r {}, max_b {};
+		for( Dim i = 0; i < kDim; ++ i )
+			for( Dim j = 0; j < kRhs; ++ j )
+			{
+				max_r = std::max( max_r, std::fabs( r[ i ][ j ] - b[ i ][ j ] ) );
+				max_b = std::max( max_b, std::fabs( b[ i ][ j ] ) );
+			}
+		return max_r / max_b;
+	};
+
+	auto start_time = omp_get_wtime();
+	EMLU		lu( a );
+	auto exec_time = omp_get_wtime() - start_time;
+
+	std::cout << "LU:\t\t" << exec_time << " s, " << 2.0 / 3.0 * kDim * kDim * kDim / exec_time * 1e-9 << " GFLOP/s" << std::endl;
+	std::cout << "Residual:\t" << max_residual( a, lu.Solve( b ) ) << std::endl;
+
+
+	// s = a^T * a + n * I is symmetric positive definite
+	EMatrix		s( MultMatrix_TransB( Transpose( a ), Transpose( a ) ) );
+	for( Dim i = 0; i < kDim; ++ i )
+		s[ i ][ i ] += kDim;
+
+	start_time = omp_get_wtime();
+	EMCholesky	chol( s );
+	exec_time = omp_get_wtime() - start_time;
+
+	std::cout << "Cholesky:\t" << exec_time << " s, " << 1.0 / 3.0 * kDim * kDim * kDim / exec_time * 1e-9 << " GFLOP/s" << std::endl;
+	std::cout << "Residual:\t" << max_residual( s, chol.Solve( b ) ) << std::endl;
+
+	// a is not positive definite, in general
+	std::cout << "a is " << ( EMCholesky( a ).IsPositiveDefinite() ? "" : "not " ) << "positive definite" << std::endl;
+}
+
+
+
+// Multiplies many small matrices, first one by one
+// with operator *, then all at once with MultBatch
+void Batch_MultMatrix_Test( void )
+{
+	const Dim kCount { 1 << 17 };
+
+	for( Dim dim : { 3, 4, 8 } )
+	{
+		std::vector< EMatrix >	a_vec, b_vec, c_vec;
+		for( Dim k = 0; k < kCount; ++ k )
+		{
+			a_vec.emplace_back( dim, dim );
+			b_vec.emplace_back( dim, dim );
+			RandInit( a_vec.back(), 2 * k );
+			RandInit( b_vec.back(), 2 * k + 1 );
+		}
+
+		c_vec.reserve( kCount );
+
+		auto start_time = omp_get_wtime();
+		for( Dim k = 0; k < kCount; ++ k )
+			c_vec.emplace_back( a_vec[ k ] * b_vec[ k ] );
+		auto loop_time = omp_get_wtime() - start_time;
+
+		const EMBatch	a( a_vec ), b( b_vec );
+		EMBatch			c( kCount, dim, dim );
+
+		start_time = omp_get_wtime();
+		MultBatch( a, b, c );
+		auto batch_time = omp_get_wtime() - start_time;
+
+		DataType max_diff {};
+		for( Dim k = 0; k < kCount; ++ k )
+			for( Dim r = 0; r < dim; ++ r )
+				for( Dim col = 0; col < dim; ++ col )
+					max_diff = std::max( max_diff, std::fabs( c( k, r, col ) - c_vec[ k ][ r ][ col ] ) / ( std::fabs( c_vec[ k ][ r ][ col ] ) + 1.0 ) );
+
+		const double flops = 2.0 * dim * dim * dim * kCount;
+
+		std::cout << dim << "x" << dim << " operator *:\t" << loop_time << " s, " << flops / loop_time * 1e-9 << " GFLOP/s" << std::endl;
+		std::cout << dim << "x" << dim << " MultBatch:\t" << batch_time << " s, " << flops / batch_time * 1e-9 << " GFLOP/s, "
+					<< "speed-up " << loop_time / batch_time << ", max rel. diff " << max_diff << std::endl;
+	}
+}
+
+
+
+// Checks TMatrixFor at compile time, then compares
+// a chain of 4x4 transforms with the same chain of EMatrix
+void TMatrixFor_Test( void )
+{
+	using Mat22 = TMatrixFor< double, 2, 2 >;
+
+	// All of these are computed by the compiler
+	constexpr Mat22	a( { 1.0, 2.0, 3.0, 4.0 } );
+	constexpr Mat22	b( { 0.0, 1.0, 1.0, 0.0 } );
+
+	static_assert( a * b == Mat22( { 2.0, 1.0, 4.0, 3.0 } ) );
+	static_assert( a * Mat22::Identity() == a );
+	static_assert( Transpose( a ) == Mat22( { 1.0, 3.0, 2.0, 4.0 } ) );
+	static_assert( a + b - b == a );
+	static_assert( ( Transpose( TMatrixFor< double, 2, 3 >() ) * TMatrixFor< double, 2, 3 >() ).GetRows() == 3 );
+
+	//a * TMatrixFor< double, 3, 3 >();		// does not compile - wrong dimensions
+
+
+	using Mat44 = TMatrixFor< double, 4, 4 >;
+
+	const auto kIters { 1 << 18 };
+
+	// A rotation by a small angle around z and a translation
+	const double kAngle { 1e-6 };
+	const Mat44	step( {	std::cos( kAngle ), - std::sin( kAngle ), 0.0, 0.1, 
+						std::sin( kAngle ),   std::cos( kAngle ), 0.0, 0.2, 
+						0.0,                  0.0,                1.0, 0.3, 
+						0.0,                  0.0,                0.0, 1.0 } );
+
+	auto start_time = omp_get_wtime();
+	Mat44	t_fixed( Mat44::Identity() );
+	for( auto i = 0; i < kIters; ++ i )
+		t_fixed = step * t_fixed;
+	auto fixed_time = omp_get_wtime() - start_time;
+
+	const EMatrix	step_dyn( step.ToEMatrix() );
+
+	start_time = omp_get_wtime();
+	EMatrix		t_dyn( Mat44::Identity().ToEMatrix() );
+	for( auto i = 0; i < kIters; ++ i )
+		t_dyn = step_dyn * t_dyn;
+	auto dyn_time = omp_get_wtime() - start_time;
+
+	DataType max_diff {};
+	const Mat44 t_back( t_dyn );
+	for( Dim r = 0; r < 4; ++ r )
+		for( Dim c = 0; c < 4; ++ c )
+			max_diff = std::max( max_diff, std::fabs( t_back[ r ][ c ] - t_fixed[ r ][ c ] ) );
+
+	std::cout << "TMatrixFor 4x4 chain:\t" << fixed_time << " s" << std::endl;
+	std::cout << "EMatrix 4x4 chain:\t" << dyn_time << " s, speed-up " << dyn_time / fixed_time << ", max diff " << max_diff << std::endl;
+}
+
+
+
+// Multiplies matrices of doubles, floats (single and mixed precision)
+// and fixed point numbers, and compares them with the double result
+void ElemTypes_Test( void )
+{
+	const auto kDim { 1024 };
+
+	EMatrix		a( kDim, kDim ), b( kDim, kDim );
+	RandInit( a, 1 );
+	RandInit( b, 2 );
+
+	// RandInit gives large values - scale them down to [ -1, 1 ]
+	a = ( 1.0 / 65536.0 ) * a;
+	b = ( 1.0 / 65536.0 ) * b;
+
+	// The largest | m_ij - ref_ij |
+	auto max_diff = [] ( const EMatrix & m, const EMatrix & ref )
+	{
+		DataType diff {};
+		for( Dim r = 0; r < ref.GetRows(); ++ r )
+			for( Dim c = 0; c < ref.GetCols(); ++ c )
+				diff = std::max( diff, std::fabs( m[ r ][ c ] - ref[ r ][ c ] ) );
+		return diff;
+	};
+
+	auto start_time = omp_get_wtime();
+	EMatrix		c( a * b );
+	auto exec_time = omp_get_wtime() - start_time;
+
+	std::cout << "double:\t\t\t" << exec_time << " s" << std::endl;
+
+
+	const EMatrixFor< float >	af( a ), bf( b );
+
+	start_time = omp_get_wtime();
+	EMatrixFor< float >		cf( af * bf );
+	exec_time = omp_get_wtime() - start_time;
+
+	std::cout << "float:\t\t\t" << exec_time << " s, max diff " << max_diff( EMatrix( cf ), c ) << std::endl;
+
+	start_time = omp_get_wtime();
+	EMatrixFor< float >		cm( MultMatrix_Mixed( af, bf ) );
+	exec_time = omp_get_wtime() - start_time;
+
+	std::cout << "float, double sums:\t" << exec_time << " s, max diff " << max_diff( EMatrix( cm ), c ) << std::endl;
+
+
+	// 16 fractional bits, the sign and magnitude format (see FxFor.h)
+	using Fx = FxFor< unsigned int, 16 >;
+
+	const auto kFxDim { 64 };
+	EMatrix		a_small( kFxDim, kFxDim ), b_small( kFxDim, kFxDim );
+	RandInit( a_small, 3 );
+	RandInit( b_small, 4 );
+	a_small = ( 1.0 / 65536.0 ) * a_small;
+	b_small = ( 1.0 / 65536.0 ) * b_small;
+
+	const EMatrixFor< Fx >	a_fx( a_small ), b_fx( b_small );
+	const EMatrixFor< Fx >	c_fx( a_fx * b_fx );
+
+	std::cout << "FxFor< unsigned int, 16 >, " << kFxDim << "x" << kFxDim << ": max diff " 
+				<< max_diff( EMatrix( c_fx ), a_small * b_small ) << std::endl;
+}
+
+
+
+// Times y = A * x and y = A^T * x and compares them
+// with the product by a one-column matrix
+void Gemv_Test( void )
+{
+	const auto kRows { 4096 }, kCols { 4096 }, kRepeats { 5 };
+
+	EMatrix		a( kRows, kCols );		// first touched in parallel
+	RandInit( a, 1 );
+
+	EMatrix		x_col( kCols, 1 );
+	RandInit( x_col, 2 );
+
+	RealVec		x( kCols ), x_t( kRows );
+	for( Dim i = 0; i < kCols; ++ i )
+		x[ i ] = x_col[ i ][ 0 ];
+	for( Dim i = 0; i < kRows; ++ i )
+		x_t[ i ] = x[ i % kCols ];
+
+	// A is read once, so its size determines the time
+	const double kBytes = double( kRows ) * kCols * sizeof( DataType );
+
+	// The best time of kRepeats runs of f
+	auto best_time = [] ( auto f )
+	{
+		double best { 1e30 };
+		for( auto i = 0; i < kRepeats; ++ i )
+		{
+			auto start_time = omp_get_wtime();
+			f();
+			best = std::min( best, omp_get_wtime() - start_time );
+		}
+		return best;
+	};
+
+	EMatrix		y_col( kRows, 1 );
+	auto exec_time = best_time( [ & ] { y_col = MultMatrix_Blocked( a, x_col ); } );
+	std::cout << "A * ( one-column matrix ):\t" << exec_time << " s, " << kBytes / exec_time * 1e-9 << " GB/s" << std::endl;
+
+	RealVec		y;
+	exec_time = best_time( [ & ] { y = MultMatrixVector( a, x ); } );
+	std::cout << "A * x:\t\t\t\t" << exec_time << " s, " << kBytes / exec_time * 1e-9 << " GB/s" << std::endl;
+
+	DataType max_diff {};
+	for( Dim i = 0; i < kRows; ++ i )
+		max_diff = std::max( max_diff, std::fabs( y[ i ] - y_col[ i ][ 0 ] ) / ( std::fabs( y_col[ i ][ 0 ] ) + 1.0 ) );
+	std::cout << "Max rel. diff:\t\t\t" << max_diff << std::endl;
+
+	RealVec		y_t;
+	exec_time = best_time( [ & ] { y_t = MultMatrixVector_Trans( a, x_t ); } );
+	std::cout << "A^T * x:\t\t\t" << exec_time << " s, " << kBytes / exec_time * 1e-9 << " GB/s" << std::endl;
+
+	// Compare with ( A^T ) * x
+	const RealVec	y_ref( MultMatrixVector( Transpose( a ), x_t ) );
+
+	max_diff = 0.0;
+	for( Dim i = 0; i < kCols; ++ i )
+		max_diff = std::max( max_diff, std::fabs( y_t[ i ] - y_ref[ i ] ) / ( std::fabs( y_ref[ i ] ) + 1.0 ) );
+	std::cout << "Max rel. diff:\t\t\t" << max_diff << std::endl;
+}
+
+
+
+// Runs an iteration with a few temporary matrices in each step,
+// first with the heap and then with an arena scope in the loop body
+void Arena_Test( void )
+{
+	const auto kDim { 2048 }, kIters { 40 };
+
+	// Each matrix has 32 MB, so the heap gets it with mmap and returns it with munmap.
+	// Then each new temporary pays for the page faults of its fresh memory.
+	EMatrix		a( kDim, kDim ), b( kDim, kDim );
+	RandInit( a, 1 );
+	RandInit( b, 2 );
+
+	// x = ( x + a ) / 2 + b / 2, with the temporaries t and u
+	auto step = [ & ] ( EMatrix & x )
+	{
+		EMatrix	t( x + a );
+		EMatrix	u( 0.5 * t );
+		x = u + 0.5 * b;
+	};
+
+	EMatrix		x_heap( b );
+	auto start_time = omp_get_wtime();
+	for( auto i = 0; i < kIters; ++ i )
+		step( x_heap );
+	auto heap_time = omp_get_wtime() - start_time;
+
+	EMArena		arena;
+	EMatrix		x_arena( b );
+	start_time = omp_get_wtime();
+	for( auto i = 0; i < kIters; ++ i )
+	{
+		EMArena::Scope	scope( arena );		// t, u and the GEMM buffers come from the arena
+		step( x_arena );
+	}
+	auto arena_time = omp_get_wtime() - start_time;
+
+	bool same { true };
+	for( Dim r = 0; r < kDim; ++ r )
+		same = same && std::equal( x_heap[ r ].begin(), x_heap[ r ].end(), x_arena[ r ].begin() );
+
+	std::cout << "Heap:\t" << heap_time << " s" << std::endl;
+	std::cout << "Arena:\t" << arena_time << " s, capacity " << arena.GetCapacity() / ( 1 << 20 ) << " MB, " 
+				<< "results are " << ( same ? "the same" : "different!" ) << std::endl;
+
+	// Moving and swapping between the heap and an arena scope copies the elements,
+	// so after the scope the heap matrices still have their own buffers
+	EMatrix		h( a ), g( b );
+	{
+		EMArena::Scope	scope( arena );
+		EMatrix		s( kDim, kDim ), w( kDim, kDim );
+		s = std::move( h );
+		w.Swap( g );
+		std::swap( h, w );
+	}
+
+	bool moved_ok { true };
+	for( Dim r = 0; r < kDim; ++ r )
+		moved_ok = moved_ok && std::equal( h[ r ].begin(), h[ r ].end(), b[ r ].begin() ) 
+					&& std::all_of( g[ r ].begin(), g[ r ].end(), [] ( auto v ) { return v == 0.0; } );
+
+	std::cout << "Move and swap across a scope: " << ( moved_ok ? "OK" : "ERROR" ) << std::endl;
+}
+
+
+
+// Sums chunks of a long vector with std::async (a thread per chunk)
+// and with the thread pool (the threads are created once)
+void ThreadPool_Test( void )
+{
+	const Dim kElems { 1 << 24 }, kChunk { 25000 };
+
+	RealVec		v( kElems );
+	PhiloxRandom( 1 ).FillUniform( v.data(), kElems, -1.0, 1.0 );
+
+	auto sum_chunk = [ & v ] ( Dim b, Dim e ) { return std::accumulate( v.begin() + b, v.begin() + e, 0.0 ); };
+
+	auto start_time = omp_get_wtime();
+	std::vector< std::future< double > >	futures;
+	for( Dim b = 0; b < kElems; b += kChunk )
+		futures.push_back( std::async( std::launch::async, sum_chunk, b, std::min( b + kChunk, kElems ) ) );
+	double async_sum {};
+	for( auto & f : futures )
+		async_sum += f.get();
+	auto async_time = omp_get_wtime() - start_time;
+
+	EMThreadPool & pool = EMThreadPool::GetDefault();		// its threads start here
+
+	start_time = omp_get_wtime();
+	const double pool_sum = pool.ParallelReduce( 0, kElems, kChunk, 0.0, sum_chunk, std::plus<>() );
+	auto pool_time = omp_get_wtime() - start_time;
+
+	std::cout << futures.size() << " chunks, " << pool.GetThreads() << " pool threads" << std::endl;
+	std::cout << "std::async:\t" << async_time << " s, sum = " << async_sum << std::endl;
+	std::cout << "Pool:\t\t" << pool_time << " s, sum = " << pool_sum << std::endl;
+
+	// Nested parallel loops - the waiting threads run the inner chunks
+	const Dim kRows { 256 }, kCols { 1024 };
+	EMatrix		m( kRows, kCols );
+	pool.ParallelFor( 0, kRows, 1, [ & ] ( Dim rb, Dim re )
+	{
+		for( Dim r = rb; r < re; ++ r )
+			pool.ParallelFor( 0, kCols, 64, [ & ] ( Dim cb, Dim ce ) 
+			{ 
+				for( Dim c = cb; c < ce; ++ c )
+					m[ r ][ c ] = DataType( r * kCols + c );
+			} );
+	} );
+
+	bool ok { true };
+	for( Dim r = 0; r < kRows; ++ r )
+		for( Dim c = 0; c < kCols; ++ c )
+			ok = ok && m[ r ][ c ] == DataType( r * kCols + c );
+	std::cout << "Nested ParallelFor is " << ( ok ? "correct" : "wrong!" ) << std::endl;
+}
+
+
+
+// Computes C = A * B, D = C + E, F = D * G and the independent H = A * G,
+// first operation by operation, then as one graph of tile tasks
+void TaskGraph_Test( void )
+{
+	const auto kDim { 1024 };
+
+	EMatrix		A( kDim, kDim ), B( kDim, kDim ), E( kDim, kDim ), G( kDim, kDim );
+	RandInit( A, 1 );
+	RandInit( B, 2 );
+	RandInit( E, 3 );
+	RandInit( G, 4 );
+
+	auto start_time = omp_get_wtime();
+	EMatrix		C_ref( A * B );
+	EMatrix		D_ref( C_ref + E );
+	EMatrix		F_ref( D_ref * G );
+	EMatrix		H_ref( A * G );
+	auto ops_time = omp_get_wtime() - start_time;
+
+	EMatrix		C( kDim, kDim ), D( kDim, kDim ), F( kDim, kDim ), H( kDim, kDim );
+
+	EMTilePipeline	pipeline;
+	pipeline.Mult( A, B, C );
+	pipeline.Add( C, E, D );
+	pipeline.Mult( D, G, F );
+	pipeline.Mult( A, G, H );		// does not depend on the others
+
+	start_time = omp_get_wtime();
+	pipeline.Run();
+	auto graph_time = omp_get_wtime() - start_time;
+
+	DataType max_diff {};
+	for( Dim r = 0; r < kDim; ++ r )
+		for( Dim c = 0; c < kDim; ++ c )
+			max_diff = std::max( { max_diff, std::fabs( F[ r ][ c ] - F_ref[ r ][ c ] ), std::fabs( H[ r ][ c ] - H_ref[ r ][ c ] ) } );
+
+	std::cout << "Operation by operation:\t" << ops_time << " s" << std::endl;
+	std::cout << "Task graph (" << pipeline.GetGraph().GetTasks() << " tasks):\t" << graph_time << " s, max diff = " << max_diff << std::endl;
+}
+
+
+
+// Multiplies two matrices saved in tiled files with a memory budget
+// of only a few tiles and compares the result with the in-memory product
+void OutOfCore_Test( void )
+{
+	const Dim kRows { 1500 }, kInner { 1300 }, kCols { 1100 }, kTile { 256 };
+
+	EMatrix		a( kRows, kInner ), b( kInner, kCols );
+	RandInit( a, 1 );
+	RandInit( b, 2 );
+
+	const std::string	a_file( "ooc_a.emt" ), b_file( "ooc_b.emt" ), c_file( "ooc_c.emt" );
+	if( ! WriteTiled( a, a_file, kTile ) || ! WriteTiled( b, b_file, kTile ) )
+	{
+		std::cout << "Cannot write the tiled files" << std::endl;
+		return;
+	}
+
+	// 20 tiles of 256 x 256 doubles, i.e. 10 MB for the whole product
+	const std::size_t	kBudget { 20 * kTile * kTile * sizeof( DataType ) };
+
+	EMOutOfCoreStats	stats;
+	EMatrix				c( 1, 1 );		// resized by ReadTiled
+	const bool ok = MultMatrix_OutOfCore( a_file, b_file, c_file, kBudget, & stats ) && ReadTiled( c, c_file );
+
+	if( ok )
+	{
+		const EMatrix	c_ref( a * b );
+
+		DataType max_diff {};
+		for( Dim r = 0; r < kRows; ++ r )
+			for( Dim col = 0; col < kCols; ++ col )
+				max_diff = std::max( max_diff, std::fabs( c[ r ][ col ] - c_ref[ r ][ col ] ) );
+
+		std::cout << "Panel of " << stats.fPanelTileRows << " x " << stats.fPanelTileCols << " tiles, " 
+					<< stats.fSeconds << " s (" << stats.fLoadWaitSeconds << " s waiting for tiles), "
+					<< ( stats.fBytesRead + stats.fBytesWritten ) / stats.fSeconds * 1e-9 << " GB/s of I/O" << std::endl;
+		std::cout << "Max diff = " << max_diff << std::endl;
+	}
+	else
+	{
+		std::cout << "Out-of-core product failed" << std::endl;
+	}
+
+	std::remove( a_file.c_str() );
+	std::remove( b_file.c_str() );
+	std::remove( c_file.c_str() );
+}
+
+
+
+// Multiplies quantized int8 and int16 matrices and compares
+// the results and times with the double precision product
+void Quant_Test( void )
+{
+	const auto kDim { 1024 };
+
+	EMatrix		a( kDim, kDim ), b( kDim, kDim );
+	RandInit( a, 1 );
+	RandInit( b, 2 );
+
+	auto start_time = omp_get_wtime();
+	const EMatrix	c_ref( a * b );
+	const auto ref_time = omp_get_wtime() - start_time;
+
+	// The relative error in the Frobenius norm
+	auto rel_error = [ & c_ref ] ( const EMatrix & c )
+	{
+		DataType diff {}, norm {};
+		for( Dim r = 0; r < kDim; ++ r )
+			for( Dim col = 0; col < kDim; ++ col )
+			{
+				diff += ( c[ r ][ col ] - c_ref[ r ][ col ] ) * ( c[ r ][ col ] - c_ref[ r ][ col ] );
+				norm += c_ref[ r ][ col ] * c_ref[ r ][ col ];
+			}
+		return std::sqrt( diff / norm );
+	};
+
+	std::cout << "double:\t" << ref_time << " s" << std::endl;
+
+	auto run = [ & ] ( auto tag, const char * name )
+	{
+		using Q = decltype( tag );
+
+		// a is scaled per row, b per column
+		const auto qa = Quantize< Q >( a, EQuantAxis::kPerRow );
+		const auto qb = Quantize< Q >( b, EQuantAxis::kPerCol );
+
+		auto start_time = omp_get_wtime();
+		const EMatrix	c( MultMatrix_Quant( qa, qb ) );
+		auto exec_time = omp_get_wtime() - start_time;
+
+		std::cout << name << ":\t" << exec_time << " s, speedup " << ref_time / exec_time 
+					<< ", rel. error " << rel_error( c ) << " (with only a quantized " << rel_error( Dequantize( qa ) * b ) << ")" << std::endl;
+	};
+
+	run( std::int8_t {}, "int8" );
+	run( std::int16_t {}, "int16" );
+}
+
+
+
+// Defined in OpenMPExamples.cpp
+std::tuple< int, int >	FindMin( const std::vector< int > & v );
+double					MSE( const std::vector< double > & u, const std::vector< double > & v );
+
+// Runs a few kernels with the hardware counters
+void Perf_Test( void )
+{
+	if( ! IsPerfAvailable() )
+		std::cout << "The performance counters are not available - only the times are measured" << std::endl;
+
+	const auto kDim { 1024 };
+	const Dim kElems { 1 << 24 };
+
+	EMatrix		a( kDim, kDim ), b( kDim, kDim ), c( kDim, kDim );
+	RandInit( a, 1 );
+	RandInit( b, 2 );
+
+	RealVec		u( kElems ), v( kElems ), y( kDim );
+	PhiloxRandom( 3 ).FillUniform( u.data(), kElems, -1.0, 1.0 );
+	PhiloxRandom( 4 ).FillUniform( v.data(), kElems, -1.0, 1.0 );
+
+	std::vector< int >	iv( kElems );
+	PhiloxRandom( 5 ).FillUniformInt( iv.data(), kElems, 0, 255 );
+
+	std::cout << MeasurePerf( "a * b", [ & ] { c = a * b; } );
+	std::cout << MeasurePerf( "a + b", [ & ] { c = a + b; } );
+	std::cout << MeasurePerf( "Gemv", [ & ] { Gemv( a, u.data(), y.data() ); } );
+	std::cout << MeasurePerf( "Inner product", [ & ] { y[ 0 ] = std::inner_product( u.begin(), u.end(), v.begin(), 0.0 ); } );
+
+	// These run on the workers of the thread pool, not on the OpenMP team
+	std::cout << MeasurePerf( "Inner product (pool)", [ & ] { y[ 0 ] = ParallelReduce( 0, kElems, 0, 0.0, 
+							[ & ] ( std::size_t b, std::size_t e ) { return std::inner_product( u.begin() + b, u.begin() + e, v.begin() + b, 0.0 ); }, std::plus<>() ); } );
+	std::cout << MeasurePerf( "Dot_Compensated_Par", [ & ] { y[ 0 ] = Dot_Compensated_Par( kElems, u.data(), v.data() ); } );
+	std::cout << MeasurePerf( "FindMin", [ & ] { y[ 0 ] = std::get< 0 >( FindMin( iv ) ); } );
+	std::cout << MeasurePerf( "MSE", [ & ] { y[ 0 ] = MSE( u, v ); } );
+}
+
+
+
+// Copies of a copy-on-write matrix share its buffer
+// until they are changed
+void CoW_Test( void )
+{
+	const auto kDim { 512 };
+
+	EMatrix		a( kDim, kDim ), b( kDim, kDim );
+	RandInit( a, 1 );
+	RandInit( b, 2 );
+
+	const EMatrix	a_ref( a );		// a plain deep copy, to compare with
+	a.SetCopyOnWrite( true );
+
+	auto same = [] ( const EMatrix & x, const EMatrix & y )
+	{
+		for( Dim r = 0; r < x.GetRows(); ++ r )
+			if( ! std::equal( x[ r ].begin(), x[ r ].end(), y[ r ].begin() ) )
+				return false;
+		return true;
+	};
+
+	auto check = [] ( const std::string & name, bool ok )
+	{
+		std::cout << std::setw( 36 ) << std::left << name << ( ok ? "OK" : "ERROR" ) << std::right << std::endl;
+		assert( ok );
+	};
+
+	// Many threads read their copies of a - no buffer is duplicated
+	const int kThreads { 8 };
+	std::vector< DataType >	sums( kThreads ), ref_sums( kThreads );
+	std::vector< char >		shared( kThreads );
+	#pragma omp parallel for
+	for( int t = 0; t < kThreads; ++ t )
+	{
+		const EMatrix	c( a );
+		shared[ t ] = c.GetDataBuf() == std::as_const( a ).GetDataBuf();
+		sums[ t ] = std::accumulate( c[ t ].begin(), c[ t ].end(), 0.0 );
+	}
+	for( int t = 0; t < kThreads; ++ t )
+		ref_sums[ t ] = std::accumulate( a_ref[ t ].begin(), a_ref[ t ].end(), 0.0 );
+
+	check( "parallel readers share and read a", sums == ref_sums && std::all_of( shared.begin(), shared.end(), [] ( char s ) { return s != 0; } ) );
+
+	// The first write gives c its own buffer, a does not change
+	EMatrix		c( a );
+	check( "a copy shares the buffer", c.IsShared() && a.IsShared() && c.IsCopyOnWrite() );
+
+	c[ 0 ][ 0 ] += 1.0;
+	check( "a write makes the copy unique", ! c.IsShared() && ! a.IsShared() && c[ 0 ][ 0 ] == a_ref[ 0 ][ 0 ] + 1.0 && same( a, a_ref ) );
+
+	// The expressions write their destination in parallel - it is made unique first
+	EMatrix		d( a );
+	d = d + a;
+	check( "d = d + a into a shared d", ! d.IsShared() && same( a, a_ref ) && d[ 1 ][ 1 ] == 2.0 * a_ref[ 1 ][ 1 ] );
+
+	// So does the tile pipeline - e gets its own buffer when the tasks run
+	EMatrix		e( a );
+	EMTilePipeline	pipeline( 128 );
+	pipeline.Mult( a, b, e );
+	pipeline.Run();
+	check( "a tile pipeline into a shared e", ! e.IsShared() && same( a, a_ref ) && same( e, MultMatrix_Blocked( a_ref, b ) ) );
+
+	// The solvers copy a shared right-hand side and substitute in parallel
+	const Dim	kSys { 200 };
+	EMatrix		s( kSys, kSys ), rhs( kSys, 1024 );
+	RandInit( s, 3 );
+	RandInit( rhs, 4 );
+	for( Dim i = 0; i < kSys; ++ i )
+		s[ i ][ i ] += kSys;			// well conditioned
+
+	const EMLU		lu( s );
+	const EMatrix	x_ref( lu.Solve( rhs ) );
+	const EMatrix	rhs_ref( rhs );
+	rhs.SetCopyOnWrite( true );
+	const EMatrix	rhs_copy( rhs );	// rhs is shared now
+	check( "LU solve with a shared rhs", same( lu.Solve( rhs ), x_ref ) && same( rhs, rhs_ref ) && rhs.IsShared() );
+
+	// s^T * s is symmetric positive definite
+	const EMCholesky	chol( MultMatrix_TransB( Transpose( s ), Transpose( s ) ) );
+	const EMatrix		y_ref( chol.Solve( rhs_ref ) );
+	check( "Cholesky solve with a shared rhs", same( chol.Solve( rhs ), y_ref ) && same( rhs, rhs_ref ) && rhs.IsShared() );
+}
+
+
+
+// The compensated dot products on data which cancel out - 
+// the exact inner product of v and w is 0
+void CompensatedDot_Test( void )
+{
+	const Dim kElems { 1 << 22 };
+
+	// The second halves are the negated first ones, the magnitudes differ a lot
+	RealVec		v( 2 * kElems ), w( 2 * kElems );
+	PhiloxRandom( 1 ).FillUniform( v.data(), kElems, -1.0, 1.0 );
+	PhiloxRandom( 2 ).FillUniform( w.data(), kElems, -1.0, 1.0 );
+	for( Dim i = 0; i < kElems; ++ i )
+	{
+		v[ i ] = std::ldexp( v[ i ], static_cast< int >( i % 40 ) - 20 );
+		v[ kElems + i ] = v[ i ];
+		w[ kElems + i ] = - w[ i ];
+	}
+
+	const auto n = v.size();
+	auto show = [] ( const std::string & name, auto f )
+	{
+		auto start_time = omp_get_wtime();	// Get time start point
+		const auto dot = f();
+		auto exec_time = omp_get_wtime() - start_time;	// End time
+		std::cout << std::setw( 20 ) << std::left << name << "error = " << std::setw( 14 ) << std::fabs( dot ) << "T [ms] = " << 1000.0 * exec_time << std::endl;
+		return std::fabs( dot );
+	};
+
+	show( "inner_product", [ & ] { return std::inner_product( v.begin(), v.end(), w.begin(), 0.0 ); } );
+	show( "Dot", [ & ] { return GetKernels().Dot( n, v.data(), w.data() ); } );
+	show( "Dot_Kahan", [ & ] { return Dot_Kahan( n, v.data(), w.data() ); } );
+	show( "Dot_Neumaier", [ & ] { return Dot_Neumaier( n, v.data(), w.data() ); } );
+
+	// The exact result is 0. The worst case of Dot2 is ( n * u )^2 * sum | v[ i ] * w[ i ] | 
+	// (see EMDot.h), but in practice it is far better - so it must stay within n * u^2 * sum,
+	// with any kernels. The plain and the Kahan sums are orders of magnitude above that.
+	DataType abs_sum {};
+	for( Dim i = 0; i < n; ++ i )
+		abs_sum += std::fabs( v[ i ] * w[ i ] );
+	const DataType u = std::numeric_limits< DataType >::epsilon() / 2.0;
+	const DataType bound = static_cast< DataType >( n ) * u * u * abs_sum;
+
+	const auto level = GetKernels().fLevel;
+	bool dot2_ok { true };
+	for( auto l : { ESimdLevel::kScalar, ESimdLevel::kAVX2, ESimdLevel::kAVX512 } )
+	{
+		SetSimdLevel( l );
+		const std::string name { GetKernels().fName };
+		dot2_ok = show( "Dot2 " + name, [ & ] { return Dot2( n, v.data(), w.data() ); } ) <= bound && dot2_ok;
+		dot2_ok = show( "Dot2 par " + name, [ & ] { return Dot_Compensated_Par( n, v.data(), w.data() ); } ) <= bound && dot2_ok;
+	}
+	SetSimdLevel( level );
+
+	std::cout << "Dot2 error below " << bound << " ... " << ( dot2_ok ? "OK" : "ERROR" ) << std::endl;
+	assert( dot2_ok );
+}
+
+
+
+// ------------------------------------
+// An example of hazards due to 
+// an unprotected shared object
+
+int x;		// A global shared variable
+
+void Task_0( void )
+{
+	auto loc { x };	// Local object
+	
+	// Non-protected access to shared
+	x += 5;
+	
+	std::cout << loc << ", " << x << "\n";
+}
+
+void Task_1( void )
+{
+	#pragma omp critical ( section )
+	{
+		auto loc { x };	// Copy whatever value of x
+
+		x += 5;	// ok
+
+		std::cout << loc << ", " << x << "\n";
+	}
+}
+
+void Parallel_Tasks_Test( void )
+{
+	// There is nothing wrong with Task_0 
+	// when executed sequentially.
+	for( auto i : { 1, 2, 3, 4, 5 } )
+		Task_0();
+
+	std::cout << "\n\n";
+
+	// Run unprotected
+	#pragma omp parallel num_threads( 5 )
+	{		
+		Task_0();
+	}
+
+	// Run with critical section
+	#pragma omp parallel num_threads( 5 )
+	{
+		Task_1();
+	}
+
+}
+
+
+
+
+
+
@@ -1,59 +1,99 @@
-// ==========================================================================
-//
-// Software written by Boguslaw Cyganek (C) to be used with the book:
-// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
-// Published by Wiley, 2020
-//
-// The software is supplied as is and for educational purposes
-// without any guarantees nor responsibility of its use in any application. 
-//
-// ==========================================================================
-
-
-#include <string>
-#include <vector>
-#include <algorithm>
-#include <iostream>
-
-namespace InnerProducts
-{
-	void InnerProduct_Test_GeneralExperiment( void );
-}
-
-
-void OpenMP_Test( void );
-void OpenMP_Pi_Test( void );
-void OpenMP_MultMatrix_Test( void );
-void OpenMP_MultMatrix_Test_1( void );
-
-void Parallel_Tasks_Test(void);
-
-
-void FindMin_Test( void );
-void MSE_Test( void );
-
-
-
-int main()
-{
-	std::cout << "Good day!" << std::endl;
-
-	//InnerProducts::InnerProduct_Test_GeneralExperiment();
-
-	//FindMin_Test();
-	MSE_Test();
-	return 0;
-
-	OpenMP_Test();
-
-	//OpenMP_MultMatrix_Test();
-	//OpenMP_MultMatrix_Test_1();
-
-	//OpenMP_Pi_Test();
-
-	//Parallel_Tasks_Test();
-
-	return 0;
-}
-
-
+// ==========================================================================
+//
+// Software written by Boguslaw Cyganek (C) to be used with the book:
+// INTRODUCTION TO PROGRAMMING WITH C++ FOR ENGINEERS
+// Published by Wiley, 2020
+//
+// The software is supplied as is and for educational purposes
+// without any guarantees nor responsibility of its use in any application. 
+//
+// ==========================================================================
+
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+namespace InnerProducts
+{
+	void InnerProduct_Test_GeneralExperiment( void );
+}
+
+
+void OpenMP_Test( void );
+void OpenMP_Pi_Test( void );
+void OpenMP_MultMatrix_Test( void );
+void OpenMP_MultMatrix_Test_1( void );
+void OpenMP_MultMatrix_Blocked_Test( void );
+void SIMD_MultMatrix_Test( void );
+void ExprTemplates_Test( void );
+void Strassen_MultMatrix_Test( void );
+void RandInit_Test( void );
+void Random_Test( void );
+void Transpose_Test( void );
+void LinAlg_Test( void );
+void Batch_MultMatrix_Test( void );
+void TMatrixFor_Test( void );
+void ElemTypes_Test( void );
+void Gemv_Test( void );
+void Arena_Test( void );
+void ThreadPool_Test( void );
+void TaskGraph_Test( void );
+void OutOfCore_Test( void );
+void Quant_Test( void );
+void Perf_Test( void );
+void CoW_Test( void );
+void CompensatedDot_Test( void );
+
+void Parallel_Tasks_Test(void);
+
+
+void FindMin_Test( void );
+void MSE_Test( void );
+
+
+
+int main()
+{
+	std::cout << "Good day!" << std::endl;
+
+	//InnerProducts::InnerProduct_Test_GeneralExperiment();
+
+	//FindMin_Test();
+	MSE_Test();
+	return 0;
+
+	OpenMP_Test();
+
+	//OpenMP_MultMatrix_Test();
+	//OpenMP_MultMatrix_Test_1();
+	//OpenMP_MultMatrix_Blocked_Test();
+	//SIMD_MultMatrix_Test();
+	//ExprTemplates_Test();
+	//Strassen_MultMatrix_Test();
+	//RandInit_Test();
+	//Random_Test();
+	//Transpose_Test();
+	//LinAlg_Test();
+	//Batch_MultMatrix_Test();
+	//TMatrixFor_Test();
+	//ElemTypes_Test();
+	//Gemv_Test();
+	//Arena_Test();
+	//ThreadPool_Test();
+	//TaskGraph_Test();
+	//OutOfCore_Test();
+	//Quant_Test();
+	//Perf_Test();
+	//CoW_Test();
+	//CompensatedDot_Test();
+
+	//OpenMP_Pi_Test();
+
+	//Parallel_Tasks_Test();
+
+	return 0;
+}
+
+